@@ -144,6 +144,8 @@ namespace {
                    , QObject::tr ("Detail factor"), minFloatValue, 1.0f );
 	addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/stepWidthFactor"
                    , QObject::tr ("Step width factor"), minFloatValue, 1.0f );
+	addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/dabSpacing"
+                   , QObject::tr ("Dab spacing"), 0.0f, 10.0f );
 	addColorButton ( glWidget, *gridSculpt, "editor/tool/sculpt/cursorColor"
                    , QObject::tr ("Cursor color") );
 	addFloatEdit   ( glWidget, *gridSculpt, "editor/tool/sculpt/maxAbsoluteRadius"
@@ -171,8 +173,12 @@ namespace {
   QWidget* makeMiscPage (ViewGlWidget& glWidget) {
     ViewTwoColumnGrid* grid = new ViewTwoColumnGrid;
 
-	addIntEdit ( glWidget, *grid, "editor/undoDepth", QObject::tr ("Undo depth")
+	addIntEdit ( glWidget, *grid, "editor/undoMemory", QObject::tr ("Undo memory (MB)")
                , 1, std::numeric_limits <int>::max () );
+	addIntEdit ( glWidget, *grid, "editor/numThreads", QObject::tr ("Threads (0 = all)")
+               , 0, 256 );
+	addIntEdit ( glWidget, *grid, "editor/mesh/packedVertices"
+               , QObject::tr ("Packed vertices (0 = off)"), 0, 1 );
 	addIntEdit ( glWidget, *grid, "window/initialWidth", QObject::tr ("Initial window width")
                , 1, std::numeric_limits <int>::max () );
 	addIntEdit ( glWidget, *grid, "window/initialHeight", QObject::tr ("Initial window height")
@@ -131,6 +131,10 @@ void ViewGlWidget::paintGL ()
     QPainter painter (this);
     painter.beginNativePainting ();
 
+    if (state ().hasTool ()) {
+        state ().tool ().update ();
+    }
+
     state ().camera ().renderer ().setupRendering ();
     state ().scene  ().render (state ().camera ());
 
@@ -145,7 +149,10 @@ void ViewGlWidget::paintGL ()
     painter.endNativePainting ();
 
 //    m_axis->render (state ().camera (), painter);
-    m_mainWindow.showNumFaces (state ().scene ().numFaces ());
+    // the scene is counted once the current tool has finished its modifications
+    if (state ().hasTool () == false || state ().tool ().isIdle ()) {
+        m_mainWindow.showNumFaces (state ().scene ().numFaces ());
+    }
 }
 
 void ViewGlWidget::resizeGL (int w, int h) {
@@ -50,9 +50,11 @@ void ViewMainWindow::setupShortcuts ()
     });
 #ifndef NDEBUG
     addShortcut (Qt::Key_I, [this] () {
+      this->m_mainWidget->glWidget ().state ().finishTool ();
       this->m_mainWidget->glWidget ().state ().scene ().printStatistics (false);
     });
     addShortcut (Qt::SHIFT + Qt::Key_I, [this] () {
+        this->m_mainWidget->glWidget ().state ().finishTool ();
         this->m_mainWidget->glWidget ().state ().scene ().printStatistics (true);
     });
 #endif
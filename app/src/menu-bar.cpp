@@ -57,12 +57,14 @@ bool hasSuffix (const std::string& string, const std::string& suffix) {
       : QStandardPaths::standardLocations (QStandardPaths::HomeLocation).front ();
   }
 
-  QString filterAllFiles () { return QObject::tr ("All files (*.*)"); }
-  QString filterDlyFiles () { return QObject::tr ("Dilay files (*.dly)"); }
-  QString filterObjFiles () { return QObject::tr ("Wavefront files (*.obj)"); }
+  QString filterAllFiles  () { return QObject::tr ("All files (*.*)"); }
+  QString filterDlyFiles  () { return QObject::tr ("Dilay files (*.dly)"); }
+  QString filterDlybFiles () { return QObject::tr ("Binary Dilay files (*.dlyb)"); }
+  QString filterObjFiles  () { return QObject::tr ("Wavefront files (*.obj)"); }
 
   QString fileDialogFilters () {
-    return filterAllFiles () + ";;" + filterDlyFiles () + ";;" + filterObjFiles ();
+    return filterAllFiles () + ";;" + filterDlyFiles  () + ";;" 
+                                    + filterDlybFiles () + ";;" + filterObjFiles ();
   }
 
   QString selectedFilter (const Scene& scene) {
@@ -70,6 +72,9 @@ bool hasSuffix (const std::string& string, const std::string& suffix) {
       if (hasSuffix (scene.fileName (), ".dly")) {
         return filterDlyFiles ();
       }
+      else if (hasSuffix (scene.fileName (), ".dlyb")) {
+        return filterDlybFiles ();
+      }
       else if (hasSuffix (scene.fileName (), ".obj")) {
         return filterObjFiles ();
       }
@@ -88,6 +93,8 @@ void ViewMenuBar :: setup (ViewMainWindow& mainWindow, ViewGlWidget& glWidget) {
   addAction ( fileMenu, QObject::tr ("&Open..."), QKeySequence::Open
             , [&mainWindow, &glWidget] ()
   {
+    glWidget.state ().finishTool ();
+
     Scene&            scene    = glWidget.state ().scene ();
           QString     filter   = filterAllFiles ();
     const std::string fileName = QFileDialog::getOpenFileName ( &mainWindow
@@ -115,14 +122,19 @@ void ViewMenuBar :: setup (ViewMainWindow& mainWindow, ViewGlWidget& glWidget) {
                                     , QKeySequence::SaveAs
                                     , [&mainWindow, &glWidget] () 
   {
+    glWidget.state ().finishTool ();
+
     Scene&            scene    = glWidget.state ().scene ();
           QString     filter   = selectedFilter (scene);
-    const std::string fileName = QFileDialog::getSaveFileName ( &mainWindow
+          std::string fileName = QFileDialog::getSaveFileName ( &mainWindow
                                                           , QObject::tr ("Save as")
                                                           , getFileDialogPath (scene)
                                                           , fileDialogFilters ()
                                                           , &filter ).toStdString ();
     if (fileName.empty () == false) {
+      if (filter == filterDlybFiles () && hasSuffix (fileName, ".dlyb") == false) {
+        fileName += ".dlyb";
+      }
       const bool saveAsObj = hasSuffix (fileName, ".obj") || filter == filterObjFiles ();
 
       if (scene.toDlyFile (fileName, saveAsObj) == false) {
@@ -136,6 +148,8 @@ void ViewMenuBar :: setup (ViewMainWindow& mainWindow, ViewGlWidget& glWidget) {
   addAction ( fileMenu, QObject::tr ("&Save"), QKeySequence::Save
             , [&mainWindow, &glWidget, &saveAsAction] ()
   {
+    glWidget.state ().finishTool ();
+
     Scene& scene = glWidget.state ().scene ();
     if (scene.hasFileName ()) {
       const bool saveAsObj = hasSuffix (scene.fileName (), ".obj");
@@ -108,6 +108,7 @@ DELEGATE_GL_CONSTANT (Decr, GL_DECR);
 DELEGATE_GL_CONSTANT (DecrWrap, GL_DECR_WRAP);
 DELEGATE_GL_CONSTANT (DepthBufferBit, GL_DEPTH_BUFFER_BIT);
 DELEGATE_GL_CONSTANT (DepthTest, GL_DEPTH_TEST);
+DELEGATE_GL_CONSTANT (DynamicDraw, GL_DYNAMIC_DRAW);
 DELEGATE_GL_CONSTANT (DstColor, GL_DST_COLOR);
 DELEGATE_GL_CONSTANT (ElementArrayBuffer, GL_ELEMENT_ARRAY_BUFFER);
 DELEGATE_GL_CONSTANT (Equal, GL_EQUAL);
@@ -127,6 +128,7 @@ DELEGATE_GL_CONSTANT (Lines, GL_LINES);
 DELEGATE_GL_CONSTANT (Never, GL_NEVER);
 DELEGATE_GL_CONSTANT (PolygonOffsetFill, GL_POLYGON_OFFSET_FILL);
 DELEGATE_GL_CONSTANT (Replace, GL_REPLACE);
+DELEGATE_GL_CONSTANT (Short, GL_SHORT);
 DELEGATE_GL_CONSTANT (StaticDraw, GL_STATIC_DRAW);
 DELEGATE_GL_CONSTANT (StencilBufferBit, GL_STENCIL_BUFFER_BIT);
 DELEGATE_GL_CONSTANT (StencilTest, GL_STENCIL_TEST);
@@ -138,6 +140,7 @@ DELEGATE2_GL (void, glBindBuffer, unsigned int, unsigned int)
 DELEGATE1_GL (void, glBlendEquation, unsigned int)
 DELEGATE2_GL (void, glBlendFunc, unsigned int, unsigned int)
 DELEGATE4_GL (void, glBufferData, unsigned int, unsigned int, const void*, unsigned int)
+DELEGATE4_GL (void, glBufferSubData, unsigned int, unsigned int, unsigned int, const void*)
 DELEGATE1_GL (void, glClear, unsigned int)
 DELEGATE4_GL (void, glClearColor, float, float, float, float)
 DELEGATE1_GL (void, glClearStencil, int)
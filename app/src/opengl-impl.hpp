@@ -33,6 +33,7 @@ public:
     unsigned int DecrWrap           ();
     unsigned int DepthBufferBit     ();
     unsigned int DepthTest          ();
+    unsigned int DynamicDraw        ();
     unsigned int DstColor           ();
     unsigned int ElementArrayBuffer ();
     unsigned int Equal              ();
@@ -52,6 +53,7 @@ public:
     unsigned int Never              ();
     unsigned int PolygonOffsetFill  ();
     unsigned int Replace            ();
+    unsigned int Short              ();
     unsigned int StaticDraw         ();
     unsigned int StencilBufferBit   ();
     unsigned int StencilTest        ();
@@ -63,6 +65,7 @@ public:
     void glBlendEquation            (unsigned int);
     void glBlendFunc                (unsigned int, unsigned);
     void glBufferData               (unsigned int, unsigned int, const void*, unsigned int);
+    void glBufferSubData            (unsigned int, unsigned int, unsigned int, const void*);
     void glClear                    (unsigned int);
     void glClearColor               (float, float, float, float);
     void glClearStencil             (int);
@@ -401,6 +401,13 @@ void PropertiesWidget::updateImpl(ToolConvertSketch & tool, ViewProperties& prop
     });
     properties.add (smoothMeshEdit);
 
+    QCheckBox& adaptiveEdit = ViewUtil::checkBox ( QObject::tr ("Adaptive")
+                                                 , tool.getAdaptive() );
+    ViewUtil::connect (adaptiveEdit, [&tool] (bool a) {
+      tool.setAdaptive(a);
+    });
+    properties.add (adaptiveEdit);
+
 }
 
 void PropertiesWidget::updateImpl(ToolSketchSpheres& tool, ViewProperties& propertiesView)
@@ -0,0 +1,30 @@
+include (../common.pri)
+
+QT             -= widgets opengl openglextensions xml gui
+CONFIG         += console
+CONFIG         -= app_bundle
+TEMPLATE        = app
+DESTDIR         = $$OUT_PWD/..
+DEPENDPATH     += src 
+INCLUDEPATH    += src $$PWD/../lib
+SOURCES        += src/main.cpp
+
+CONFIG(release, debug|release): TARGET = dilay-convert
+CONFIG(debug  , debug|release): TARGET = dilay-convert_debug
+
+win32 {
+  CONFIG(release, debug|release) {
+    LIBS += -L$$OUT_PWD/../lib/release/ -ldilay
+  }
+  CONFIG(debug, debug|release) {
+    LIBS += -L$$OUT_PWD/../lib/debug/ -ldilay
+  }
+}
+
+unix {
+  LIBS           += -L$$OUT_PWD/../lib/ -ldilay
+  PRE_TARGETDEPS += $$OUT_PWD/../lib/libdilay.a
+
+  target.path     = $$PREFIX/bin/
+  INSTALLS       += target
+}
@@ -0,0 +1,321 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dilay/action/sculpt.hpp"
+#include "dilay/config.hpp"
+#include "dilay/mesh.hpp"
+#include "dilay/null-opengl.hpp"
+#include "dilay/parallel.hpp"
+#include "dilay/scene.hpp"
+#include "dilay/sketch/conversion.hpp"
+#include "dilay/sketch/mesh.hpp"
+#include "dilay/task-pool.hpp"
+#include "dilay/winged/mesh.hpp"
+
+/* `dilay-convert` converts all sketches of `.dly` files to meshes without a GUI and
+ * reports the time of each phase per file.
+ */
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Options {
+    float                     resolution;
+    bool                      adaptive;
+    bool                      smooth;
+    bool                      isObjFile;
+    bool                      isBinary;
+    unsigned int              numThreads;
+    std::string               outputDirectory;
+    std::string               configFileName;
+    std::vector <std::string> fileNames;
+
+    Options ()
+      : resolution (0.05f)
+      , adaptive   (false)
+      , smooth     (false)
+      , isObjFile  (true)
+      , isBinary   (false)
+      , numThreads (0)
+    {}
+  };
+
+  struct Timings {
+    float load;
+    float convert;
+    float smooth;
+    float save;
+
+    Timings () : load (0.0f), convert (0.0f), smooth (0.0f), save (0.0f) {}
+
+    float total () const {
+      return this->load + this->convert + this->smooth + this->save;
+    }
+
+    void add (const Timings& other) {
+      this->load    += other.load;
+      this->convert += other.convert;
+      this->smooth  += other.smooth;
+      this->save    += other.save;
+    }
+  };
+
+  float millisecondsSince (const Clock::time_point& start) {
+    return std::chrono::duration <float, std::milli> (Clock::now () - start).count ();
+  }
+
+  void printUsage (const char* name) {
+    std::cerr << "usage: " << name << " [options] FILE.dly[b]...\n"
+              << "\n"
+              << "Converts all sketches of each file to meshes.\n"
+              << "\n"
+              << "options:\n"
+              << "  -r, --resolution R  resolution of the conversion (default 0.05)\n"
+              << "  -a, --adaptive      refine adaptively instead of uniformly\n"
+              << "  -s, --smooth        smooth converted meshes\n"
+              << "  -f, --format F      output format: obj (default), dly or dlyb\n"
+              << "  -o, --output DIR    output directory (default: directory of FILE)\n"
+              << "  -t, --threads N     number of threads (default 0: all hardware threads)\n"
+              << "  -c, --config FILE   configuration file\n"
+              << "  -h, --help          print this help\n";
+  }
+
+  bool parseOptions (int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+      const std::string arg = argv[i];
+
+      auto value = [argc, argv, &i, &arg] () -> const char* {
+        if (i + 1 < argc) {
+          return argv[++i];
+        }
+        else {
+          std::cerr << "missing value of option " << arg << "\n";
+          return nullptr;
+        }
+      };
+
+      if (arg == "-r" || arg == "--resolution") {
+        const char* v = value ();
+        if (v == nullptr) {
+          return false;
+        }
+        options.resolution = float (std::atof (v));
+
+        if (options.resolution <= 0.0f) {
+          std::cerr << "invalid resolution " << v << "\n";
+          return false;
+        }
+      }
+      else if (arg == "-a" || arg == "--adaptive") {
+        options.adaptive = true;
+      }
+      else if (arg == "-s" || arg == "--smooth") {
+        options.smooth = true;
+      }
+      else if (arg == "-f" || arg == "--format") {
+        const char* v = value ();
+        if (v == nullptr) {
+          return false;
+        }
+        else if (std::string (v) == "obj") {
+          options.isObjFile = true;
+        }
+        else if (std::string (v) == "dly") {
+          options.isObjFile = false;
+          options.isBinary  = false;
+        }
+        else if (std::string (v) == "dlyb") {
+          options.isObjFile = false;
+          options.isBinary  = true;
+        }
+        else {
+          std::cerr << "invalid format " << v << "\n";
+          return false;
+        }
+      }
+      else if (arg == "-o" || arg == "--output") {
+        const char* v = value ();
+        if (v == nullptr) {
+          return false;
+        }
+        options.outputDirectory = v;
+      }
+      else if (arg == "-t" || arg == "--threads") {
+        const char* v = value ();
+        if (v == nullptr) {
+          return false;
+        }
+        options.numThreads = (unsigned int) std::max (0, std::atoi (v));
+      }
+      else if (arg == "-c" || arg == "--config") {
+        const char* v = value ();
+        if (v == nullptr) {
+          return false;
+        }
+        options.configFileName = v;
+      }
+      else if (arg == "-h" || arg == "--help") {
+        return false;
+      }
+      else if (arg.empty () == false && arg[0] == '-') {
+        std::cerr << "unknown option " << arg << "\n";
+        return false;
+      }
+      else {
+        options.fileNames.push_back (arg);
+      }
+    }
+    return options.fileNames.empty () == false;
+  }
+
+  /* `FILE.dly` is written to `FILE.obj`, or to `FILE.converted.dly` (resp.
+   * `FILE.converted.dlyb`) such that it is not overwritten.
+   */
+  std::string outputFileName (const Options& options, const std::string& fileName) {
+    const std::size_t slash     = fileName.find_last_of ("/\\");
+    const std::size_t baseBegin = slash == std::string::npos ? 0 : slash + 1;
+    const std::size_t dot       = fileName.find_last_of ('.');
+    const std::size_t baseEnd   = dot == std::string::npos || dot < baseBegin
+                                ? fileName.size () : dot;
+    const std::string base      = fileName.substr (baseBegin, baseEnd - baseBegin);
+    const std::string extension = options.isObjFile ? ".obj"
+                                : options.isBinary  ? ".converted.dlyb"
+                                                    : ".converted.dly";
+
+    if (options.outputDirectory.empty ()) {
+      return fileName.substr (0, baseBegin) + base + extension;
+    }
+    else {
+      const char last = options.outputDirectory.back ();
+      const bool hasSeparator = last == '/' || last == '\\';
+
+      return options.outputDirectory + (hasSeparator ? "" : "/") + base + extension;
+    }
+  }
+
+  /* Sketches are converted in parallel, each conversion is parallel itself.
+   * Winged meshes are created and smoothed sequentially, since the scene is not
+   * thread-safe.
+   */
+  bool convertFile ( const Config& config, const Options& options, const std::string& fileName
+                   , Timings& timings, unsigned int& numSketches, unsigned int& numFaces )
+  {
+    Scene             scene (config);
+    Clock::time_point start = Clock::now ();
+
+    if (scene.fromDlyFile (config, fileName) == false) {
+      std::cerr << fileName << ": could not load file\n";
+      return false;
+    }
+    timings.load = millisecondsSince (start);
+    start        = Clock::now ();
+
+    std::vector <SketchMesh*> sketches;
+    scene.forEachMesh ([&sketches] (SketchMesh& sketch) {
+      if (sketch.isEmpty () == false) {
+        sketch.optimizePaths ();
+        sketches.push_back (&sketch);
+      }
+    });
+
+    std::vector <Mesh> meshes (sketches.size ());
+
+    Parallel::forRange (sketches.size (), 1, [&options, &sketches, &meshes]
+                                             (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        meshes[i] = options.adaptive
+                  ? SketchConversion::convertAdaptive (*sketches[i], options.resolution)
+                  : SketchConversion::convert         (*sketches[i], options.resolution);
+      }
+    });
+
+    std::vector <WingedMesh*> wingedMeshes;
+    for (unsigned int i = 0; i < sketches.size (); i++) {
+      if (meshes[i].numVertices () > 0) {
+        wingedMeshes.push_back (&scene.newWingedMesh (config, meshes[i]));
+      }
+      scene.deleteMesh (*sketches[i]);
+    }
+    timings.convert = millisecondsSince (start);
+    start           = Clock::now ();
+
+    if (options.smooth) {
+      for (WingedMesh* mesh : wingedMeshes) {
+        Action::smoothMesh (*mesh);
+      }
+    }
+    timings.smooth = millisecondsSince (start);
+    start          = Clock::now ();
+
+    const std::string outFileName = outputFileName (options, fileName);
+
+    if (scene.toDlyFile (outFileName, options.isObjFile) == false) {
+      std::cerr << outFileName << ": could not write file\n";
+      return false;
+    }
+    timings.save = millisecondsSince (start);
+
+    numSketches = sketches.size ();
+    numFaces    = 0;
+    for (WingedMesh* mesh : wingedMeshes) {
+      numFaces += mesh->numFaces ();
+    }
+    return true;
+  }
+}
+
+int main (int argc, char** argv) {
+  Options options;
+
+  if (parseOptions (argc, argv, options) == false) {
+    printUsage (argv[0]);
+    return 1;
+  }
+
+  NullOpenGL openGL;
+  Config     config;
+
+  if (options.configFileName.empty () == false) {
+    config.fromFile (options.configFileName);
+  }
+  TaskPool::global ().numThreads (options.numThreads);
+
+  Timings      total;
+  unsigned int numFailures = 0;
+
+  for (const std::string& fileName : options.fileNames) {
+    Timings      timings;
+    unsigned int numSketches = 0;
+    unsigned int numFaces    = 0;
+
+    if (convertFile (config, options, fileName, timings, numSketches, numFaces)) {
+      std::cout << fileName << ": "
+                << numSketches << " sketches, " << numFaces << " faces, "
+                << "load "    << timings.load    << "ms, "
+                << "convert " << timings.convert << "ms, "
+                << "smooth "  << timings.smooth  << "ms, "
+                << "save "    << timings.save    << "ms\n";
+      total.add (timings);
+    }
+    else {
+      numFailures++;
+    }
+  }
+
+  std::cout << "total: " << (options.fileNames.size () - numFailures) << " files converted, "
+            << numFailures << " failed, " << TaskPool::global ().numThreads () << " threads, "
+            << "load "    << total.load    << "ms, "
+            << "convert " << total.convert << "ms, "
+            << "smooth "  << total.smooth  << "ms, "
+            << "save "    << total.save    << "ms, "
+            << "overall " << total.total () << "ms\n";
+
+  return numFailures == 0 ? 0 : 2;
+}
@@ -1,8 +1,9 @@
 CONFIG      += debug_and_release
 TEMPLATE     = subdirs
-SUBDIRS      = lib app test
+SUBDIRS      = lib app cli test
 
 app.depends  = lib
+cli.depends  = lib
 test.depends = lib
 
 unix {
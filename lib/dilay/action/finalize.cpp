@@ -4,7 +4,7 @@
  */
 #include "action/finalize.hpp"
 #include "affected-faces.hpp"
-#include "index-octree.hpp"
+#include "flat-index-octree.hpp"
 #include "partial-action/collapse-face.hpp"
 #include "winged/mesh.hpp"
 #include "winged/vertex.hpp"
@@ -27,16 +27,17 @@ void Action :: collapseDegeneratedFaces (WingedMesh& mesh, AffectedFaces& affect
   }
 }
 
-void Action :: finalize (WingedMesh& mesh, AffectedFaces& affectedFaces) {
+void Action :: finalizeGeometry (WingedMesh& mesh, AffectedFaces& affectedFaces) {
   for (WingedFace* f : affectedFaces.faces ()) {
     mesh.realignFace (*f);
   }
   Action::collapseDegeneratedFaces (mesh, affectedFaces);
 
-  for (WingedVertex* v : affectedFaces.toVertexSet ()) {
-    v->writeInterpolatedNormal (mesh);
-  }
-  mesh.bufferData ();
-
+  mesh.writeInterpolatedNormals (affectedFaces.toVertexSet ());
   assert (mesh.octree ().numDegeneratedElements () == 0);
 }
+
+void Action :: finalize (WingedMesh& mesh, AffectedFaces& affectedFaces) {
+  Action::finalizeGeometry (mesh, affectedFaces);
+  mesh.bufferData ();
+}
@@ -12,6 +12,12 @@ namespace Action {
 
   void collapseDegeneratedFaces (WingedMesh&);
   void collapseDegeneratedFaces (WingedMesh&, AffectedFaces&);
+
+  /** `finalizeGeometry (m,f)` realigns the faces `f`, collapses degenerated faces and
+   * recomputes normals of `m` without uploading `m` */
+  void finalizeGeometry         (WingedMesh&, AffectedFaces&);
+
+  /** `finalize (m,f)` is equivalent to `finalizeGeometry (m,f)` followed by uploading `m` */
   void finalize                 (WingedMesh&, AffectedFaces&);
 }
 
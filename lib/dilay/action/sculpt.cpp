@@ -12,11 +12,19 @@
 #include "partial-action/relax-edge.hpp"
 #include "partial-action/smooth.hpp"
 #include "partial-action/subdivide-edge.hpp"
+#include "primitive/plane.hpp"
 #include "winged/edge.hpp"
+#include "winged/face.hpp"
 #include "winged/mesh.hpp"
 #include "winged/util.hpp"
 
 namespace {
+  void realignFaces (WingedMesh& mesh, const AffectedFaces& faces) {
+    for (WingedFace* f : faces.faces ()) {
+      mesh.realignFace (*f);
+    }
+  }
+
   void postprocessEdges (const SculptBrush& brush, AffectedFaces& domain) {
     const float maxLength    ((4.0f/3.0f) * brush.subdivThreshold ());
     const float maxLengthSqr (maxLength * maxLength);
@@ -98,13 +106,72 @@ namespace {
 void Action :: sculpt (const SculptBrush& brush) { 
   AffectedFaces domain;
 
-  brush.sculpt (domain);
+  Action::sculptDab      (brush, domain);
+  Action::finalizeSculpt (brush, domain);
+}
+
+void Action :: sculptDab (const SculptBrush& brush, AffectedFaces& domain) { 
+  AffectedFaces dab;
+  WingedMesh&   mesh (brush.meshRef ());
+
+  brush.sculpt (dab);
+
+  // subsequent dabs query the octree before the domain is finalized
+  realignFaces (mesh, dab);
+  domain.insert (dab);
+  domain.commit ();
+}
+
+/* Both dabs are gathered into a single domain, i.e. faces near the mirror plane that are
+ * affected by both dabs are realigned and merged only once.
+ * The mirrored dab must find faces that have just been displaced by the first dab only
+ * if both dabs can reach the same faces: otherwise realigning is deferred.
+ */
+void Action :: sculptMirroredDab ( const SculptBrush& brush, const PrimPlane& plane
+                                 , AffectedFaces& domain )
+{
+  SculptBrush   mirrored (brush);
+  AffectedFaces dab;
+  AffectedFaces mirroredDab;
+  WingedMesh&   mesh (brush.meshRef ());
+
+  mirrored.mirror (plane);
 
+  const float reach   = (2.0f * brush.radius ()) + glm::length (brush.delta ());
+  const bool  overlap = plane.absDistance (brush.position     ()) < reach
+                     || plane.absDistance (brush.lastPosition ()) < reach;
+
+  brush.sculpt (dab);
+
+  if (overlap) {
+    realignFaces (mesh, dab);
+  }
+  mirrored.sculpt (mirroredDab);
+
+  dab.insert (mirroredDab);
+  dab.commit ();
+
+  realignFaces (mesh, overlap ? mirroredDab : dab);
+  domain.insert (dab);
+  domain.commit ();
+}
+
+bool Action :: remeshSculpt (const SculptBrush& brush, AffectedFaces& domain) { 
   if (domain.isEmpty () == false) {
     postprocessEdges (brush, domain);
   }
   if (brush.meshRef ().isEmpty () == false) {
-    Action::finalize (brush.meshRef (), domain);
+    Action::finalizeGeometry (brush.meshRef (), domain);
+    return true;
+  }
+  else {
+    return false;
+  }
+}
+
+void Action :: finalizeSculpt (const SculptBrush& brush, AffectedFaces& domain) { 
+  if (Action::remeshSculpt (brush, domain)) {
+    brush.meshRef ().bufferData ();
   }
 }
 
@@ -5,13 +5,33 @@
 #ifndef DILAY_ACTION_SCULPT
 #define DILAY_ACTION_SCULPT
 
+class AffectedFaces;
+class PrimPlane;
 class SculptBrush;
 class WingedMesh;
 
 namespace Action {
 
-  void sculpt     (const SculptBrush&);
-  void smoothMesh (WingedMesh&);
+  void sculpt            (const SculptBrush&);
+
+  /** `sculptDab (b,d)` displaces vertices by a single dab of `b` and adds all
+   * affected faces to `d` */
+  void sculptDab         (const SculptBrush&, AffectedFaces&);
+
+  /** `sculptMirroredDab (b,p,d)` is equivalent to `sculptDab` with `b` and with `b`
+   * mirrored at `p` */
+  void sculptMirroredDab (const SculptBrush&, const PrimPlane&, AffectedFaces&);
+
+  /** `remeshSculpt (b,d)` remeshes the faces `d` of all dabs since the last call and
+   * recomputes normals of the mesh of `b` without uploading it, i.e. it may be called
+   * by another thread than the one that owns the OpenGL context.
+   * Returns whether the mesh needs to be uploaded. */
+  bool remeshSculpt      (const SculptBrush&, AffectedFaces&);
+
+  /** `finalizeSculpt (b,d)` remeshes the faces `d` of all dabs since the last
+   * call, recomputes normals and uploads the mesh of `b` */
+  void finalizeSculpt    (const SculptBrush&, AffectedFaces&);
+  void smoothMesh        (WingedMesh&);
 };
 
 #endif
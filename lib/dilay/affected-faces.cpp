@@ -7,6 +7,7 @@
 #include "primitive/triangle.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
+#include "winged/vertex.hpp"
 
 struct AffectedFaces::Impl {
   FacePtrSet faces;
@@ -36,7 +37,9 @@ struct AffectedFaces::Impl {
   }
 
   void commit () { 
-    this->faces.insert (this->uncommitedFaces.begin (), this->uncommitedFaces.end ());
+    for (WingedFace* f : this->uncommitedFaces) {
+      this->faces.insert (f);
+    }
     this->uncommitedFaces.clear ();
   }
 
@@ -57,22 +60,8 @@ struct AffectedFaces::Impl {
       return glm::dot (normal, f->triangle (mesh).cross ()) <= 0.0f;
     };
 
-    for (auto it = faces.begin (); it != faces.end (); ) {
-      if (discard (*it)) {
-        it = this->faces.erase (it);
-      }
-      else {
-        ++it;
-      }
-    }
-    for (auto it = uncommitedFaces.begin (); it != uncommitedFaces.end (); ) {
-      if (discard (*it)) {
-        it = this->uncommitedFaces.erase (it);
-      }
-      else {
-        ++it;
-      }
-    }
+    this->faces          .eraseIf (discard);
+    this->uncommitedFaces.eraseIf (discard);
   }
 
   VertexPtrSet toVertexSet () const {
@@ -0,0 +1,282 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <vector>
+#include "compressed-mesh.hpp"
+#include "mesh.hpp"
+
+namespace {
+  typedef std::vector <unsigned char> Bytes;
+
+  static constexpr float quantizationSteps = 65535.0f;
+
+  void writeVarint (Bytes& bytes, std::uint32_t value) {
+    while (value >= 0x80) {
+      bytes.push_back ((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    bytes.push_back (value);
+  }
+
+  std::uint32_t readVarint (const Bytes& bytes, std::size_t& pos) {
+    std::uint32_t value = 0;
+    unsigned int  shift = 0;
+
+    while (bytes.at (pos) & 0x80) {
+      value |= std::uint32_t (bytes [pos++] & 0x7f) << shift;
+      shift += 7;
+    }
+    return value | (std::uint32_t (bytes [pos++]) << shift);
+  }
+
+  std::uint32_t zigzag (std::int32_t value) {
+    return (std::uint32_t (value) << 1) ^ std::uint32_t (value >> 31);
+  }
+
+  std::int32_t unzigzag (std::uint32_t value) {
+    return std::int32_t (value >> 1) ^ -std::int32_t (value & 1);
+  }
+
+  /* LZ77 codec in the spirit of LZ4: the output is a sequence of tokens, each consisting of
+   * a number of literals followed by a back-reference of at least `minMatch` bytes
+   * (the last token has no back-reference).
+   * The high (low) nibble of a token's first byte stores the number of literals (length of
+   * the back-reference minus `minMatch`); a nibble value of 15 is continued by bytes
+   * that are summed up until a byte differs from 255.
+   */
+  namespace Lz {
+    static constexpr unsigned int hashBits  = 14;
+    static constexpr std::size_t  minMatch  = 4;
+    static constexpr std::size_t  maxOffset = 65535;
+
+    void writeLength (Bytes& out, std::size_t length) {
+      while (length >= 255) {
+        out.push_back (255);
+        length -= 255;
+      }
+      out.push_back (length);
+    }
+
+    std::size_t readLength (const Bytes& in, std::size_t& pos, std::size_t nibble) {
+      std::size_t length = nibble;
+      if (nibble == 15) {
+        unsigned char b;
+        do {
+          b       = in.at (pos++);
+          length += b;
+        } while (b == 255);
+      }
+      return length;
+    }
+
+    void writeToken ( Bytes& out, const Bytes& in, std::size_t literalsBegin
+                    , std::size_t numLiterals, std::size_t offset, std::size_t matchLength )
+    {
+      const std::size_t literalNibble = numLiterals < 15 ? numLiterals : 15;
+      const std::size_t matchNibble   = offset == 0 ? 0
+                                      : ( (matchLength - minMatch) < 15 ? (matchLength - minMatch)
+                                                                        : 15 );
+      out.push_back ((literalNibble << 4) | matchNibble);
+
+      if (literalNibble == 15) {
+        writeLength (out, numLiterals - 15);
+      }
+      out.insert ( out.end (), in.begin () + literalsBegin
+                 , in.begin () + literalsBegin + numLiterals );
+
+      if (offset > 0) {
+        out.push_back (offset & 0xff);
+        out.push_back (offset >> 8);
+
+        if (matchNibble == 15) {
+          writeLength (out, matchLength - minMatch - 15);
+        }
+      }
+    }
+
+    Bytes compress (const Bytes& in) {
+      auto read32 = [&in] (std::size_t p) {
+        std::uint32_t v;
+        std::memcpy (&v, &in [p], sizeof (v));
+        return v;
+      };
+      auto hash = [] (std::uint32_t v) {
+        return (v * 2654435761u) >> (32 - hashBits);
+      };
+
+      Bytes                   out;
+      std::vector <long long> table (1 << hashBits, -1);
+      std::size_t             anchor = 0;
+      std::size_t             i      = 0;
+
+      out.reserve (in.size () / 2);
+
+      while (i + minMatch <= in.size ()) {
+        const std::uint32_t v         = read32 (i);
+        const long long     candidate = table [hash (v)];
+
+        table [hash (v)] = i;
+
+        if (candidate >= 0 && i - candidate <= maxOffset && read32 (candidate) == v) {
+          std::size_t length = minMatch;
+          while (i + length < in.size () && in [candidate + length] == in [i + length]) {
+            length++;
+          }
+          writeToken (out, in, anchor, i - anchor, i - candidate, length);
+          i     += length;
+          anchor = i;
+        }
+        else {
+          i++;
+        }
+      }
+      writeToken (out, in, anchor, in.size () - anchor, 0, 0);
+      out.shrink_to_fit ();
+      return out;
+    }
+
+    Bytes decompress (const Bytes& in, std::size_t sizeHint) {
+      Bytes       out;
+      std::size_t pos = 0;
+
+      out.reserve (sizeHint);
+
+      while (pos < in.size ()) {
+        const unsigned char token       = in [pos++];
+        const std::size_t   numLiterals = readLength (in, pos, token >> 4);
+
+        out.insert (out.end (), in.begin () + pos, in.begin () + pos + numLiterals);
+        pos += numLiterals;
+
+        if (pos < in.size ()) {
+          const std::size_t offset = std::size_t (in.at (pos)) | (std::size_t (in.at (pos + 1)) << 8);
+          pos += 2;
+
+          const std::size_t length = readLength (in, pos, token & 0xf) + minMatch;
+          const std::size_t from   = out.size () - offset;
+
+          assert (offset > 0 && offset <= out.size ());
+          for (std::size_t j = 0; j < length; j++) {
+            out.push_back (out [from + j]);
+          }
+        }
+      }
+      return out;
+    }
+  }
+}
+
+struct CompressedMesh::Impl {
+  Mesh         properties;
+  unsigned int numVertices;
+  unsigned int numIndices;
+  glm::vec3    minimum;
+  glm::vec3    extent;
+  std::size_t  positionsSize;
+  std::size_t  indicesSize;
+  Bytes        positions;
+  Bytes        indices;
+
+  Impl (const Mesh& mesh)
+    : properties  (mesh, false)
+    , numVertices (mesh.numVertices ())
+    , numIndices  (mesh.numIndices ())
+    , minimum     (0.0f)
+    , extent      (0.0f)
+  {
+    if (this->numVertices > 0) {
+      glm::vec3 maximum;
+      mesh.minMax (this->minimum, maximum);
+      this->extent = maximum - this->minimum;
+    }
+
+    Bytes         positionBytes;
+    std::uint32_t previous[3] = { 0, 0, 0 };
+
+    positionBytes.reserve (this->numVertices * 3 * 2);
+    for (unsigned int i = 0; i < this->numVertices; i++) {
+      const glm::vec3 v = mesh.vertex (i);
+
+      for (unsigned int c = 0; c < 3; c++) {
+        const std::uint32_t q = this->quantize (v [c], c);
+
+        writeVarint (positionBytes, zigzag (std::int32_t (q) - std::int32_t (previous [c])));
+        previous [c] = q;
+      }
+    }
+
+    Bytes         indexBytes;
+    std::uint32_t previousIndex = 0;
+
+    indexBytes.reserve (this->numIndices * 2);
+    for (unsigned int i = 0; i < this->numIndices; i++) {
+      const std::uint32_t index = mesh.index (i);
+
+      writeVarint (indexBytes, zigzag (std::int32_t (index - previousIndex)));
+      previousIndex = index;
+    }
+
+    this->positionsSize = positionBytes.size ();
+    this->indicesSize   = indexBytes.size ();
+    this->positions     = Lz::compress (positionBytes);
+    this->indices       = Lz::compress (indexBytes);
+  }
+
+  std::uint32_t quantize (float value, unsigned int c) const {
+    if (this->extent [c] > 0.0f) {
+      const float t = glm::clamp ((value - this->minimum [c]) / this->extent [c], 0.0f, 1.0f);
+      return std::uint32_t (glm::round (t * quantizationSteps));
+    }
+    else {
+      return 0;
+    }
+  }
+
+  float dequantize (std::uint32_t q, unsigned int c) const {
+    return this->minimum [c] + (float (q) * (this->extent [c] / quantizationSteps));
+  }
+
+  Mesh mesh () const {
+    Mesh        mesh (this->properties, false);
+    std::size_t pos = 0;
+
+    mesh.reserveVertices (this->numVertices);
+    mesh.reserveIndices  (this->numIndices);
+
+    const Bytes   positionBytes = Lz::decompress (this->positions, this->positionsSize);
+    std::uint32_t previous[3]   = { 0, 0, 0 };
+
+    for (unsigned int i = 0; i < this->numVertices; i++) {
+      glm::vec3 v;
+      for (unsigned int c = 0; c < 3; c++) {
+        previous [c] = std::uint32_t (std::int32_t (previous [c])
+                                    + unzigzag (readVarint (positionBytes, pos)));
+        v [c] = this->dequantize (previous [c], c);
+      }
+      mesh.addVertex (v);
+    }
+
+    const Bytes   indexBytes    = Lz::decompress (this->indices, this->indicesSize);
+    std::uint32_t previousIndex = 0;
+
+    pos = 0;
+    for (unsigned int i = 0; i < this->numIndices; i++) {
+      previousIndex += std::uint32_t (unzigzag (readVarint (indexBytes, pos)));
+      mesh.addIndex (previousIndex);
+    }
+    return mesh;
+  }
+
+  std::size_t numBytes () const {
+    return sizeof (CompressedMesh::Impl) + this->positions.capacity () + this->indices.capacity ();
+  }
+};
+
+DELEGATE1_BIG4MOVE (CompressedMesh, const Mesh&)
+DELEGATE_CONST     (Mesh       , CompressedMesh, mesh)
+DELEGATE_CONST     (std::size_t, CompressedMesh, numBytes)
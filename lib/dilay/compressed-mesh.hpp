@@ -0,0 +1,31 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_COMPRESSED_MESH
+#define DILAY_COMPRESSED_MESH
+
+#include <cstddef>
+#include "macro.hpp"
+
+class Mesh;
+
+/* `CompressedMesh` stores the geometry of a mesh in compressed form:
+ * positions are quantized to 16 bits per component relative to the mesh's bounding box,
+ * normals are dropped and indices are delta-encoded.
+ * Both streams are varint-encoded and compressed by a byte-oriented LZ77 codec.
+ * All other properties (transformations, colors, render mode) are kept as they are.
+ * `mesh ()` returns the decompressed mesh, whose normals must be recomputed.
+ */
+class CompressedMesh {
+  public:
+    DECLARE_BIG4MOVE (CompressedMesh, const Mesh&)
+
+    Mesh        mesh     () const;
+    std::size_t numBytes () const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
@@ -9,7 +9,7 @@
 #include "json-kvstore.hpp"
 
 namespace {
-  static constexpr int latestVersion = 5;
+  static constexpr int latestVersion = 11;
 }
 
 Config :: Config () 
@@ -80,6 +80,7 @@ void Config :: restoreDefaults () {
 
   this->set ("editor/mesh/color/normal",    Color (0.8f, 0.8f, 0.8f));
   this->set ("editor/mesh/color/wireframe", Color (0.3f, 0.3f, 0.3f));
+  this->set ("editor/mesh/packedVertices",  0);
 
   this->set ("editor/sketch/node/color",   Color (0.5f, 0.5f, 0.9f));
   this->set ("editor/sketch/bubble/color", Color (0.5f, 0.5f, 0.7f));
@@ -87,6 +88,7 @@ void Config :: restoreDefaults () {
 
   this->set ("editor/tool/sculpt/detailFactor",       0.75f);
   this->set ("editor/tool/sculpt/stepWidthFactor",   0.1f);
+  this->set ("editor/tool/sculpt/dabSpacing",        1.0f);
   this->set ("editor/tool/sculpt/cursorColor",        Color (1.0f, 0.9f, 0.9f));
   this->set ("editor/tool/sculpt/maxAbsoluteRadius", 2.0f);
   this->set ("editor/tool/sculpt/mirror/width",        0.02f);
@@ -95,7 +97,8 @@ void Config :: restoreDefaults () {
   this->set ("editor/tool/sketchSpheres/cursorColor"     , Color (1.0f, 0.9f, 0.9f));
   this->set ("editor/tool/sketchSpheres/stepWidthFactor", 0.1f);
 
-  this->set ("editor/undoDepth", 15);
+  this->set ("editor/undoMemory", 512);
+  this->set ("editor/numThreads", 0);
 
   this->set ("window/initialWidth",  1024);
   this->set ("window/initialHeight", 768);
@@ -123,6 +126,32 @@ void Config :: update () {
       this->remove ("editor/camera/up");
       break;
 
+    case 5:
+      this->remove ("editor/undoDepth");
+      this->set    ("editor/undoMemory", 512);
+      break;
+
+    case 6:
+      this->set ("editor/tool/sculpt/numThreads", 0);
+      break;
+
+    case 7:
+      this->set ("editor/tool/sculpt/dabSpacing", 1.0f);
+      break;
+
+    case 8:
+      this->set ("editor/numThreads", 0);
+      break;
+
+    case 9:
+      this->set ("editor/mesh/packedVertices", 0);
+      break;
+
+    case 10:
+      updateValue  ("editor/numThreads", 0, this->get <int> ("editor/tool/sculpt/numThreads"));
+      this->remove ("editor/tool/sculpt/numThreads");
+      break;
+
     case latestVersion:
       return;
 
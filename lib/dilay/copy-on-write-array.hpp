@@ -0,0 +1,132 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_COPY_ON_WRITE_ARRAY
+#define DILAY_COPY_ON_WRITE_ARRAY
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/* `CopyOnWriteArray <T>` is a dynamic array that stores its elements in chunks of
+ * `chunkSize` elements. Copies share all chunks, i.e. copying an array only copies
+ * a table of chunk pointers, and a shared chunk is copied right before it is modified.
+ * `chunkSize` is a multiple of 3, so that vertices and faces never straddle two chunks.
+ * Shared chunks are never modified, i.e. a copy can be read by another thread while
+ * the original is modified. Copies must be taken by the thread that modifies the original.
+ */
+template <typename T>
+class CopyOnWriteArray {
+    static_assert (std::is_trivially_copyable <T>::value, "elements must be trivially copyable");
+
+  public:
+    static constexpr unsigned int chunkSize = 3 * 1024;
+
+    CopyOnWriteArray () : _size (0) {}
+
+    unsigned int size  () const { return this->_size; }
+    bool         empty () const { return this->_size == 0; }
+
+    const T& operator[] (unsigned int i) const {
+      assert (i < this->_size);
+      return this->_chunks [i / chunkSize].get () [i % chunkSize];
+    }
+
+    void set (unsigned int i, const T& value) {
+      assert (i < this->_size);
+      this->mutableChunk (i / chunkSize) [i % chunkSize] = value;
+    }
+
+    void pushBack (const T& value) {
+      if (this->_size % chunkSize == 0) {
+        this->_chunks.push_back (makeChunk ());
+      }
+      this->_size++;
+      this->set (this->_size - 1, value);
+    }
+
+    void append (const T* values, unsigned int n) {
+      for (unsigned int i = 0; i < n; ) {
+        if (this->_size % chunkSize == 0) {
+          this->_chunks.push_back (makeChunk ());
+        }
+        const unsigned int offset = this->_size % chunkSize;
+        const unsigned int m      = std::min (n - i, chunkSize - offset);
+
+        std::copy (values + i, values + i + m, this->mutableChunk (this->_size / chunkSize) + offset);
+        this->_size += m;
+        i           += m;
+      }
+    }
+
+    void resize (unsigned int n, const T& value) {
+      if (n < this->_size) {
+        this->_chunks.resize ((n + chunkSize - 1) / chunkSize);
+        this->_size = n;
+      }
+      else {
+        while (this->_size < n) {
+          this->pushBack (value);
+        }
+      }
+    }
+
+    void reserve (unsigned int n) {
+      this->_chunks.reserve ((n + chunkSize - 1) / chunkSize);
+    }
+
+    void clear () {
+      this->_chunks.clear ();
+      this->_size = 0;
+    }
+
+    /* `f (begin, end, data)` is called for contiguous segments of `[begin, end)` in
+     * increasing order, where `data` points to the element at `begin`.
+     */
+    template <typename F>
+    void forEachSegment (unsigned int begin, unsigned int end, const F& f) const {
+      assert (end <= this->_size);
+
+      while (begin < end) {
+        const unsigned int offset = begin % chunkSize;
+        const unsigned int m      = std::min (end - begin, chunkSize - offset);
+
+        f (begin, begin + m, this->_chunks [begin / chunkSize].get () + offset);
+        begin += m;
+      }
+    }
+
+  private:
+    typedef std::shared_ptr <T> Chunk;
+
+    static Chunk makeChunk () {
+      return Chunk (new T [chunkSize], std::default_delete <T[]> ());
+    }
+
+    /* A chunk that is only referenced by this array can be modified in place.
+     * The fence orders the modification after all reads of a copy that has released
+     * the chunk on another thread.
+     */
+    T* mutableChunk (unsigned int c) {
+      Chunk& chunk = this->_chunks [c];
+
+      if (chunk.use_count () > 1) {
+        Chunk copy = makeChunk ();
+        std::copy (chunk.get (), chunk.get () + chunkSize, copy.get ());
+        chunk = std::move (copy);
+      }
+      else {
+        std::atomic_thread_fence (std::memory_order_acquire);
+      }
+      return chunk.get ();
+    }
+
+    std::vector <Chunk> _chunks;
+    unsigned int        _size;
+};
+
+#endif
@@ -0,0 +1,279 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "falloff.hpp"
+#include "util.hpp"
+
+#if defined (__x86_64__) || defined (__i386__) || defined (_M_X64) || defined (_M_IX86)
+#  define DILAY_FALLOFF_X86
+#  include <immintrin.h>
+#  if defined (_MSC_VER)
+#    include <intrin.h>
+#  endif
+#endif
+
+#if defined (DILAY_FALLOFF_X86) && defined (__GNUC__)
+#  define DILAY_TARGET_SSE2 __attribute__ ((target ("sse2")))
+#  define DILAY_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#else
+#  define DILAY_TARGET_SSE2
+#  define DILAY_TARGET_AVX2
+#endif
+
+namespace {
+  /* `Step` is used by both step functions if inner and outer radius are equal */
+  enum class Mode { Distance, Step, LinearStep, SmoothStep };
+
+  Mode toMode (Falloff::Function function, float innerRadius, float radius) {
+    assert (innerRadius <= radius);
+
+    if (function == Falloff::Function::Distance) {
+      return Mode::Distance;
+    }
+    else if (radius - innerRadius < Util::epsilon ()) {
+      return Mode::Step;
+    }
+    else if (function == Falloff::Function::LinearStep) {
+      return Mode::LinearStep;
+    }
+    else {
+      return Mode::SmoothStep;
+    }
+  }
+
+  /* All implementations evaluate the same sequence of operations as their scalar
+   * counterparts in `Util`, i.e. they compute identical values.
+   */
+  template <Mode M>
+  void evaluateScalar ( const float* xs, const float* ys, const float* zs
+                      , unsigned int begin, unsigned int n, const glm::vec3& center
+                      , float innerRadius, float radius, float* out )
+  {
+    const float width = radius - innerRadius;
+
+    for (unsigned int i = begin; i < n; i++) {
+      const float dx = xs[i] - center.x;
+      const float dy = ys[i] - center.y;
+      const float dz = zs[i] - center.z;
+      const float d  = std::sqrt ((dx*dx + dy*dy) + dz*dz);
+
+      switch (M) {
+        case Mode::Distance:
+          out[i] = d;
+          break;
+        case Mode::Step:
+          out[i] = d > radius ? 0.0f : 1.0f;
+          break;
+        case Mode::LinearStep:
+          out[i] = std::min (std::max ((radius - d) / width, 0.0f), 1.0f);
+          break;
+        case Mode::SmoothStep: {
+          const float x = std::min (std::max ((radius - d) / width, 0.0f), 1.0f);
+          out[i] = x*x*x * (x * (x*6.0f - 15.0f) + 10.0f);
+          break;
+        }
+      }
+    }
+  }
+
+#ifdef DILAY_FALLOFF_X86
+  template <Mode M> DILAY_TARGET_SSE2
+  void evaluateSSE2 ( const float* xs, const float* ys, const float* zs, unsigned int n
+                    , const glm::vec3& center, float innerRadius, float radius, float* out )
+  {
+    const __m128 cx      = _mm_set1_ps (center.x);
+    const __m128 cy      = _mm_set1_ps (center.y);
+    const __m128 cz      = _mm_set1_ps (center.z);
+    const __m128 vRadius = _mm_set1_ps (radius);
+    const __m128 vWidth  = _mm_set1_ps (radius - innerRadius);
+    const __m128 zero    = _mm_setzero_ps ();
+    const __m128 one     = _mm_set1_ps (1.0f);
+    const __m128 six     = _mm_set1_ps (6.0f);
+    const __m128 fifteen = _mm_set1_ps (15.0f);
+    const __m128 ten     = _mm_set1_ps (10.0f);
+
+    unsigned int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m128 dx = _mm_sub_ps (_mm_loadu_ps (xs + i), cx);
+      const __m128 dy = _mm_sub_ps (_mm_loadu_ps (ys + i), cy);
+      const __m128 dz = _mm_sub_ps (_mm_loadu_ps (zs + i), cz);
+      const __m128 d  = _mm_sqrt_ps (_mm_add_ps ( _mm_add_ps ( _mm_mul_ps (dx, dx)
+                                                             , _mm_mul_ps (dy, dy) )
+                                                , _mm_mul_ps (dz, dz) ));
+      switch (M) {
+        case Mode::Distance:
+          _mm_storeu_ps (out + i, d);
+          break;
+        case Mode::Step:
+          _mm_storeu_ps (out + i, _mm_andnot_ps (_mm_cmpgt_ps (d, vRadius), one));
+          break;
+        case Mode::LinearStep:
+          _mm_storeu_ps (out + i, _mm_min_ps (_mm_max_ps ( _mm_div_ps (_mm_sub_ps (vRadius, d), vWidth)
+                                                         , zero ), one));
+          break;
+        case Mode::SmoothStep: {
+          const __m128 x  = _mm_min_ps (_mm_max_ps ( _mm_div_ps (_mm_sub_ps (vRadius, d), vWidth)
+                                                   , zero ), one);
+          const __m128 x3 = _mm_mul_ps (_mm_mul_ps (x, x), x);
+          const __m128 p  = _mm_add_ps (_mm_mul_ps (x, _mm_sub_ps (_mm_mul_ps (x, six), fifteen)), ten);
+          _mm_storeu_ps (out + i, _mm_mul_ps (x3, p));
+          break;
+        }
+      }
+    }
+    evaluateScalar <M> (xs, ys, zs, i, n, center, innerRadius, radius, out);
+  }
+
+  template <Mode M> DILAY_TARGET_AVX2
+  void evaluateAVX2 ( const float* xs, const float* ys, const float* zs, unsigned int n
+                    , const glm::vec3& center, float innerRadius, float radius, float* out )
+  {
+    const __m256 cx      = _mm256_set1_ps (center.x);
+    const __m256 cy      = _mm256_set1_ps (center.y);
+    const __m256 cz      = _mm256_set1_ps (center.z);
+    const __m256 vRadius = _mm256_set1_ps (radius);
+    const __m256 vWidth  = _mm256_set1_ps (radius - innerRadius);
+    const __m256 zero    = _mm256_setzero_ps ();
+    const __m256 one     = _mm256_set1_ps (1.0f);
+    const __m256 six     = _mm256_set1_ps (6.0f);
+    const __m256 fifteen = _mm256_set1_ps (15.0f);
+    const __m256 ten     = _mm256_set1_ps (10.0f);
+
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const __m256 dx = _mm256_sub_ps (_mm256_loadu_ps (xs + i), cx);
+      const __m256 dy = _mm256_sub_ps (_mm256_loadu_ps (ys + i), cy);
+      const __m256 dz = _mm256_sub_ps (_mm256_loadu_ps (zs + i), cz);
+      const __m256 d  = _mm256_sqrt_ps (_mm256_add_ps ( _mm256_add_ps ( _mm256_mul_ps (dx, dx)
+                                                                      , _mm256_mul_ps (dy, dy) )
+                                                      , _mm256_mul_ps (dz, dz) ));
+      switch (M) {
+        case Mode::Distance:
+          _mm256_storeu_ps (out + i, d);
+          break;
+        case Mode::Step:
+          _mm256_storeu_ps (out + i, _mm256_andnot_ps (_mm256_cmp_ps (d, vRadius, _CMP_GT_OQ), one));
+          break;
+        case Mode::LinearStep:
+          _mm256_storeu_ps (out + i, _mm256_min_ps (_mm256_max_ps ( _mm256_div_ps ( _mm256_sub_ps (vRadius, d)
+                                                                                   , vWidth )
+                                                                   , zero ), one));
+          break;
+        case Mode::SmoothStep: {
+          const __m256 x  = _mm256_min_ps (_mm256_max_ps ( _mm256_div_ps (_mm256_sub_ps (vRadius, d), vWidth)
+                                                         , zero ), one);
+          const __m256 x3 = _mm256_mul_ps (_mm256_mul_ps (x, x), x);
+          const __m256 p  = _mm256_add_ps ( _mm256_mul_ps (x, _mm256_sub_ps (_mm256_mul_ps (x, six), fifteen))
+                                          , ten );
+          _mm256_storeu_ps (out + i, _mm256_mul_ps (x3, p));
+          break;
+        }
+      }
+    }
+    evaluateScalar <M> (xs, ys, zs, i, n, center, innerRadius, radius, out);
+  }
+
+  bool cpuSupports (Falloff::InstructionSet set) {
+#  if defined (_MSC_VER)
+    int info[4];
+    __cpuid (info, 1);
+
+    if (set == Falloff::InstructionSet::SSE2) {
+      return (info[3] & (1 << 26)) != 0;
+    }
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28))
+                         && ((_xgetbv (0) & 6) == 6);
+    __cpuidex (info, 7, 0);
+    return osSavesAvx && (info[1] & (1 << 5)) != 0;
+#  elif defined (__GNUC__)
+    __builtin_cpu_init ();
+    return set == Falloff::InstructionSet::SSE2 ? __builtin_cpu_supports ("sse2")
+                                                : __builtin_cpu_supports ("avx2");
+#  else
+    return false;
+#  endif
+  }
+#endif
+
+  template <Mode M>
+  void evaluateMode ( Falloff::InstructionSet set, const float* xs, const float* ys
+                    , const float* zs, unsigned int n, const glm::vec3& center
+                    , float innerRadius, float radius, float* out )
+  {
+    switch (set) {
+#ifdef DILAY_FALLOFF_X86
+      case Falloff::InstructionSet::AVX2:
+        return evaluateAVX2 <M> (xs, ys, zs, n, center, innerRadius, radius, out);
+      case Falloff::InstructionSet::SSE2:
+        return evaluateSSE2 <M> (xs, ys, zs, n, center, innerRadius, radius, out);
+#endif
+      default:
+        return evaluateScalar <M> (xs, ys, zs, 0, n, center, innerRadius, radius, out);
+    }
+  }
+}
+
+bool Falloff :: isSupported (InstructionSet set) {
+  switch (set) {
+    case InstructionSet::Scalar:
+      return true;
+#ifdef DILAY_FALLOFF_X86
+    case InstructionSet::SSE2:
+    case InstructionSet::AVX2: {
+      static const bool sse2 = cpuSupports (InstructionSet::SSE2);
+      static const bool avx2 = cpuSupports (InstructionSet::AVX2);
+      return set == InstructionSet::SSE2 ? sse2 : avx2;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+Falloff::InstructionSet Falloff :: bestInstructionSet () {
+  static const InstructionSet best = isSupported (InstructionSet::AVX2) ? InstructionSet::AVX2
+                                   : isSupported (InstructionSet::SSE2) ? InstructionSet::SSE2
+                                                                        : InstructionSet::Scalar;
+  return best;
+}
+
+const char* Falloff :: name (InstructionSet set) {
+  switch (set) {
+    case InstructionSet::Scalar: return "scalar";
+    case InstructionSet::SSE2:   return "sse2";
+    case InstructionSet::AVX2:   return "avx2";
+  }
+  DILAY_IMPOSSIBLE
+}
+
+void Falloff :: evaluate ( Function function, const float* xs, const float* ys
+                         , const float* zs, unsigned int n, const glm::vec3& center
+                         , float innerRadius, float radius, float* out )
+{
+  Falloff::evaluate ( bestInstructionSet (), function, xs, ys, zs, n
+                    , center, innerRadius, radius, out );
+}
+
+void Falloff :: evaluate ( InstructionSet set, Function function, const float* xs
+                         , const float* ys, const float* zs, unsigned int n
+                         , const glm::vec3& center, float innerRadius, float radius
+                         , float* out )
+{
+  assert (isSupported (set));
+
+  switch (toMode (function, innerRadius, radius)) {
+    case Mode::Distance:
+      return evaluateMode <Mode::Distance> (set, xs, ys, zs, n, center, innerRadius, radius, out);
+    case Mode::Step:
+      return evaluateMode <Mode::Step> (set, xs, ys, zs, n, center, innerRadius, radius, out);
+    case Mode::LinearStep:
+      return evaluateMode <Mode::LinearStep> (set, xs, ys, zs, n, center, innerRadius, radius, out);
+    case Mode::SmoothStep:
+      return evaluateMode <Mode::SmoothStep> (set, xs, ys, zs, n, center, innerRadius, radius, out);
+  }
+}
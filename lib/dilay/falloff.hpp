@@ -0,0 +1,35 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_FALLOFF
+#define DILAY_FALLOFF
+
+#include <glm/fwd.hpp>
+
+/* Batched evaluation of brush falloffs over positions that are stored as separate
+ * arrays of x, y and z coordinates.
+ * `SmoothStep` and `LinearStep` compute the same values as `Util::smoothStep` and
+ * `Util::linearStep`, `Distance` computes the distance to the center.
+ * The instruction set is chosen at runtime: AVX2 and SSE2 are used if they are
+ * available, the scalar implementation is used otherwise.
+ */
+namespace Falloff {
+  enum class Function       { Distance, LinearStep, SmoothStep };
+  enum class InstructionSet { Scalar, SSE2, AVX2 };
+
+  InstructionSet bestInstructionSet ();
+  bool           isSupported        (InstructionSet);
+  const char*    name               (InstructionSet);
+
+  /** `evaluate (f, xs, ys, zs, n, c, i, r, out)` writes `f (p_k, c, i, r)` to `out[k]`,
+   * where `p_k = (xs[k], ys[k], zs[k])` and `0 <= k < n`.
+   */
+  void evaluate ( Function, const float*, const float*, const float*, unsigned int
+                , const glm::vec3&, float, float, float* );
+
+  void evaluate ( InstructionSet, Function, const float*, const float*, const float*
+                , unsigned int, const glm::vec3&, float, float, float* );
+}
+
+#endif
@@ -0,0 +1,658 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include "flat-index-octree.hpp"
+#include "intersection.hpp"
+#include "primitive/aabox.hpp"
+#include "primitive/sphere.hpp"
+#include "util.hpp"
+
+#ifdef DILAY_RENDER_OCTREE
+#include "color.hpp"
+#include "mesh.hpp"
+#include "render-mode.hpp"
+#endif
+
+namespace {
+  typedef std::uint32_t Index;
+
+  static constexpr Index none                     = std::numeric_limits <Index>::max ();
+  static constexpr Index degeneratedNode          = none - 1;
+  static constexpr Index minElementsCapacity      = 4;
+  static constexpr int   localStackSize           = 256;
+  static constexpr float relativeMinElementExtent = 0.1f;
+
+  struct FlatIndexOctreeNode {
+    glm::vec3 center;
+    float     width;
+    int       depth;
+    Index     firstChild;
+    Index     elementsBegin;
+    Index     numElements;
+    Index     elementsCapacity;
+
+    FlatIndexOctreeNode (const glm::vec3& c, float w, int d)
+      : center           (c)
+      , width            (w)
+      , depth            (d)
+      , firstChild       (none)
+      , elementsBegin    (0)
+      , numElements      (0)
+      , elementsCapacity (0)
+    {}
+
+    bool hasChildren () const {
+      return this->firstChild != none;
+    }
+
+    bool isEmpty () const {
+      return this->numElements == 0 && this->hasChildren () == false;
+    }
+
+    bool approxContains (const glm::vec3& position, float maxDimExtent) const {
+      const glm::vec3 min = this->center - glm::vec3 (this->width * 0.5f);
+      const glm::vec3 max = this->center + glm::vec3 (this->width * 0.5f);
+      return glm::all ( glm::lessThanEqual (min, position) )
+         &&  glm::all ( glm::lessThanEqual (position, max) )
+         &&  maxDimExtent <= this->width;
+    }
+
+    // see `IndexOctreeNode::childIndex`
+    unsigned int childIndex (const glm::vec3& position) const {
+      unsigned int index = 0;
+      if (this->center.x < position.x) {
+        index += 4;
+      }
+      if (this->center.y < position.y) {
+        index += 2;
+      }
+      if (this->center.z < position.z) {
+        index += 1;
+      }
+      return index;
+    }
+
+    glm::vec3 childCenter (unsigned int i) const {
+      const float q = this->width * 0.25f;
+      return this->center + glm::vec3 ( (i & 4) ? q : -q
+                                      , (i & 2) ? q : -q
+                                      , (i & 1) ? q : -q );
+    }
+
+    PrimAABox looseAABox () const {
+      const float looseWidth = this->width * 2.0f;
+      return PrimAABox (this->center, looseWidth, looseWidth, looseWidth);
+    }
+  };
+
+  struct FlatIndexOctreeStatistics {
+    typedef std::unordered_map <int, unsigned int> DepthMap;
+
+    unsigned int numNodes;
+    unsigned int numElements;
+    int          minDepth;
+    int          maxDepth;
+    unsigned int maxElementsPerNode;
+    DepthMap     numElementsPerDepth;
+    DepthMap     numNodesPerDepth;
+  };
+}
+
+struct FlatIndexOctree::Impl {
+  typedef FlatIndexOctreeNode Node;
+
+  /* `nodes [0]` is the root (if any).
+   * The elements of node `n` are stored in `elements [n.elementsBegin ...]`, where
+   * `elementNode [e]` and `elementSlot [e]` denote the node and position of element `e`.
+   */
+  std::vector <Node>  nodes;
+  std::vector <Index> freeBlocks;
+  std::vector <Index> elements;
+  std::vector <Index> degeneratedElements;
+  std::vector <Index> elementNode;
+  std::vector <Index> elementSlot;
+  std::size_t         numGarbageElements;
+  glm::vec3           rootPosition;
+  float               rootWidth;
+  bool                rootWasSetUp;
+#ifdef DILAY_RENDER_OCTREE
+  Mesh                nodeMesh;
+#endif
+
+  Impl ()
+    : numGarbageElements (0)
+    , rootWasSetUp       (false)
+  {
+#ifdef DILAY_RENDER_OCTREE
+    this->nodeMesh.addVertex (glm::vec3 (-1.0f, -1.0f, -1.0f));
+    this->nodeMesh.addVertex (glm::vec3 (-1.0f, -1.0f,  1.0f));
+    this->nodeMesh.addVertex (glm::vec3 (-1.0f,  1.0f, -1.0f));
+    this->nodeMesh.addVertex (glm::vec3 (-1.0f,  1.0f,  1.0f));
+    this->nodeMesh.addVertex (glm::vec3 ( 1.0f, -1.0f, -1.0f));
+    this->nodeMesh.addVertex (glm::vec3 ( 1.0f, -1.0f,  1.0f));
+    this->nodeMesh.addVertex (glm::vec3 ( 1.0f,  1.0f, -1.0f));
+    this->nodeMesh.addVertex (glm::vec3 ( 1.0f,  1.0f,  1.0f));
+
+    this->nodeMesh.addIndex (0); this->nodeMesh.addIndex (1);
+    this->nodeMesh.addIndex (1); this->nodeMesh.addIndex (3);
+    this->nodeMesh.addIndex (3); this->nodeMesh.addIndex (2);
+    this->nodeMesh.addIndex (2); this->nodeMesh.addIndex (0);
+
+    this->nodeMesh.addIndex (4); this->nodeMesh.addIndex (5);
+    this->nodeMesh.addIndex (5); this->nodeMesh.addIndex (7);
+    this->nodeMesh.addIndex (7); this->nodeMesh.addIndex (6);
+    this->nodeMesh.addIndex (6); this->nodeMesh.addIndex (4);
+
+    this->nodeMesh.addIndex (1); this->nodeMesh.addIndex (5);
+    this->nodeMesh.addIndex (5); this->nodeMesh.addIndex (7);
+    this->nodeMesh.addIndex (7); this->nodeMesh.addIndex (3);
+    this->nodeMesh.addIndex (3); this->nodeMesh.addIndex (1);
+
+    this->nodeMesh.addIndex (4); this->nodeMesh.addIndex (6);
+    this->nodeMesh.addIndex (6); this->nodeMesh.addIndex (2);
+    this->nodeMesh.addIndex (2); this->nodeMesh.addIndex (0);
+    this->nodeMesh.addIndex (0); this->nodeMesh.addIndex (4);
+
+    this->nodeMesh.renderMode ().constantShading (true);
+    this->nodeMesh.renderMode ().noDepthTest (true);
+    this->nodeMesh.color      (Color (1.0f, 1.0f, 0.0f));
+    this->nodeMesh.bufferData ();
+#endif
+  }
+
+#ifdef DILAY_RENDER_OCTREE
+  Impl (const Impl& other)
+    : nodes               (other.nodes)
+    , freeBlocks          (other.freeBlocks)
+    , elements            (other.elements)
+    , degeneratedElements (other.degeneratedElements)
+    , elementNode         (other.elementNode)
+    , elementSlot         (other.elementSlot)
+    , numGarbageElements  (other.numGarbageElements)
+    , rootPosition        (other.rootPosition)
+    , rootWidth           (other.rootWidth)
+    , rootWasSetUp        (other.rootWasSetUp)
+    , nodeMesh            (other.nodeMesh)
+  {
+    this->nodeMesh.bufferData ();
+  }
+#endif
+
+  bool hasRoot () const {
+    return this->nodes.empty () == false;
+  }
+
+  void setupRoot (const glm::vec3& position, float width) {
+    assert (this->hasRoot () == false);
+    this->rootWasSetUp = true;
+    this->rootPosition = position;
+    this->rootWidth    = width;
+  }
+
+  Index allocateBlock (const glm::vec3& parentCenter, float parentWidth, int parentDepth) {
+    const Node  parent (parentCenter, parentWidth, parentDepth);
+    const float childWidth = parentWidth * 0.5f;
+    const int   childDepth = parentDepth + 1;
+    Index       block;
+
+    if (this->freeBlocks.empty ()) {
+      block = Index (this->nodes.size ());
+      for (unsigned int i = 0; i < 8; i++) {
+        this->nodes.emplace_back (parent.childCenter (i), childWidth, childDepth);
+      }
+    }
+    else {
+      block = this->freeBlocks.back ();
+      this->freeBlocks.pop_back ();
+      for (unsigned int i = 0; i < 8; i++) {
+        this->nodes [block + i] = Node (parent.childCenter (i), childWidth, childDepth);
+      }
+    }
+    return block;
+  }
+
+  void freeBlock (Index block) {
+    for (unsigned int i = 0; i < 8; i++) {
+      assert (this->nodes [block + i].isEmpty ());
+      this->numGarbageElements += this->nodes [block + i].elementsCapacity;
+      this->nodes [block + i].elementsCapacity = 0;
+    }
+    this->freeBlocks.push_back (block);
+  }
+
+  void makeChildren (Index n) {
+    assert (this->nodes [n].hasChildren () == false);
+    const Node  node  = this->nodes [n];
+    const Index block = this->allocateBlock (node.center, node.width, node.depth);
+
+    this->nodes [n].firstChild = block;
+  }
+
+  void compactElements () {
+    std::vector <Index> compacted;
+    compacted.reserve (this->elements.size () - this->numGarbageElements);
+
+    for (Node& node : this->nodes) {
+      const Index begin = Index (compacted.size ());
+
+      compacted.insert ( compacted.end ()
+                       , this->elements.begin () + node.elementsBegin
+                       , this->elements.begin () + node.elementsBegin + node.elementsCapacity );
+      node.elementsBegin = begin;
+    }
+    this->elements.swap (compacted);
+    this->numGarbageElements = 0;
+  }
+
+  void addToElementMaps (Index index, Index node, Index slot) {
+    if (index >= this->elementNode.size ()) {
+      this->elementNode.resize (index + 1, none);
+      this->elementSlot.resize (index + 1, none);
+    }
+    assert (this->elementNode [index] == none);
+    this->elementNode [index] = node;
+    this->elementSlot [index] = slot;
+  }
+
+  void pushElement (Index n, Index index) {
+    Node& node = this->nodes [n];
+
+    if (node.numElements == node.elementsCapacity) {
+      const Index newCapacity = glm::max (minElementsCapacity, 2 * node.elementsCapacity);
+      const Index newBegin    = Index (this->elements.size ());
+
+      this->elements.resize (this->elements.size () + newCapacity, none);
+      std::copy ( this->elements.begin () + node.elementsBegin
+                , this->elements.begin () + node.elementsBegin + node.numElements
+                , this->elements.begin () + newBegin );
+
+      this->numGarbageElements += node.elementsCapacity;
+      node.elementsBegin        = newBegin;
+      node.elementsCapacity     = newCapacity;
+    }
+    this->elements [node.elementsBegin + node.numElements] = index;
+    this->addToElementMaps (index, n, node.numElements);
+    node.numElements++;
+
+    if (this->numGarbageElements > 1024 && this->numGarbageElements > this->elements.size () / 2) {
+      this->compactElements ();
+    }
+  }
+
+  void makeParent (const glm::vec3& position) {
+    assert (this->hasRoot ());
+
+    const Node      oldRoot       = this->nodes [0];
+    const float     halfRootWidth = oldRoot.width * 0.5f;
+    glm::vec3       parentCenter;
+    unsigned int    index         = 0;
+
+    if (oldRoot.center.x < position.x)
+      parentCenter.x = oldRoot.center.x + halfRootWidth;
+    else {
+      parentCenter.x = oldRoot.center.x - halfRootWidth;
+      index         += 4;
+    }
+    if (oldRoot.center.y < position.y)
+      parentCenter.y = oldRoot.center.y + halfRootWidth;
+    else {
+      parentCenter.y = oldRoot.center.y - halfRootWidth;
+      index         += 2;
+    }
+    if (oldRoot.center.z < position.z)
+      parentCenter.z = oldRoot.center.z + halfRootWidth;
+    else {
+      parentCenter.z = oldRoot.center.z - halfRootWidth;
+      index         += 1;
+    }
+
+    const Index block = this->allocateBlock (parentCenter, oldRoot.width * 2.0f, oldRoot.depth - 1);
+    const Index moved = block + index;
+
+    this->nodes [moved] = oldRoot;
+    for (Index i = 0; i < oldRoot.numElements; i++) {
+      this->elementNode [this->elements [oldRoot.elementsBegin + i]] = moved;
+    }
+    this->nodes [0]            = Node (parentCenter, oldRoot.width * 2.0f, oldRoot.depth - 1);
+    this->nodes [0].firstChild = block;
+  }
+
+  void addElement (unsigned int index, const glm::vec3& position, float maxDimExtent) {
+    if (this->hasRoot () == false) {
+      if (this->rootWasSetUp == false) {
+        this->rootPosition = position;
+        this->rootWidth    = maxDimExtent + Util::epsilon ();
+      }
+      this->nodes.emplace_back (this->rootPosition, this->rootWidth, 0);
+    }
+
+    while (this->nodes [0].approxContains (position, maxDimExtent) == false) {
+      this->makeParent (position);
+    }
+
+    Index n = 0;
+    while (maxDimExtent <= this->nodes [n].width * relativeMinElementExtent) {
+      if (this->nodes [n].hasChildren () == false) {
+        this->makeChildren (n);
+      }
+      n = this->nodes [n].firstChild + this->nodes [n].childIndex (position);
+    }
+    this->pushElement (n, index);
+  }
+
+  void addDegeneratedElement (unsigned int index) {
+    this->addToElementMaps (index, degeneratedNode, this->degeneratedElements.size ());
+    this->degeneratedElements.push_back (index);
+  }
+
+  void deleteElement (unsigned int index) {
+    assert (index < this->elementNode.size ());
+    assert (this->elementNode [index] != none);
+
+    const Index n    = this->elementNode [index];
+    const Index slot = this->elementSlot [index];
+
+    if (n == degeneratedNode) {
+      const Index last = this->degeneratedElements.back ();
+
+      this->degeneratedElements [slot] = last;
+      this->elementSlot [last]         = slot;
+      this->degeneratedElements.pop_back ();
+    }
+    else {
+      Node&       node = this->nodes [n];
+      const Index last = this->elements [node.elementsBegin + node.numElements - 1];
+
+      this->elements [node.elementsBegin + slot] = last;
+      this->elementSlot [last]                   = slot;
+      node.numElements--;
+    }
+    this->elementNode [index] = none;
+    this->elementSlot [index] = none;
+
+    if (this->hasRoot ()) {
+      if (this->nodes [0].isEmpty ()) {
+        this->resetNodes ();
+      }
+      else {
+        this->shrinkRoot ();
+      }
+    }
+  }
+
+  bool deleteEmptyChildren (Index n) {
+    if (this->nodes [n].hasChildren ()) {
+      const Index block            = this->nodes [n].firstChild;
+      bool        allChildrenEmpty = true;
+
+      for (unsigned int i = 0; i < 8; i++) {
+        if (this->deleteEmptyChildren (block + i) == false) {
+          allChildrenEmpty = false;
+        }
+      }
+      if (allChildrenEmpty) {
+        this->freeBlock (block);
+        this->nodes [n].firstChild = none;
+      }
+    }
+    return this->nodes [n].isEmpty ();
+  }
+
+  void deleteEmptyChildren () {
+    if (this->hasRoot ()) {
+      if (this->deleteEmptyChildren (0)) {
+        this->resetNodes ();
+      }
+    }
+  }
+
+  void shrinkRoot () {
+    while (this->hasRoot () && this->nodes [0].numElements == 0 && this->nodes [0].hasChildren ()) {
+      const Index block                    = this->nodes [0].firstChild;
+      int         singleNonEmptyChildIndex = -1;
+
+      for (int i = 0; i < 8; i++) {
+        if (this->nodes [block + i].isEmpty () == false) {
+          if (singleNonEmptyChildIndex == -1) {
+            singleNonEmptyChildIndex = i;
+          }
+          else {
+            return;
+          }
+        }
+      }
+      if (singleNonEmptyChildIndex == -1) {
+        return;
+      }
+      const Index child = block + singleNonEmptyChildIndex;
+
+      this->numGarbageElements += this->nodes [0].elementsCapacity;
+      this->nodes [0]           = this->nodes [child];
+      for (Index i = 0; i < this->nodes [0].numElements; i++) {
+        this->elementNode [this->elements [this->nodes [0].elementsBegin + i]] = 0;
+      }
+      this->nodes [child].firstChild       = none;
+      this->nodes [child].numElements      = 0;
+      this->nodes [child].elementsCapacity = 0;
+      this->freeBlock (block);
+    }
+  }
+
+  void resetNodes () {
+    this->nodes     .clear ();
+    this->freeBlocks.clear ();
+    this->elements  .clear ();
+    this->numGarbageElements = 0;
+  }
+
+  void reset () {
+    this->resetNodes ();
+    this->degeneratedElements.clear ();
+    this->elementNode        .clear ();
+    this->elementSlot        .clear ();
+    this->rootWasSetUp = false;
+  }
+
+#ifdef DILAY_RENDER_OCTREE
+  void render (Camera& camera) {
+    if (this->hasRoot ()) {
+      std::vector <Index> stack = { 0 };
+
+      while (stack.empty () == false) {
+        const Node& node = this->nodes [stack.back ()];
+        stack.pop_back ();
+
+        this->nodeMesh.position    (node.center);
+        this->nodeMesh.scaling     (glm::vec3 (node.width * 0.5f));
+        this->nodeMesh.renderLines (camera);
+
+        if (node.hasChildren ()) {
+          for (unsigned int i = 0; i < 8; i++) {
+            stack.push_back (node.firstChild + i);
+          }
+        }
+      }
+    }
+  }
+#else
+  void render (Camera&) const {
+    DILAY_IMPOSSIBLE
+  }
+#endif
+
+  /* Nodes are visited in pre-order: children are pushed in reverse order onto an
+   * explicit stack. The stack lives on the call stack unless the octree is too deep
+   * (a query needs up to 7 entries per level), in which case it moves to the heap.
+   */
+  template <typename T, typename F>
+  void intersectsT (const T& t, const F& f) const {
+    if (this->hasRoot ()) {
+      Index               localStack [localStackSize];
+      std::vector <Index> heapStack;
+      Index*              stack         = localStack;
+      int                 stackCapacity = localStackSize;
+      int                 stackSize     = 0;
+
+      stack [stackSize++] = 0;
+      while (stackSize > 0) {
+        const Node& node = this->nodes [stack [--stackSize]];
+
+        if (IntersectionUtil::intersects (t, node.looseAABox ())) {
+          for (Index i = 0; i < node.numElements; i++) {
+            f (this->elements [node.elementsBegin + i]);
+          }
+          if (node.hasChildren ()) {
+            if (stackSize + 8 > stackCapacity) {
+              if (heapStack.empty ()) {
+                heapStack.assign (localStack, localStack + stackSize);
+              }
+              heapStack.resize (2 * stackCapacity);
+              stack         = heapStack.data ();
+              stackCapacity = int (heapStack.size ());
+            }
+            for (int i = 7; i >= 0; i--) {
+              stack [stackSize++] = node.firstChild + Index (i);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void intersects (const PrimRay& ray, const FlatIndexOctree::IntersectionCallback& f) const {
+    this->intersectsT <PrimRay> (ray, f);
+  }
+
+  void intersects (const PrimSphere& sphere, const FlatIndexOctree::IntersectionCallback& f) const {
+    this->intersectsT <PrimSphere> (sphere, f);
+  }
+
+  void intersects (const PrimRay& ray, FlatIndexOctree::Candidates& candidates) const {
+    this->intersectsT (ray, [&candidates] (unsigned int i) { candidates.push_back (i); });
+  }
+
+  void intersects (const PrimSphere& sphere, FlatIndexOctree::Candidates& candidates) const {
+    this->intersectsT (sphere, [&candidates] (unsigned int i) { candidates.push_back (i); });
+  }
+
+  unsigned int numDegeneratedElements () const {
+    return this->degeneratedElements.size ();
+  }
+
+  unsigned int someDegeneratedElement () const {
+    assert (this->numDegeneratedElements () > 0);
+    return this->degeneratedElements.front ();
+  }
+
+  void rewriteIndices (const std::vector <unsigned int>& map) {
+    std::vector <Index> newElementNode (map.size (), none);
+    std::vector <Index> newElementSlot (map.size (), none);
+
+    auto rewrite = [this, &map, &newElementNode, &newElementSlot] (Index& i) {
+      assert (map.size () > i);
+      assert (map [i] != Util::invalidIndex ());
+
+      const Index newIndex = map [i];
+      if (newIndex >= newElementNode.size ()) {
+        newElementNode.resize (newIndex + 1, none);
+        newElementSlot.resize (newIndex + 1, none);
+      }
+      newElementNode [newIndex] = this->elementNode [i];
+      newElementSlot [newIndex] = this->elementSlot [i];
+      i = newIndex;
+    };
+
+    for (const Node& node : this->nodes) {
+      for (Index i = 0; i < node.numElements; i++) {
+        rewrite (this->elements [node.elementsBegin + i]);
+      }
+    }
+    for (Index& i : this->degeneratedElements) {
+      rewrite (i);
+    }
+    this->elementNode.swap (newElementNode);
+    this->elementSlot.swap (newElementSlot);
+  }
+
+  void printStatistics () const {
+    FlatIndexOctreeStatistics stats { 0, 0
+                                    , std::numeric_limits <int>::max ()
+                                    , std::numeric_limits <int>::min ()
+                                    , 0
+                                    , FlatIndexOctreeStatistics::DepthMap ()
+                                    , FlatIndexOctreeStatistics::DepthMap () };
+    if (this->hasRoot ()) {
+      std::vector <Index> stack = { 0 };
+
+      while (stack.empty () == false) {
+        const Node& node = this->nodes [stack.back ()];
+        stack.pop_back ();
+
+        stats.numNodes          += 1;
+        stats.numElements       += node.numElements;
+        stats.minDepth           = glm::min (stats.minDepth, node.depth);
+        stats.maxDepth           = glm::max (stats.maxDepth, node.depth);
+        stats.maxElementsPerNode = glm::max (stats.maxElementsPerNode, node.numElements);
+
+        stats.numElementsPerDepth [node.depth] += node.numElements;
+        stats.numNodesPerDepth    [node.depth] += 1;
+
+        if (node.hasChildren ()) {
+          for (unsigned int i = 0; i < 8; i++) {
+            stack.push_back (node.firstChild + i);
+          }
+        }
+      }
+    }
+    std::cout << "octree:"
+              << "\n\tnum nodes:\t\t\t"            << stats.numNodes
+              << "\n\tnum pooled nodes:\t\t"       << this->nodes.size ()
+              << "\n\tnum elements:\t\t\t"         << stats.numElements
+              << "\n\tnum degenerated elements:\t" << this->numDegeneratedElements ()
+              << "\n\tnum garbage elements:\t\t"   << this->numGarbageElements
+              << "\n\tmax elements per node:\t\t"  << stats.maxElementsPerNode
+              << "\n\tmin depth:\t\t\t"            << stats.minDepth
+              << "\n\tmax depth:\t\t\t"            << stats.maxDepth
+              << "\n\telements per node:\t\t"      << float (stats.numElements)
+                                                    / float (stats.numNodes)
+              << std::endl;
+  }
+
+  std::size_t numBytes () const {
+    return sizeof (Impl)
+         + (this->nodes              .capacity () * sizeof (Node))
+         + (this->freeBlocks         .capacity () * sizeof (Index))
+         + (this->elements           .capacity () * sizeof (Index))
+         + (this->degeneratedElements.capacity () * sizeof (Index))
+         + (this->elementNode        .capacity () * sizeof (Index))
+         + (this->elementSlot        .capacity () * sizeof (Index));
+  }
+};
+
+DELEGATE_BIG4COPY (FlatIndexOctree)
+
+DELEGATE_CONST  (bool        , FlatIndexOctree, hasRoot)
+DELEGATE2       (void        , FlatIndexOctree, setupRoot, const glm::vec3&, float)
+DELEGATE3       (void        , FlatIndexOctree, addElement, unsigned int, const glm::vec3&, float)
+DELEGATE1       (void        , FlatIndexOctree, addDegeneratedElement, unsigned int)
+DELEGATE1       (void        , FlatIndexOctree, deleteElement, unsigned int)
+DELEGATE        (void        , FlatIndexOctree, deleteEmptyChildren)
+DELEGATE        (void        , FlatIndexOctree, shrinkRoot)
+DELEGATE        (void        , FlatIndexOctree, reset)
+DELEGATE1       (void        , FlatIndexOctree, render, Camera&)
+DELEGATE2_CONST (void        , FlatIndexOctree, intersects, const PrimRay&, const FlatIndexOctree::IntersectionCallback&)
+DELEGATE2_CONST (void        , FlatIndexOctree, intersects, const PrimSphere&, const FlatIndexOctree::IntersectionCallback&)
+DELEGATE2_CONST (void        , FlatIndexOctree, intersects, const PrimRay&, FlatIndexOctree::Candidates&)
+DELEGATE2_CONST (void        , FlatIndexOctree, intersects, const PrimSphere&, FlatIndexOctree::Candidates&)
+DELEGATE_CONST  (unsigned int, FlatIndexOctree, numDegeneratedElements)
+DELEGATE_CONST  (unsigned int, FlatIndexOctree, someDegeneratedElement)
+DELEGATE1       (void        , FlatIndexOctree, rewriteIndices, const std::vector <unsigned int>&)
+DELEGATE_CONST  (void        , FlatIndexOctree, printStatistics)
+DELEGATE_CONST  (std::size_t , FlatIndexOctree, numBytes)
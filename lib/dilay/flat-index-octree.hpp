@@ -2,9 +2,10 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
-#ifndef DILAY_INDEX_OCTREE
-#define DILAY_INDEX_OCTREE
+#ifndef DILAY_FLAT_INDEX_OCTREE
+#define DILAY_FLAT_INDEX_OCTREE
 
+#include <cstddef>
 #include <functional>
 #include <glm/fwd.hpp>
 #include <vector>
@@ -14,11 +15,23 @@ class Camera;
 class PrimRay;
 class PrimSphere;
 
-class IndexOctree { 
-  public: 
-    DECLARE_BIG4COPY (IndexOctree)
+/* `FlatIndexOctree` is a loose octree of element indices, which is used to find
+ * candidates for ray and sphere intersections. It stores its nodes in a contiguous
+ * pool, where the eight children of a node are consecutive and referenced by a
+ * 32-bit offset.
+ * The elements of all nodes are stored in a single shared array.
+ * Copying does not need to rebuild any pointers, and queries traverse the tree
+ * without recursion.
+ * Besides the callback-based queries, candidates can be appended to a caller-provided
+ * buffer, which avoids an indirect call per candidate in the innermost loop of picking
+ * and sculpting.
+ */
+class FlatIndexOctree {
+  public:
+    DECLARE_BIG4COPY (FlatIndexOctree)
 
     typedef std::function <void (unsigned int)> IntersectionCallback;
+    typedef std::vector <unsigned int>          Candidates;
 
     bool             hasRoot                () const;
     void             setupRoot              (const glm::vec3&, float);
@@ -31,10 +44,23 @@ class IndexOctree {
     void             render                 (Camera&);
     void             intersects             (const PrimRay&, const IntersectionCallback&) const;
     void             intersects             (const PrimSphere&, const IntersectionCallback&) const;
+    void             intersects             (const PrimRay&, Candidates&) const;
+    void             intersects             (const PrimSphere&, Candidates&) const;
     unsigned int     numDegeneratedElements () const;
     unsigned int     someDegeneratedElement () const;
     void             rewriteIndices         (const std::vector <unsigned int>&);
     void             printStatistics        () const;
+    std::size_t      numBytes               () const;
+
+    template <typename T, typename F>
+    void forEachCandidate (const T& t, Candidates& candidates, const F& f) const {
+      candidates.clear ();
+      this->intersects (t, candidates);
+
+      for (unsigned int i : candidates) {
+        f (i);
+      }
+    }
 
   private:
     IMPLEMENTATION
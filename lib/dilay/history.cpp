@@ -2,20 +2,34 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <list>
 #include <vector>
+#include "compressed-mesh.hpp"
 #include "config.hpp"
+#include "flat-index-octree.hpp"
 #include "history.hpp"
-#include "index-octree.hpp"
 #include "maybe.hpp"
 #include "mesh.hpp"
+#include "primitive/triangle.hpp"
 #include "scene.hpp"
 #include "sketch/mesh.hpp"
 #include "sketch/path.hpp"
 #include "state.hpp"
+#include "task-pool.hpp"
+#include "util.hpp"
+#include "winged/delta.hpp"
 #include "winged/mesh.hpp"
 
 namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  float milliseconds (const Clock::time_point& from, const Clock::time_point& to) {
+    return std::chrono::duration <float, std::milli> (to - from).count ();
+  }
+
   struct SnapshotConfig {
     bool snapshotWingedMeshes;
     bool copyOctree;
@@ -36,49 +50,216 @@ namespace {
     }
   };
 
+  /* Winged meshes are stored including their free indices, i.e. restoring a snapshot
+   * preserves all vertex and face indices, which keeps deltas valid (see `WingedMeshDelta`).
+   * Taking a snapshot does not copy any geometry: `mesh` shares its chunks with the
+   * winged mesh, which copies a chunk once it modifies it (see `CopyOnWriteArray`).
+   * Snapshots are processed on the global task pool after they have been taken:
+   * the most recent snapshot rebuilds its octree from `mesh`, all other snapshots
+   * replace `mesh` by a `CompressedMesh`.
+   * Neither `mesh`, `compressedMesh` nor `octree` must be accessed before `pending` is ready.
+   */
   struct WingedMeshSnapshot {
-    Mesh                mesh;
-    Maybe <IndexOctree> octree;
+    Mesh                       mesh;
+    Maybe <CompressedMesh>     compressedMesh;
+    std::vector <unsigned int> freeVertices;
+    std::vector <unsigned int> freeFaces;
+    bool                       hasOctree;
+    Maybe <FlatIndexOctree>    octree;
+    std::size_t                uncompressedNumBytes;
+    Clock::time_point          finished;
+    std::future <void>         pending;
+
+    WingedMeshSnapshot (const WingedMesh& m)
+      : mesh                 (m.mesh ())
+      , freeVertices         (m.freeVertexIndices ())
+      , freeFaces            (m.freeFaceIndices ())
+      , hasOctree            (false)
+      , uncompressedNumBytes ( sizeof (WingedMeshSnapshot)
+                             + (this->mesh.numVertices () * 2 * sizeof (glm::vec3))
+                             + (this->mesh.numIndices  () * sizeof (unsigned int))
+                             + (this->freeVertices.size () * sizeof (unsigned int))
+                             + (this->freeFaces   .size () * sizeof (unsigned int)) )
+    {}
+
+    // Futures of the task pool do not block on destruction
+    ~WingedMeshSnapshot () {
+      this->wait ();
+    }
+
+    void buildOctreeAsync () {
+      assert (this->hasOctree == false);
+      assert (this->pending.valid () == false);
+
+      this->hasOctree = true;
+      this->pending   = TaskPool::global ().async ([this] () {
+        this->octree   = Maybe <FlatIndexOctree>::make (buildOctree (this->mesh, this->freeFaces));
+        this->finished = Clock::now ();
+      });
+    }
+
+    void compressAsync () {
+      assert (this->hasOctree == false);
+      assert (this->compressedMesh == false);
+
+      this->wait ();
+      this->pending = TaskPool::global ().async ([this] () {
+        this->compressedMesh = Maybe <CompressedMesh>::make (this->mesh);
+        this->mesh           = Mesh ();
+        this->finished       = Clock::now ();
+      });
+    }
+
+    bool isReady () const {
+      return this->pending.valid () == false
+          || this->pending.wait_for (std::chrono::seconds (0)) == std::future_status::ready;
+    }
+
+    void wait () const {
+      if (this->pending.valid ()) {
+        this->pending.wait ();
+      }
+    }
+
+    void deleteOctree () {
+      if (this->hasOctree) {
+        this->wait ();
+        this->octree.reset ();
+        this->hasOctree = false;
+        this->compressAsync ();
+      }
+    }
+
+    void restore (State& state) const {
+      this->wait ();
+
+      if (this->compressedMesh) {
+        state.scene ().newWingedMesh ( state.config (), this->compressedMesh->mesh ()
+                                     , this->freeVertices, this->freeFaces );
+      }
+      else {
+        state.scene ().newWingedMesh ( state.config (), this->mesh
+                                     , this->freeVertices, this->freeFaces );
+      }
+    }
+
+    static FlatIndexOctree buildOctree (const Mesh& mesh, const std::vector <unsigned int>& freeFaces) {
+      std::vector <bool> isFreeFace (mesh.numIndices () / 3, false);
+      for (unsigned int i : freeFaces) {
+        isFreeFace [i] = true;
+      }
+
+      glm::vec3 minVertex, maxVertex;
+      mesh.minMax (minVertex, maxVertex);
+
+      const glm::vec3 delta = maxVertex - minVertex;
+
+      FlatIndexOctree octree;
+      octree.setupRoot ( (maxVertex + minVertex) * glm::vec3 (0.5f)
+                       , glm::max (glm::max (delta.x, delta.y), delta.z) );
+
+      for (unsigned int i = 0; i < isFreeFace.size (); i++) {
+        if (isFreeFace [i] == false) {
+          const PrimTriangle tri ( mesh.vertex (mesh.index ((3 * i) + 0))
+                                 , mesh.vertex (mesh.index ((3 * i) + 1))
+                                 , mesh.vertex (mesh.index ((3 * i) + 2)) );
+          if (tri.isDegenerated ()) {
+            octree.addDegeneratedElement (i);
+          }
+          else {
+            octree.addElement (i, tri.center (), tri.maxDimExtent ());
+          }
+        }
+      }
+      return octree;
+    }
+
+    /* The uncompressed size is assumed while the snapshot is being processed.
+     * A built octree is counted as well.
+     */
+    std::size_t numBytes () const {
+      if (this->isReady () == false) {
+        return this->uncompressedNumBytes;
+      }
+      else if (this->compressedMesh) {
+        return sizeof (WingedMeshSnapshot)
+             + this->compressedMesh->numBytes ()
+             + (this->freeVertices.size () * sizeof (unsigned int))
+             + (this->freeFaces   .size () * sizeof (unsigned int));
+      }
+      else if (this->octree) {
+        return this->uncompressedNumBytes + this->octree->numBytes ();
+      }
+      else {
+        return this->uncompressedNumBytes;
+      }
+    }
   };
 
   struct SketchMeshSnapshot {
     SketchTree  tree;
     SketchPaths paths;
+
+    std::size_t numBytes () const {
+      std::size_t n = sizeof (SketchMeshSnapshot);
+
+      if (this->tree.hasRoot ()) {
+        n += this->tree.root ().numNodes () * sizeof (SketchNode);
+      }
+      for (const SketchPath& p : this->paths) {
+        n += sizeof (SketchPath) + (p.spheres ().size () * sizeof (PrimSphere));
+      }
+      return n;
+    }
   };
 
+  /* A scene snapshot either stores full copies of meshes or, if `isDelta` holds,
+   * a delta for each winged mesh of the scene (in order of `Scene::forEachMesh`).
+   */
   struct SceneSnapshot {
     const SnapshotConfig           config;
+    const bool                     isDelta;
     std::list <WingedMeshSnapshot> wingedMeshes;
     std::list <SketchMeshSnapshot> sketchMeshes;
+    std::vector <WingedMeshDelta>  wingedMeshDeltas;
+    unsigned int                   id;
+
+    SceneSnapshot (const SnapshotConfig& c, bool d = false) 
+      : config  (c)
+      , isDelta (d)
+      , id      (0)
+    {}
+
+    std::size_t numBytes () const {
+      std::size_t n = sizeof (SceneSnapshot);
 
-    SceneSnapshot (const SnapshotConfig& c) : config (c) {}
+      for (const WingedMeshSnapshot& s : this->wingedMeshes) {
+        n += s.numBytes ();
+      }
+      for (const SketchMeshSnapshot& s : this->sketchMeshes) {
+        n += s.numBytes ();
+      }
+      for (const WingedMeshDelta& d : this->wingedMeshDeltas) {
+        n += d.numBytes ();
+      }
+      return n;
+    }
   };
 
   typedef std::list <SceneSnapshot> Timeline;
 
+  /* The returned snapshot must be processed by `processAsync`.
+   */
   SceneSnapshot sceneSnapshot (const Scene& scene, const SnapshotConfig& config) {
     SceneSnapshot snapshot (config);
 
     if (config.snapshotWingedMeshes) {
-      scene.forEachConstMesh ([&config, &snapshot] (const WingedMesh& mesh) {
-        if (config.copyOctree) {
-          std::vector <unsigned int> newFaceIndices;
-
-          WingedMeshSnapshot meshSnapshot = { mesh.makePrunedMesh (&newFaceIndices)
-                                            , mesh.octree () };
-
-          if (newFaceIndices.empty () == false) {
-            meshSnapshot.octree->rewriteIndices (newFaceIndices);
-          }
-          snapshot.wingedMeshes.push_back (std::move (meshSnapshot));
-        }
-        else {
-          snapshot.wingedMeshes.push_back ({ mesh.makePrunedMesh (), Maybe <IndexOctree> () });
-        }
+      scene.forEachConstMesh ([&snapshot] (const WingedMesh& mesh) {
+        snapshot.wingedMeshes.emplace_back (mesh);
       });
     }
     if (config.snapshotSketchMeshes) {
-      scene.forEachConstMesh ([&config, &snapshot] (const SketchMesh& mesh) {
+      scene.forEachConstMesh ([&snapshot] (const SketchMesh& mesh) {
         snapshot.sketchMeshes.push_back ({ mesh.tree (), mesh.paths () });
       });
     }
@@ -91,8 +272,8 @@ namespace {
     if (snapshot.config.snapshotWingedMeshes) {
       scene.deleteWingedMeshes ();
 
-      for (const WingedMeshSnapshot& meshSnapshot : snapshot.wingedMeshes) {
-        scene.newWingedMesh (state.config (), meshSnapshot.mesh);
+      for (const WingedMeshSnapshot& s : snapshot.wingedMeshes) {
+        s.restore (state);
       }
     }
     if (snapshot.config.snapshotSketchMeshes) {
@@ -107,88 +288,231 @@ namespace {
     }
   }
 
+  unsigned int numWingedMeshes (const Scene& scene) {
+    unsigned int n = 0;
+    scene.forEachConstMesh ([&n] (const WingedMesh&) { n++; });
+    return n;
+  }
+
+  /* `applyDeltas (s,scene)` applies all deltas of `s` and returns a snapshot
+   * of the inverse deltas.
+   */
+  SceneSnapshot applyDeltas (const SceneSnapshot& snapshot, Scene& scene) {
+    assert (snapshot.isDelta);
+    assert (snapshot.wingedMeshDeltas.size () == numWingedMeshes (scene));
+
+    SceneSnapshot inverse (snapshot.config, true);
+    unsigned int  i = 0;
+
+    inverse.wingedMeshDeltas.reserve (snapshot.wingedMeshDeltas.size ());
+
+    scene.forEachMesh ([&snapshot, &inverse, &i] (WingedMesh& mesh) {
+      inverse.wingedMeshDeltas.push_back (mesh.applyDelta (snapshot.wingedMeshDeltas.at (i++)));
+    });
+    return inverse;
+  }
+
+  /* Must be called once `sceneSnapshot` has reached its final address,
+   * since snapshots are processed in place.
+   */
+  void processAsync (SceneSnapshot& sceneSnapshot) {
+    for (WingedMeshSnapshot& meshSnapshot : sceneSnapshot.wingedMeshes) {
+      if (sceneSnapshot.config.copyOctree) {
+        meshSnapshot.buildOctreeAsync ();
+      }
+      else {
+        meshSnapshot.compressAsync ();
+      }
+    }
+  }
+
   void deleteOctreeSnapshot (SceneSnapshot& sceneSnapshot) {
     for (WingedMeshSnapshot& meshSnapshot : sceneSnapshot.wingedMeshes) {
-      meshSnapshot.octree.reset ();
+      meshSnapshot.deleteOctree ();
     }
   }
 }
 
 struct History::Impl {
-  unsigned int undoDepth;
+  std::size_t  memoryBudget;
   Timeline     past;
   Timeline     future;
-
-  Impl (const Config& config) {
+  bool         isRecording;
+  bool         keepRecording;
+  unsigned int numRecordedMeshes;
+
+  unsigned int      latestId;
+  Clock::time_point latestStarted;
+  Clock::time_point latestFinished;
+
+  Impl (const Config& config) 
+    : isRecording       (false)
+    , keepRecording     (false)
+    , numRecordedMeshes (0)
+    , latestId          (0)
+  {
     this->runFromConfig (config);
   }
 
-  void snapshotAll (const Scene& scene) {
+  void snapshotAll (Scene& scene) {
     this->snapshot (scene, SnapshotConfig (true, true, true));
   }
 
-  void snapshotWingedMeshes (const Scene& scene) {
+  void snapshotWingedMeshes (Scene& scene) {
     this->snapshot (scene, SnapshotConfig (true, true, false));
   }
 
-  void snapshotSketchMeshes (const Scene& scene) {
+  void snapshotSketchMeshes (Scene& scene) {
     this->snapshot (scene, SnapshotConfig (false, false, true));
   }
 
-  void snapshot (const Scene& scene, const SnapshotConfig& config) {
-    assert (undoDepth > 0);
+  void snapshot (Scene& scene, const SnapshotConfig& config) {
+    this->latestStarted = Clock::now ();
+
+    this->stopRecording (scene);
+    this->pushFront     (sceneSnapshot (scene, config));
+    processAsync        (this->past.front ());
+
+    this->latestFinished = Clock::now ();
+  }
+
+  void recordWingedMeshes (Scene& scene) {
+    this->latestStarted = Clock::now ();
+
+    this->stopRecording (scene);
+    this->pushFront     (SceneSnapshot (SnapshotConfig (false, false, false), true));
 
+    scene.forEachMesh ([] (WingedMesh& mesh) {
+      mesh.startRecording ();
+    });
+    this->isRecording       = true;
+    this->keepRecording     = true;
+    this->numRecordedMeshes = numWingedMeshes (scene);
+
+    this->latestFinished = Clock::now ();
+  }
+
+  void pushFront (SceneSnapshot&& snapshot) {
     this->future.clear ();
 
-    while (this->past.size () >= this->undoDepth) {
-      this->past.pop_back ();
-    }
     if (this->past.empty () == false) {
       deleteOctreeSnapshot (this->past.front ());
     }
-    this->past.push_front (std::move (sceneSnapshot (scene, config)));
+    snapshot.id = ++this->latestId;
+
+    this->past.push_front (std::move (snapshot));
+    this->applyMemoryBudget ();
+  }
+
+  void stopRecording (Scene& scene) {
+    if (this->isRecording) {
+      std::vector <WingedMeshDelta> deltas;
+
+      scene.forEachMesh ([&deltas] (WingedMesh& mesh) {
+        if (mesh.isRecording ()) {
+          deltas.push_back (mesh.stopRecording ());
+        }
+      });
+      this->isRecording = false;
+
+      if (this->keepRecording) {
+        assert (this->past.empty () == false);
+        assert (this->past.front ().isDelta);
+
+        if (deltas.size () == this->numRecordedMeshes) {
+          this->past.front ().wingedMeshDeltas = std::move (deltas);
+          this->applyMemoryBudget ();
+        }
+        else {
+          DILAY_WARN ("number of meshes changed while recording: dropping history");
+          this->past  .clear ();
+          this->future.clear ();
+        }
+      }
+    }
+  }
+
+  void applyMemoryBudget () {
+    std::size_t numBytes = 0;
+
+    for (const SceneSnapshot& s : this->past) {
+      numBytes += s.numBytes ();
+    }
+    for (const SceneSnapshot& s : this->future) {
+      numBytes += s.numBytes ();
+    }
+    // the oldest redo steps are dropped after the oldest undo steps
+    while (numBytes > this->memoryBudget && this->past.size () > 1) {
+      numBytes -= this->past.back ().numBytes ();
+      this->past.pop_back ();
+    }
+    while (numBytes > this->memoryBudget && this->future.empty () == false) {
+      numBytes -= this->future.back ().numBytes ();
+      this->future.pop_back ();
+    }
   }
 
   void dropSnapshot () {
     if (this->past.empty () == false) {
       this->past.pop_front ();
+      this->keepRecording = false;
     }
   }
 
   void undo (State& state) {
-    if (this->past.empty () == false) {
-      SnapshotConfig config = this->past.front ().config.withoutOctrees ();
+    this->stopRecording (state.scene ());
 
-      this->future.push_front (std::move (sceneSnapshot (state.scene (), config)));
-      resetToSnapshot (this->past.front (), state);
+    if (this->past.empty () == false) {
+      this->future.push_front (this->restore (this->past.front (), state));
       this->past.pop_front ();
+      processAsync (this->future.front ());
+      this->applyMemoryBudget ();
     }
   }
 
   void redo (State& state) {
+    this->stopRecording (state.scene ());
+
     if (this->future.empty () == false) {
       if (this->past.empty () == false) {
         deleteOctreeSnapshot (this->past.front ());
       }
-      SnapshotConfig config = this->future.front ().config.withoutOctrees ();
-
-      this->past.push_front (std::move (sceneSnapshot (state.scene (), config)));
-      resetToSnapshot (this->future.front (), state);
+      this->past.push_front (this->restore (this->future.front (), state));
       this->future.pop_front ();
+      processAsync (this->past.front ());
+      this->applyMemoryBudget ();
+    }
+  }
+
+  /* `restore (s,state)` resets the scene of `state` to `s` and returns a snapshot
+   * of the replaced state.
+   */
+  SceneSnapshot restore (const SceneSnapshot& snapshot, State& state) {
+    if (snapshot.isDelta) {
+      return applyDeltas (snapshot, state.scene ());
+    }
+    else {
+      SceneSnapshot current = sceneSnapshot ( state.scene ()
+                                            , snapshot.config.withoutOctrees () );
+      resetToSnapshot (snapshot, state);
+      return current;
     }
   }
 
   bool hasRecentOctrees () const {
     return this->past.empty () == false 
+      && this->past.front ().isDelta == false
       && this->past.front ().config.snapshotWingedMeshes
-      && bool (this->past.front ().wingedMeshes.front ().octree);
+      && this->past.front ().wingedMeshes.empty () == false
+      && this->past.front ().wingedMeshes.front ().hasOctree;
   }
 
   void forEachRecentOctree (const std::function <void ( const Mesh& m
-                                                      , const IndexOctree& )>& f) const
+                                                      , const FlatIndexOctree& )>& f) const
   {
     assert (this->hasRecentOctrees ());
     for (const WingedMeshSnapshot& s : this->past.front ().wingedMeshes) {
+      s.wait ();
       assert (s.octree);
       f (s.mesh, *s.octree);
     }
@@ -197,21 +521,42 @@ struct History::Impl {
   void reset () {
     this->past  .clear ();
     this->future.clear ();
+    this->keepRecording = false;
+  }
+
+  float blockingLatency () const {
+    return milliseconds (this->latestStarted, this->latestFinished);
+  }
+
+  float totalLatency () const {
+    Clock::time_point finished = this->latestFinished;
+
+    if (this->past.empty () == false && this->past.front ().id == this->latestId) {
+      for (const WingedMeshSnapshot& s : this->past.front ().wingedMeshes) {
+        s.wait ();
+        finished = std::max (finished, s.finished);
+      }
+    }
+    return milliseconds (this->latestStarted, finished);
   }
 
   void runFromConfig (const Config& config) {
-    this->undoDepth = config.get <int> ("editor/undoDepth");
+    this->memoryBudget = std::size_t (config.get <int> ("editor/undoMemory")) * 1024 * 1024;
+    this->applyMemoryBudget ();
   }
 };
 
 DELEGATE1_BIG3  (History, const Config&)
-DELEGATE1       (void, History, snapshotAll, const Scene&)
-DELEGATE1       (void, History, snapshotWingedMeshes, const Scene&)
-DELEGATE1       (void, History, snapshotSketchMeshes, const Scene&)
+DELEGATE1       (void, History, snapshotAll, Scene&)
+DELEGATE1       (void, History, snapshotWingedMeshes, Scene&)
+DELEGATE1       (void, History, snapshotSketchMeshes, Scene&)
+DELEGATE1       (void, History, recordWingedMeshes, Scene&)
 DELEGATE        (void, History, dropSnapshot)
 DELEGATE1       (void, History, undo, State&)
 DELEGATE1       (void, History, redo, State&)
 DELEGATE1       (void, History, runFromConfig, const Config&)
 DELEGATE_CONST  (bool, History, hasRecentOctrees)
 DELEGATE        (void, History, reset)
-DELEGATE1_CONST (void, History, forEachRecentOctree, const std::function <void (const Mesh&, const IndexOctree&)>&)
+DELEGATE1_CONST (void, History, forEachRecentOctree, const std::function <void (const Mesh&, const FlatIndexOctree&)>&)
+DELEGATE_CONST  (float, History, blockingLatency)
+DELEGATE_CONST  (float, History, totalLatency)
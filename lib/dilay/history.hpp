@@ -11,7 +11,7 @@
 #include "configurable.hpp"
 #include "macro.hpp"
 
-class IndexOctree;
+class FlatIndexOctree;
 class Mesh;
 class Scene;
 class State;
@@ -20,16 +20,24 @@ class DILAY_LIB_EXPORT History : public Configurable {
   public: 
     DECLARE_BIG3 (History, const Config&)
 
-    void snapshotAll          (const Scene&);
-    void snapshotWingedMeshes (const Scene&);
-    void snapshotSketchMeshes (const Scene&);
+    void snapshotAll          (Scene&);
+    void snapshotWingedMeshes (Scene&);
+    void snapshotSketchMeshes (Scene&);
+    void recordWingedMeshes   (Scene&);
     void dropSnapshot         ();
     void undo                 (State&);
     void redo                 (State&);
     bool hasRecentOctrees     () const;
-    void forEachRecentOctree  (const std::function <void (const Mesh&, const IndexOctree&)>&) const;
+    void forEachRecentOctree  (const std::function <void (const Mesh&, const FlatIndexOctree&)>&) const;
     void reset                ();
 
+    /** Latencies of the most recent snapshot in milliseconds.
+     * `blockingLatency` is the time spent on the calling thread,
+     * `totalLatency` includes work that finishes in the background and waits for it.
+     */
+    float blockingLatency     () const;
+    float totalLatency        () const;
+
   private:
     IMPLEMENTATION
 
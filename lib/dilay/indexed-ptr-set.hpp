@@ -0,0 +1,255 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_INDEXED_PTR_SET
+#define DILAY_INDEXED_PTR_SET
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/* `IndexedPtrSet <T>` is a set of pointers to elements with dense indices, i.e. `T`
+ * must provide `unsigned int index () const`.
+ * Members are stored in insertion order in a compact vector, an additional array that
+ * is addressed by element indices marks members with the current generation of the set.
+ * Thus, insertion, deletion and membership tests take constant time, and clearing a
+ * set only increments its generation.
+ * Both arrays are taken from a thread-local pool and returned when the set is destroyed,
+ * such that short-lived sets do not allocate once the pool has been warmed up.
+ */
+template <typename T>
+class IndexedPtrSet {
+    struct Mark {
+      unsigned int generation;
+      unsigned int slot;
+    };
+
+    struct Storage {
+      unsigned int        generation;
+      std::vector <Mark>  marks;
+      std::vector <T*>    members;
+
+      Storage () : generation (0) {}
+
+      void clear () {
+        this->members.clear ();
+
+        if (this->generation == std::numeric_limits <unsigned int>::max ()) {
+          this->marks.assign (this->marks.size (), Mark {0, 0});
+          this->generation = 0;
+        }
+        this->generation++;
+      }
+    };
+
+    /* Each thread has its own pool, i.e. sets do not synchronize. A set that is
+     * destroyed by another thread than the one that created it, returns its storage to
+     * the pool of the destroying thread.
+     * A pool keeps at most `maxPooledStorages` storages and shrinks storages that
+     * exceed `maxPooledMarks` marks or `maxPooledMembers` members when they are released.
+     */
+    class Pool {
+      public:
+        static constexpr unsigned int maxPooledStorages = 8;
+        static constexpr unsigned int maxPooledMarks    = 1 << 19;
+        static constexpr unsigned int maxPooledMembers  = 1 << 16;
+
+        std::unique_ptr <Storage> acquire () {
+          if (this->storages.empty ()) {
+            std::unique_ptr <Storage> storage (new Storage);
+            storage->clear ();
+            return storage;
+          }
+          else {
+            std::unique_ptr <Storage> storage = std::move (this->storages.back ());
+            this->storages.pop_back ();
+            return storage;
+          }
+        }
+
+        void release (std::unique_ptr <Storage>&& storage) {
+          if (this->storages.size () < maxPooledStorages) {
+            storage->clear ();
+
+            if (storage->marks.size () > maxPooledMarks) {
+              storage->marks.resize (maxPooledMarks);
+              storage->marks.shrink_to_fit ();
+            }
+            if (storage->members.capacity () > maxPooledMembers) {
+              std::vector <T*> ().swap (storage->members);
+            }
+            this->storages.push_back (std::move (storage));
+          }
+        }
+
+        std::size_t numStorages () const {
+          return this->storages.size ();
+        }
+
+        std::size_t numBytes () const {
+          std::size_t n = 0;
+          for (const std::unique_ptr <Storage>& s : this->storages) {
+            n += (s->marks.capacity () * sizeof (Mark)) + (s->members.capacity () * sizeof (T*));
+          }
+          return n;
+        }
+
+      private:
+        std::vector <std::unique_ptr <Storage>> storages;
+    };
+
+    static Pool& pool () {
+      static thread_local Pool p;
+      return p;
+    }
+
+  public:
+    typedef typename std::vector <T*>::const_iterator const_iterator;
+
+    IndexedPtrSet () {}
+
+    IndexedPtrSet (const IndexedPtrSet& other) {
+      for (T* t : other) {
+        this->insert (t);
+      }
+    }
+
+    IndexedPtrSet (IndexedPtrSet&& other) : storage (std::move (other.storage)) {}
+
+    const IndexedPtrSet& operator= (const IndexedPtrSet& other) {
+      if (this != &other) {
+        this->clear ();
+        for (T* t : other) {
+          this->insert (t);
+        }
+      }
+      return *this;
+    }
+
+    const IndexedPtrSet& operator= (IndexedPtrSet&& other) {
+      if (this != &other) {
+        this->release ();
+        this->storage = std::move (other.storage);
+      }
+      return *this;
+    }
+
+    ~IndexedPtrSet () {
+      this->release ();
+    }
+
+    /** Number of storages in the pool of the calling thread */
+    static std::size_t numPooledStorages () {
+      return pool ().numStorages ();
+    }
+
+    /** Number of bytes held by the pool of the calling thread */
+    static std::size_t numPooledBytes () {
+      return pool ().numBytes ();
+    }
+
+    bool insert (T* t) {
+      assert (t);
+
+      if (this->storage == nullptr) {
+        this->storage = pool ().acquire ();
+      }
+      const unsigned int index = t->index ();
+
+      if (index >= this->storage->marks.size ()) {
+        this->storage->marks.resize (index + 1, Mark {0, 0});
+      }
+      Mark& mark = this->storage->marks[index];
+
+      if (mark.generation == this->storage->generation) {
+        return false;
+      }
+      else {
+        mark.generation = this->storage->generation;
+        mark.slot       = this->storage->members.size ();
+        this->storage->members.push_back (t);
+        return true;
+      }
+    }
+
+    unsigned int erase (T* t) {
+      if (this->count (t) == 0) {
+        return 0;
+      }
+      std::vector <T*>& members = this->storage->members;
+      Mark&             mark    = this->storage->marks[t->index ()];
+
+      if (mark.slot + 1 < members.size ()) {
+        T* last = members.back ();
+
+        members[mark.slot]                       = last;
+        this->storage->marks[last->index ()].slot = mark.slot;
+      }
+      members.pop_back ();
+      mark.generation = 0;
+      return 1;
+    }
+
+    /** `eraseIf (p)` removes all members `m` for which `p (m)` holds */
+    template <typename P>
+    void eraseIf (const P& predicate) {
+      if (this->storage) {
+        std::vector <T*>& members = this->storage->members;
+
+        for (unsigned int i = 0; i < members.size (); ) {
+          if (predicate (members[i])) {
+            this->erase (members[i]);
+          }
+          else {
+            i++;
+          }
+        }
+      }
+    }
+
+    unsigned int count (T* t) const {
+      if (this->storage == nullptr || t == nullptr) {
+        return 0;
+      }
+      const unsigned int index = t->index ();
+
+      return index < this->storage->marks.size ()
+          && this->storage->marks[index].generation == this->storage->generation ? 1 : 0;
+    }
+
+    void clear () {
+      if (this->storage) {
+        this->storage->clear ();
+      }
+    }
+
+    bool empty () const {
+      return this->size () == 0;
+    }
+
+    unsigned int size () const {
+      return this->storage ? this->storage->members.size () : 0;
+    }
+
+    const_iterator begin () const {
+      return this->storage ? this->storage->members.cbegin () : const_iterator ();
+    }
+
+    const_iterator end () const {
+      return this->storage ? this->storage->members.cend () : const_iterator ();
+    }
+
+  private:
+    std::unique_ptr <Storage> storage;
+
+    void release () {
+      if (this->storage) {
+        pool ().release (std::move (this->storage));
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "mapped-file.hpp"
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+struct MappedFile::Impl {
+  const char*        mappedData;
+  std::size_t        mappedSize;
+  std::vector <char> buffer;
+  bool               isOpen;
+
+  Impl (const std::string& fileName)
+    : mappedData (nullptr)
+    , mappedSize (0)
+    , isOpen     (false)
+  {
+    if (this->map (fileName) == false) {
+      this->read (fileName);
+    }
+  }
+
+  ~Impl () {
+    if (this->mappedData) {
+#ifdef _WIN32
+      UnmapViewOfFile (this->mappedData);
+#else
+      munmap (const_cast <char*> (this->mappedData), this->mappedSize);
+#endif
+    }
+  }
+
+  const char* data () const {
+    if (this->mappedData) {
+      return this->mappedData;
+    }
+    else {
+      return this->isOpen ? this->buffer.data () : nullptr;
+    }
+  }
+
+  std::size_t size () const {
+    return this->mappedData ? this->mappedSize : this->buffer.size ();
+  }
+
+  bool isMapped () const {
+    return this->mappedData != nullptr;
+  }
+
+#ifdef _WIN32
+  bool map (const std::string& fileName) {
+    HANDLE file = CreateFileA ( fileName.c_str (), GENERIC_READ, FILE_SHARE_READ, nullptr
+                              , OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER fileSize;
+
+    if (GetFileSizeEx (file, &fileSize) == 0 || fileSize.QuadPart == 0) {
+      CloseHandle (file);
+      return false;
+    }
+    HANDLE mapping = CreateFileMappingA (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle (file);
+
+    if (mapping == nullptr) {
+      return false;
+    }
+    void* view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle (mapping);
+
+    if (view == nullptr) {
+      return false;
+    }
+    this->mappedData = static_cast <const char*> (view);
+    this->mappedSize = std::size_t (fileSize.QuadPart);
+    this->isOpen     = true;
+    return true;
+  }
+#else
+  bool map (const std::string& fileName) {
+    const int file = open (fileName.c_str (), O_RDONLY);
+
+    if (file < 0) {
+      return false;
+    }
+    struct stat fileStat;
+
+    if (fstat (file, &fileStat) != 0 || fileStat.st_size <= 0) {
+      close (file);
+      return false;
+    }
+    void* view = mmap (nullptr, std::size_t (fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close (file);
+
+    if (view == MAP_FAILED) {
+      return false;
+    }
+    madvise (view, std::size_t (fileStat.st_size), MADV_SEQUENTIAL);
+
+    this->mappedData = static_cast <const char*> (view);
+    this->mappedSize = std::size_t (fileStat.st_size);
+    this->isOpen     = true;
+    return true;
+  }
+#endif
+
+  void read (const std::string& fileName) {
+    std::ifstream file (fileName, std::ios::binary);
+
+    if (file.is_open ()) {
+      this->buffer.assign ( std::istreambuf_iterator <char> (file)
+                          , std::istreambuf_iterator <char> () );
+      this->isOpen = true;
+    }
+  }
+};
+
+DELEGATE1_BIG2 (MappedFile, const std::string&)
+DELEGATE_CONST (const char*, MappedFile, data)
+DELEGATE_CONST (std::size_t, MappedFile, size)
+DELEGATE_CONST (bool       , MappedFile, isMapped)
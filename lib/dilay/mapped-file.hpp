@@ -0,0 +1,28 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_MAPPED_FILE
+#define DILAY_MAPPED_FILE
+
+#include <cstddef>
+#include <string>
+#include "macro.hpp"
+
+/* `MappedFile` maps a file read-only into memory while it exists.
+ * If a file can not be mapped, it is read into a buffer instead.
+ * `data` is `nullptr` if the file could not be opened.
+ */
+class MappedFile {
+  public:
+    DECLARE_BIG2 (MappedFile, const std::string&)
+
+    const char* data     () const;
+    std::size_t size     () const;
+    bool        isMapped () const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
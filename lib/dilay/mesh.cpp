@@ -2,12 +2,20 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <limits>
+#include <utility>
 #include <vector>
 #include "camera.hpp"
 #include "color.hpp"
+#include "copy-on-write-array.hpp"
 #include "mesh.hpp"
 #include "opengl.hpp"
 #include "opengl-buffer-id.hpp"
@@ -15,22 +23,153 @@
 #include "renderer.hpp"
 #include "util.hpp"
 
+namespace {
+  /* `BufferState` keeps track of the number of elements that have been uploaded to a
+   * GPU buffer and of the ranges of elements that have been modified since then.
+   * Ranges that are at most `mergeDistance` elements apart are merged, i.e. distant
+   * modifications are uploaded separately. If there are more than `maxNumDirtyRanges`
+   * ranges, the two closest ones are merged.
+   * Copies are invalid, because GPU buffers are not shared.
+   */
+  struct BufferState {
+    struct Range {
+      unsigned int begin;
+      unsigned int end;
+    };
+
+    static constexpr unsigned int mergeDistance     = 256;
+    static constexpr unsigned int maxNumDirtyRanges = 16;
+
+    bool                 isAllocated;
+    unsigned int         numUploaded;
+    std::vector <Range>  dirtyRanges;
+
+    BufferState () {
+      this->invalidate ();
+    }
+
+    BufferState (const BufferState&) : BufferState () {}
+
+    BufferState& operator= (const BufferState&) {
+      this->invalidate ();
+      return *this;
+    }
+
+    bool isDirty () const {
+      return this->dirtyRanges.empty () == false;
+    }
+
+    void markDirty (unsigned int begin, unsigned int end) {
+      // most recently modified ranges are checked first
+      for (auto it = this->dirtyRanges.rbegin (); it != this->dirtyRanges.rend (); ++it) {
+        if (begin <= it->end + mergeDistance && it->begin <= end + mergeDistance) {
+          it->begin = std::min (it->begin, begin);
+          it->end   = std::max (it->end, end);
+          return;
+        }
+      }
+      this->dirtyRanges.push_back (Range {begin, end});
+
+      if (this->dirtyRanges.size () > maxNumDirtyRanges) {
+        this->normalizeDirtyRanges ();
+      }
+    }
+
+    /* Sorts and merges overlapping ranges. Afterwards, the two closest ranges are merged
+     * until there are at most `maxNumDirtyRanges` ranges.
+     */
+    void normalizeDirtyRanges () {
+      std::vector <Range>& ranges = this->dirtyRanges;
+
+      std::sort (ranges.begin (), ranges.end (), [] (const Range& a, const Range& b) {
+        return a.begin < b.begin;
+      });
+
+      unsigned int n = 0;
+      for (unsigned int i = 1; i < ranges.size (); i++) {
+        if (ranges[i].begin <= ranges[n].end + mergeDistance) {
+          ranges[n].end = std::max (ranges[n].end, ranges[i].end);
+        }
+        else {
+          ranges[++n] = ranges[i];
+        }
+      }
+      ranges.resize (ranges.empty () ? 0 : n + 1);
+
+      while (ranges.size () > maxNumDirtyRanges) {
+        unsigned int closest = 0;
+        for (unsigned int i = 1; i + 1 < ranges.size (); i++) {
+          if ( ranges[i + 1].begin - ranges[i].end
+             < ranges[closest + 1].begin - ranges[closest].end )
+          {
+            closest = i;
+          }
+        }
+        ranges[closest].end = ranges[closest + 1].end;
+        ranges.erase (ranges.begin () + closest + 1);
+      }
+    }
+
+    // `f (begin, end)` is called for each disjoint dirty range in increasing order
+    template <typename F>
+    void forEachDirtyRange (const F& f) {
+      this->normalizeDirtyRanges ();
+
+      for (const Range& r : this->dirtyRanges) {
+        f (r.begin, r.end);
+      }
+    }
+
+    void markClean () {
+      this->dirtyRanges.clear ();
+    }
+
+    void invalidate () {
+      this->isAllocated = false;
+      this->numUploaded = 0;
+      this->markClean ();
+    }
+  };
+
+  /* `PackedVertex` interleaves a position with a normal that is stored as
+   * normalized 16-bit integers (the fourth component is padding).
+   */
+  struct PackedVertex {
+    float        position [3];
+    std::int16_t normal   [4];
+  };
+  static_assert (sizeof (PackedVertex) == 20, "unexpected size of packed vertex");
+
+  std::int16_t packNormalComponent (float c) {
+    return std::int16_t (glm::round (glm::clamp (c, -1.0f, 1.0f) * 32767.0f));
+  }
+
+  std::atomic <unsigned long> globalUploadedBytes (0);
+}
+
 struct Mesh::Impl {
   // cf. copy-constructor, reset
-  glm::mat4x4                 scalingMatrix;
-  glm::mat4x4                 rotationMatrix;
-  glm::mat4x4                 translationMatrix;
-  std::vector <float>         vertices;
-  std::vector <unsigned int>  indices;
-  std::vector <float>         normals;
-  Color                       color;
-  Color                       wireframeColor;
+  // geometry is shared between copies until it is modified (cf. `CopyOnWriteArray`)
+  glm::mat4x4                      scalingMatrix;
+  glm::mat4x4                      rotationMatrix;
+  glm::mat4x4                      translationMatrix;
+  CopyOnWriteArray <float>         vertices;
+  CopyOnWriteArray <unsigned int>  indices;
+  CopyOnWriteArray <float>         normals;
+  Color                            color;
+  Color                            wireframeColor;
 
   OpenGLBufferId              vertexBufferId;
   OpenGLBufferId              indexBufferId;
   OpenGLBufferId              normalBufferId;
+  OpenGLBufferId              packedBufferId;
+  BufferState                 vertexBufferState;
+  BufferState                 indexBufferState;
+  BufferState                 normalBufferState;
+  BufferState                 packedBufferState;
 
   RenderMode                  renderMode;
+  bool                        uploadedPackedVertices;
 
   Impl ()
     : scalingMatrix     (glm::mat4x4 (1.0f))
@@ -38,6 +177,7 @@ struct Mesh::Impl {
     , translationMatrix (glm::mat4x4 (1.0f))
     , color             (Color::White ())
     , wireframeColor    (Color::Black ())
+    , uploadedPackedVertices (false)
   {
     this->renderMode.smoothShading (true);
   }
@@ -45,20 +185,38 @@ struct Mesh::Impl {
   Impl (const Impl& source) : Impl (source, true)
   {}
 
+  // moved geometry is not shared with `source`, whose geometry becomes empty
+  Impl (Impl&& source) : Impl (source, false) {
+    std::swap (this->vertices, source.vertices);
+    std::swap (this->indices , source.indices);
+    std::swap (this->normals , source.normals);
+  }
+
   Impl (const Impl& source, bool copyGeometry)
     : scalingMatrix       (source.scalingMatrix)
     , rotationMatrix      (source.rotationMatrix)
     , translationMatrix   (source.translationMatrix)
-    , vertices            (copyGeometry ? source.vertices : std::vector <float>        ())
-    , indices             (copyGeometry ? source.indices  : std::vector <unsigned int> ())
-    , normals             (copyGeometry ? source.normals  : std::vector <float>        ())
+    , vertices            (copyGeometry ? source.vertices : CopyOnWriteArray <float>        ())
+    , indices             (copyGeometry ? source.indices  : CopyOnWriteArray <unsigned int> ())
+    , normals             (copyGeometry ? source.normals  : CopyOnWriteArray <float>        ())
     , color               (source.color)
     , wireframeColor      (source.wireframeColor)
     , renderMode          (source.renderMode) 
+    , uploadedPackedVertices (false)
   {}
 
   ~Impl () { this->reset (); }
 
+  Impl& operator= (const Impl&) = default;
+
+  Impl& operator= (Impl&& source) {
+    this->operator= (static_cast <const Impl&> (source));
+    source.vertices.clear ();
+    source.indices .clear ();
+    source.normals .clear ();
+    return *this;
+  }
+
   unsigned int numVertices () const { return this->vertices.size () / 3; }
   unsigned int numIndices  () const { return this->indices.size  (); }
   unsigned int numNormals  () const { return this->normals.size () / 3; }
@@ -97,7 +255,7 @@ struct Mesh::Impl {
   }
 
   unsigned int addIndex (unsigned int i) { 
-    this->indices.push_back (i); 
+    this->indices.pushBack (i); 
     return this->indices.size () - 1;
   }
 
@@ -113,13 +271,13 @@ struct Mesh::Impl {
     assert (Util::isNaN (v) == false);
     assert (Util::isNaN (n) == false);
 
-    this->vertices.push_back (v.x);
-    this->vertices.push_back (v.y);
-    this->vertices.push_back (v.z);
+    this->vertices.pushBack (v.x);
+    this->vertices.pushBack (v.y);
+    this->vertices.pushBack (v.z);
 
-    this->normals.push_back (n.x);
-    this->normals.push_back (n.y);
-    this->normals.push_back (n.z);
+    this->normals.pushBack (n.x);
+    this->normals.pushBack (n.y);
+    this->normals.pushBack (n.z);
 
     return this->numVertices () - 1;
   }
@@ -129,52 +287,165 @@ struct Mesh::Impl {
     this->normals .reserve (3*n);
   }
 
+  void addVertices (const float* vs, unsigned int n) {
+    for (unsigned int i = 0; i < 3*n; i++) {
+      assert (std::isnan (vs[i]) == false);
+    }
+    this->vertices.append (vs, 3*n);
+    this->normals .resize (this->normals.size () + (3*n), 0.0f);
+  }
+
+  void addIndices (const unsigned int* is, unsigned int n) {
+    this->indices.append (is, n);
+  }
+
   void setIndex (unsigned int index, unsigned int vertexIndex) {
     assert (index < this->indices.size ());
-    this->indices[index] = vertexIndex;
+    this->indices.set (index, vertexIndex);
+    this->indexBufferState.markDirty (index, index + 1);
   }
 
   void setVertex (unsigned int i, const glm::vec3& v) {
     assert (i < this->numVertices ());
     assert (Util::isNaN (v) == false);
 
-    this->vertices [(3*i) + 0] = v.x;
-    this->vertices [(3*i) + 1] = v.y;
-    this->vertices [(3*i) + 2] = v.z;
+    this->vertices.set ((3*i) + 0, v.x);
+    this->vertices.set ((3*i) + 1, v.y);
+    this->vertices.set ((3*i) + 2, v.z);
+    this->vertexBufferState.markDirty (3*i, (3*i) + 3);
   }
 
   void setNormal (unsigned int i, const glm::vec3& n) {
     assert (i < this->numNormals ());
     assert (Util::isNaN (n) == false);
 
-    this->normals [(3*i) + 0] = n.x;
-    this->normals [(3*i) + 1] = n.y;
-    this->normals [(3*i) + 2] = n.z;
+    this->normals.set ((3*i) + 0, n.x);
+    this->normals.set ((3*i) + 1, n.y);
+    this->normals.set ((3*i) + 2, n.z);
+    this->normalBufferState.markDirty (3*i, (3*i) + 3);
   }
 
-  void bufferData () {
-    if (this->vertexBufferId.isValid () == false) {
-      this->vertexBufferId.allocate ();
+  /* Uploads `n` elements if their number has changed since the last upload (or if
+   * nothing has been uploaded yet). Otherwise only the modified ranges are uploaded.
+   * `segments (begin, end, f)` must call `f (b, e, data)` for contiguous segments
+   * `[b, e)` that cover `[begin, end)`, where `data` points to the element at `b`.
+   */
+  template <typename T, typename F>
+  static void uploadBuffer ( unsigned int target, OpenGLBufferId& id, BufferState& state
+                           , unsigned int n, const F& segments )
+  {
+    OpenGLApi& opengl = OpenGL::instance();
+
+    if (id.isValid () == false) {
+      id.allocate ();
+      state.invalidate ();
     }
-    if (this->indexBufferId.isValid () == false) {
-      this->indexBufferId.allocate ();
+    opengl.glBindBuffer (target, id.id ());
+
+    auto subData = [target, n, &opengl] (unsigned int begin, unsigned int end, const T* data) {
+      assert (end <= n);
+
+      const unsigned int size = (end - begin) * sizeof (T);
+
+      opengl.glBufferSubData (target, begin * sizeof (T), size, data);
+      globalUploadedBytes += size;
+    };
+
+    if (state.isAllocated == false || state.numUploaded != n) {
+      opengl.glBufferData (target, n * sizeof (T), nullptr, opengl.DynamicDraw ());
+      segments (0, n, subData);
+
+      state.isAllocated = true;
+      state.numUploaded = n;
     }
-    if (this->normalBufferId.isValid () == false) {
-      this->normalBufferId.allocate ();
+    else {
+      state.forEachDirtyRange ([&segments, &subData] (unsigned int begin, unsigned int end) {
+        segments (begin, end, subData);
+      });
     }
+    state.markClean ();
+  }
+
+  template <typename T>
+  static void uploadBuffer ( unsigned int target, OpenGLBufferId& id, BufferState& state
+                           , const CopyOnWriteArray <T>& data )
+  {
+    Impl::uploadBuffer <T> ( target, id, state, data.size ()
+                           , [&data] (unsigned int begin, unsigned int end, const auto& f) {
+                               data.forEachSegment (begin, end, f);
+                             } );
+  }
+
+  void packVertices (unsigned int begin, unsigned int end, std::vector <PackedVertex>& packed) const {
+    packed.resize (end - begin);
+
+    for (unsigned int i = begin; i < end; i++) {
+      PackedVertex& p = packed [i - begin];
+
+      p.position [0] = this->vertices [(3 * i) + 0];
+      p.position [1] = this->vertices [(3 * i) + 1];
+      p.position [2] = this->vertices [(3 * i) + 2];
+      p.normal   [0] = packNormalComponent (this->normals [(3 * i) + 0]);
+      p.normal   [1] = packNormalComponent (this->normals [(3 * i) + 1]);
+      p.normal   [2] = packNormalComponent (this->normals [(3 * i) + 2]);
+      p.normal   [3] = 0;
+    }
+  }
+
+  /* Packed vertices are not kept on the CPU: modified ranges are packed into a temporary
+   * buffer right before they are uploaded.
+   */
+  void bufferPackedVertices () {
+    std::vector <PackedVertex> packed;
+
+    auto markPackedDirty = [this] (unsigned int begin, unsigned int end) {
+      this->packedBufferState.markDirty (begin / 3, (end + 2) / 3);
+    };
+    this->vertexBufferState.forEachDirtyRange (markPackedDirty);
+    this->normalBufferState.forEachDirtyRange (markPackedDirty);
+    this->vertexBufferState.markClean ();
+    this->normalBufferState.markClean ();
+
+    Impl::uploadBuffer <PackedVertex> ( OpenGL::instance ().ArrayBuffer (), this->packedBufferId
+                                      , this->packedBufferState, this->numVertices ()
+                                      , [this, &packed] ( unsigned int begin, unsigned int end
+                                                        , const auto& f )
+    {
+      this->packVertices (begin, end, packed);
+      f (begin, end, packed.data ());
+    });
+  }
+
+  void bufferData () {
     OpenGLApi& opengl = OpenGL::instance();
 
-    opengl.glBindBuffer (opengl.ArrayBuffer (), this->vertexBufferId.id ());
-    opengl.glBufferData ( opengl.ArrayBuffer (), this->sizeOfVertices ()
-                         , &this->vertices[0], opengl.StaticDraw () );
+    if (this->renderMode.packedVertices () != this->uploadedPackedVertices) {
+      this->uploadedPackedVertices = this->renderMode.packedVertices ();
 
-    opengl.glBindBuffer (opengl.ElementArrayBuffer (), this->indexBufferId.id ());
-    opengl.glBufferData ( opengl.ElementArrayBuffer (), this->sizeOfIndices ()
-                         , &this->indices[0], opengl.StaticDraw () );
+      // buffers of the other layout are not needed anymore
+      if (this->uploadedPackedVertices) {
+        this->vertexBufferId.reset ();
+        this->normalBufferId.reset ();
+      }
+      else {
+        this->packedBufferId.reset ();
+      }
+      this->vertexBufferState.invalidate ();
+      this->normalBufferState.invalidate ();
+      this->packedBufferState.invalidate ();
+    }
 
-    opengl.glBindBuffer (opengl.ArrayBuffer (), this->normalBufferId.id ());
-    opengl.glBufferData ( opengl.ArrayBuffer (), this->sizeOfNormals ()
-                         , &this->normals[0], opengl.StaticDraw () );
+    if (this->uploadedPackedVertices) {
+      this->bufferPackedVertices ();
+    }
+    else {
+      Impl::uploadBuffer ( opengl.ArrayBuffer (), this->vertexBufferId
+                         , this->vertexBufferState, this->vertices );
+      Impl::uploadBuffer ( opengl.ArrayBuffer (), this->normalBufferId
+                         , this->normalBufferState, this->normals );
+    }
+    Impl::uploadBuffer ( opengl.ElementArrayBuffer (), this->indexBufferId
+                       , this->indexBufferState, this->indices );
 
     opengl.glBindBuffer (opengl.ElementArrayBuffer (), 0);
     opengl.glBindBuffer (opengl.ArrayBuffer (), 0);
@@ -208,17 +479,31 @@ struct Mesh::Impl {
 
     this->setModelMatrix              (camera, this->renderMode.cameraRotationOnly ());
 
-    opengl.glBindBuffer              (opengl.ArrayBuffer (), this->vertexBufferId.id ());
-    opengl.glEnableVertexAttribArray (opengl.PositionIndex);
-    opengl.glVertexAttribPointer     (opengl.PositionIndex, 3, opengl.Float (), false, 0, 0);
+    if (this->uploadedPackedVertices) {
+      const unsigned int stride = sizeof (PackedVertex);
+      const void*        offset = reinterpret_cast <const void*> (offsetof (PackedVertex, normal));
 
-    opengl.glBindBuffer              (opengl.ElementArrayBuffer (), this->indexBufferId.id ());
+      opengl.glBindBuffer              (opengl.ArrayBuffer (), this->packedBufferId.id ());
+      opengl.glEnableVertexAttribArray (opengl.PositionIndex);
+      opengl.glVertexAttribPointer     (opengl.PositionIndex, 3, opengl.Float (), false, stride, 0);
 
-    if (this->renderMode.smoothShading ()) {
-      opengl.glBindBuffer              (opengl.ArrayBuffer (), this->normalBufferId.id ());
-      opengl.glEnableVertexAttribArray (opengl.NormalIndex);
-      opengl.glVertexAttribPointer     (opengl.NormalIndex, 3, opengl.Float (), false, 0, 0);
+      if (this->renderMode.smoothShading ()) {
+        opengl.glEnableVertexAttribArray (opengl.NormalIndex);
+        opengl.glVertexAttribPointer     (opengl.NormalIndex, 3, opengl.Short (), true, stride, offset);
+      }
     }
+    else {
+      opengl.glBindBuffer              (opengl.ArrayBuffer (), this->vertexBufferId.id ());
+      opengl.glEnableVertexAttribArray (opengl.PositionIndex);
+      opengl.glVertexAttribPointer     (opengl.PositionIndex, 3, opengl.Float (), false, 0, 0);
+
+      if (this->renderMode.smoothShading ()) {
+        opengl.glBindBuffer              (opengl.ArrayBuffer (), this->normalBufferId.id ());
+        opengl.glEnableVertexAttribArray (opengl.NormalIndex);
+        opengl.glVertexAttribPointer     (opengl.NormalIndex, 3, opengl.Float (), false, 0, 0);
+      }
+    }
+    opengl.glBindBuffer (opengl.ElementArrayBuffer (), this->indexBufferId.id ());
     opengl.glBindBuffer (opengl.ArrayBuffer (), 0);
 
     if (this->renderMode.noDepthTest ()) {
@@ -235,11 +520,14 @@ struct Mesh::Impl {
     opengl.glEnable                   (opengl.DepthTest ());
   }
 
+  /* Only uploaded indices are rendered, i.e. rendering does not read the mesh data,
+   * which may be modified by another thread meanwhile (see `ToolSculpt`).
+   */
   void render (Camera& camera) const {
     this->renderBegin (camera);
     OpenGLApi& opengl = OpenGL::instance();
 
-    opengl.glDrawElements ( opengl.Triangles (), this->numIndices ()
+    opengl.glDrawElements ( opengl.Triangles (), this->indexBufferState.numUploaded
                            , opengl.UnsignedInt (), nullptr );
 
     this->renderEnd ();
@@ -248,7 +536,7 @@ struct Mesh::Impl {
   void renderLines (Camera& camera) const {
     this->renderBegin (camera);
       OpenGLApi& opengl = OpenGL::instance();
-    opengl.glDrawElements ( opengl.Lines (), this->numIndices ()
+    opengl.glDrawElements ( opengl.Lines (), this->indexBufferState.numUploaded
                            , opengl.UnsignedInt (), nullptr );
     this->renderEnd ();
   }
@@ -263,12 +551,21 @@ struct Mesh::Impl {
     this->vertexBufferId.reset ();
     this->indexBufferId .reset ();
     this->normalBufferId.reset ();
+    this->packedBufferId.reset ();
+    this->vertexBufferState.invalidate ();
+    this->indexBufferState .invalidate ();
+    this->normalBufferState.invalidate ();
+    this->packedBufferState.invalidate ();
   }
 
   void resetGeometry () {
     this->vertices.clear ();
     this->indices .clear ();
     this->normals .clear ();
+    this->vertexBufferState.invalidate ();
+    this->indexBufferState .invalidate ();
+    this->normalBufferState.invalidate ();
+    this->packedBufferState.invalidate ();
   }
 
   void scale (const glm::vec3& v) {
@@ -381,11 +678,18 @@ DELEGATE1        (void              , Mesh, reserveIndices, unsigned int)
 DELEGATE1        (unsigned int      , Mesh, addVertex, const glm::vec3&)
 DELEGATE2        (unsigned int      , Mesh, addVertex, const glm::vec3&, const glm::vec3&)
 DELEGATE1        (void              , Mesh, reserveVertices, unsigned int)
+DELEGATE2        (void              , Mesh, addVertices, const float*, unsigned int)
+DELEGATE2        (void              , Mesh, addIndices, const unsigned int*, unsigned int)
 DELEGATE2        (void              , Mesh, setIndex, unsigned int, unsigned int)
 DELEGATE2        (void              , Mesh, setVertex, unsigned int, const glm::vec3&)
 DELEGATE2        (void              , Mesh, setNormal, unsigned int, const glm::vec3&)
 
 DELEGATE         (void              , Mesh, bufferData)
+
+unsigned long Mesh :: uploadedBytes () {
+  return globalUploadedBytes;
+}
+
 DELEGATE_CONST   (glm::mat4x4       , Mesh, modelMatrix)
 DELEGATE_CONST   (glm::mat3x3       , Mesh, modelNormalMatrix)
 DELEGATE1_CONST  (void              , Mesh, renderBegin, Camera&)
@@ -15,7 +15,8 @@ class RenderMode;
 
 class Mesh {
   public:
-    /** `bufferData` must be called on the mutated mesh after copy or assignment */
+    /** `bufferData` must be called on the mutated mesh after copy or assignment.
+     * Moving a mesh leaves the moved-from mesh without geometry. */
     DECLARE_BIG6 (Mesh)
 
     /** `Mesh (m,b)` calls copy constructor, but only copies
@@ -32,10 +33,18 @@ class Mesh {
     unsigned int       addVertex         (const glm::vec3&);
     unsigned int       addVertex         (const glm::vec3&, const glm::vec3&);
     void               reserveVertices   (unsigned int);
+    /** `addVertices (v,n)` appends `n` vertices with zero normals, whose coordinates
+     * are stored consecutively in `v`. */
+    void               addVertices       (const float*, unsigned int);
+    /** `addIndices (i,n)` appends the `n` indices stored in `i`. */
+    void               addIndices        (const unsigned int*, unsigned int);
     void               setIndex          (unsigned int, unsigned int);
     void               setVertex         (unsigned int, const glm::vec3&);
     void               setNormal         (unsigned int, const glm::vec3&);
 
+    /** `bufferData` uploads modified ranges only, unless the mesh has grown or shrunk.
+     * If `renderMode ().packedVertices ()` holds, positions and normals are uploaded
+     * into a single interleaved buffer, where normals are stored as 16-bit snorms. */
     void               bufferData        ();
     glm::mat4x4        modelMatrix       () const;
     glm::mat3x3        modelNormalMatrix () const;
@@ -70,6 +79,9 @@ class Mesh {
     const Color&       wireframeColor    () const;
     void               wireframeColor    (const Color&);
 
+    /** total number of bytes that have been uploaded to GPU buffers by all meshes */
+    static unsigned long uploadedBytes   ();
+
   private: 
     IMPLEMENTATION
 };
@@ -0,0 +1,111 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_NULL_OPENGL
+#define DILAY_NULL_OPENGL
+
+#include "opengl.hpp"
+
+/* `NullOpenGL` ignores all calls, such that meshes can be built and buffered without an
+ * OpenGL context, e.g. in tests or in headless tools.
+ * It is installed while it exists.
+ */
+class NullOpenGL : public OpenGLApi {
+  public:
+    NullOpenGL () : numBuffers (0) {
+      OpenGL::install (this);
+    }
+
+    ~NullOpenGL () {
+      OpenGL::install (nullptr);
+    }
+
+    unsigned int Always                     () { return 0; }
+    unsigned int ArrayBuffer                () { return 0; }
+    unsigned int Back                       () { return 0; }
+    unsigned int Blend                      () { return 0; }
+    unsigned int ColorBufferBit             () { return 0; }
+    unsigned int CullFace                   () { return 0; }
+    unsigned int CW                         () { return 0; }
+    unsigned int CCW                        () { return 0; }
+    unsigned int Decr                       () { return 0; }
+    unsigned int DecrWrap                   () { return 0; }
+    unsigned int DepthBufferBit             () { return 0; }
+    unsigned int DepthTest                  () { return 0; }
+    unsigned int DynamicDraw                () { return 0; }
+    unsigned int DstColor                   () { return 0; }
+    unsigned int ElementArrayBuffer         () { return 0; }
+    unsigned int Equal                      () { return 0; }
+    unsigned int Fill                       () { return 0; }
+    unsigned int Float                      () { return 0; }
+    unsigned int Front                      () { return 0; }
+    unsigned int FrontAndBack               () { return 0; }
+    unsigned int FuncAdd                    () { return 0; }
+    unsigned int Greater                    () { return 0; }
+    unsigned int Incr                       () { return 0; }
+    unsigned int IncrWrap                   () { return 0; }
+    unsigned int Invert                     () { return 0; }
+    unsigned int Keep                       () { return 0; }
+    unsigned int LEqual                     () { return 0; }
+    unsigned int Line                       () { return 0; }
+    unsigned int Lines                      () { return 0; }
+    unsigned int Never                      () { return 0; }
+    unsigned int PolygonOffsetFill          () { return 0; }
+    unsigned int Replace                    () { return 0; }
+    unsigned int Short                      () { return 0; }
+    unsigned int StaticDraw                 () { return 0; }
+    unsigned int StencilBufferBit           () { return 0; }
+    unsigned int StencilTest                () { return 0; }
+    unsigned int Triangles                  () { return 0; }
+    unsigned int UnsignedInt                () { return 0; }
+    unsigned int Zero                       () { return 0; }
+    void         glBindBuffer               (unsigned int, unsigned int) {}
+    void         glBlendEquation            (unsigned int) {}
+    void         glBlendFunc                (unsigned int, unsigned) {}
+    void         glBufferData               (unsigned int, unsigned int, const void*, unsigned int) {}
+    void         glBufferSubData            (unsigned int, unsigned int, unsigned int, const void*) {}
+    void         glClear                    (unsigned int) {}
+    void         glClearColor               (float, float, float, float) {}
+    void         glClearStencil             (int) {}
+    void         glColorMask                (bool, bool, bool, bool) {}
+    void         glCullFace                 (unsigned int) {}
+    void         glDepthFunc                (unsigned int) {}
+    void         glDepthMask                (bool) {}
+    void         glDisable                  (unsigned int) {}
+    void         glDisableVertexAttribArray (unsigned int) {}
+    void         glDrawElements             (unsigned int, unsigned int, unsigned int, const void*) {}
+    void         glEnable                   (unsigned int) {}
+    void         glEnableVertexAttribArray  (unsigned int) {}
+    void         glFrontFace                (unsigned int) {}
+    void glGenBuffers (unsigned int n, unsigned int* ids) {
+      for (unsigned int i = 0; i < n; i++) {
+        ids[i] = ++this->numBuffers;
+      }
+    }
+    int          glGetUniformLocation       (unsigned int, const char*) { return 0; }
+    bool         glIsBuffer                 (unsigned int) { return true; }
+    bool         glIsProgram                (unsigned int) { return true; }
+    void         glPolygonMode              (unsigned int, unsigned int) {}
+    void         glPolygonOffset            (float, float) {}
+    void         glStencilFunc              (unsigned int, int, unsigned int) {}
+    void         glStencilOp                (unsigned int, unsigned int, unsigned int) {}
+    void         glUniform1f                (int, float) {}
+    void         glUniformMatrix3fv         (int, unsigned int, bool, const float*) {}
+    void         glUniformMatrix4fv         (int, unsigned int, bool, const float*) {}
+    void         glUseProgram               (unsigned int) {}
+    void         glVertexAttribPointer      (unsigned int, int, unsigned int, bool, unsigned int, const void*) {}
+    void         glViewport                 (unsigned int, unsigned int, unsigned int, unsigned int) {}
+    bool         supportsGeometryShader     () { return false; }
+    void         glUniformVec3              (unsigned int, const glm::vec3&) {}
+    void         glUniformVec4              (unsigned int, const glm::vec4&) {}
+    void         safeDeleteBuffer           (unsigned int& id) { id = 0; }
+    void         safeDeleteShader           (unsigned int&) {}
+    void         safeDeleteProgram          (unsigned int&) {}
+    unsigned int loadProgram                (const char*, const char*, bool) { return 1; }
+
+  private:
+    unsigned int numBuffers;
+};
+
+#endif
@@ -24,6 +24,7 @@ public:
   virtual unsigned int DecrWrap           () = 0;
   virtual unsigned int DepthBufferBit     () = 0;
   virtual unsigned int DepthTest          () = 0;
+  virtual unsigned int DynamicDraw        () = 0;
   virtual unsigned int DstColor           () = 0;
   virtual unsigned int ElementArrayBuffer () = 0;
   virtual unsigned int Equal              () = 0;
@@ -43,6 +44,7 @@ public:
   virtual unsigned int Never              () = 0;
   virtual unsigned int PolygonOffsetFill  () = 0;
   virtual unsigned int Replace            () = 0;
+  virtual unsigned int Short              () = 0;
   virtual unsigned int StaticDraw         () = 0;
   virtual unsigned int StencilBufferBit   () = 0;
   virtual unsigned int StencilTest        () = 0;
@@ -54,6 +56,7 @@ public:
   virtual void glBlendEquation            (unsigned int) = 0;
   virtual void glBlendFunc                (unsigned int, unsigned) = 0;
   virtual void glBufferData               (unsigned int, unsigned int, const void*, unsigned int) = 0;
+  virtual void glBufferSubData            (unsigned int, unsigned int, unsigned int, const void*) = 0;
   virtual void glClear                    (unsigned int) = 0;
   virtual void glClearColor               (float, float, float, float) = 0;
   virtual void glClearStencil             (int) = 0;
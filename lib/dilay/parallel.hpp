@@ -0,0 +1,75 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_PARALLEL
+#define DILAY_PARALLEL
+
+#include <algorithm>
+#include "task-pool.hpp"
+
+namespace Parallel {
+
+  /** `numThreads (n)` returns `n` if `n > 0` and the number of threads of the global
+   * task pool otherwise */
+  inline unsigned int numThreads (unsigned int n) {
+    return n > 0 ? n : TaskPool::global ().numThreads ();
+  }
+
+  /* `forChunks (n, t, m, f)` splits `[0,n)` into at most `numThreads (t)` contiguous
+   * chunks of at least `m` elements and calls `f (begin, end)` for each chunk.
+   * Chunks are executed on the global task pool, the last chunk is processed by the
+   * calling thread.
+   * Chunk boundaries only depend on the arguments, i.e. results that are written per
+   * element do not depend on scheduling.
+   */
+  template <typename F>
+  void forChunks (unsigned int n, unsigned int t, unsigned int m, const F& f) {
+    const unsigned int maxChunks = std::max (1u, n / std::max (1u, m));
+    const unsigned int numChunks = std::min (numThreads (t), maxChunks);
+
+    if (numChunks <= 1) {
+      f (0, n);
+    }
+    else {
+      const unsigned int chunkSize = (n + numChunks - 1) / numChunks;
+      TaskGroup          group;
+
+      for (unsigned int i = 0; i < numChunks - 1; i++) {
+        const unsigned int begin = i * chunkSize;
+        const unsigned int end   = std::min (n, begin + chunkSize);
+
+        group.run ([&f, begin, end] () { f (begin, end); });
+      }
+      f (std::min (n, (numChunks - 1) * chunkSize), n);
+      group.wait ();
+    }
+  }
+
+  /* `forRange (n, g, f)` splits `[0,n)` into chunks of `g` elements and calls
+   * `f (begin, end)` for each chunk on the global task pool.
+   * Chunks are not bound to threads, i.e. idle threads steal chunks from busy ones,
+   * which balances chunks of varying cost.
+   */
+  template <typename F>
+  void forRange (unsigned int n, unsigned int g, const F& f) {
+    const unsigned int grain = std::max (1u, g);
+
+    if (n <= grain) {
+      f (0, n);
+    }
+    else {
+      TaskGroup group;
+
+      for (unsigned int begin = grain; begin < n; begin += grain) {
+        const unsigned int end = std::min (n, begin + grain);
+
+        group.run ([&f, begin, end] () { f (begin, end); });
+      }
+      f (0, grain);
+      group.wait ();
+    }
+  }
+}
+
+#endif
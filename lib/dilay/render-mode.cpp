@@ -12,6 +12,7 @@ RenderMode::RenderMode () {
   this->renderWireframe    (false);
   this->cameraRotationOnly (false);
   this->noDepthTest        (false);
+  this->packedVertices     (false);
 }
 
 RenderMode::RenderMode (const RenderMode& other) 
@@ -24,6 +25,7 @@ bool RenderMode::constantShading    () const { return this->flags.get <2> (); }
 bool RenderMode::renderWireframe    () const { return this->flags.get <3> (); }
 bool RenderMode::cameraRotationOnly () const { return this->flags.get <4> (); }
 bool RenderMode::noDepthTest        () const { return this->flags.get <5> (); }
+bool RenderMode::packedVertices     () const { return this->flags.get <6> (); }
 
 const char* RenderMode::vertexShader () const {
   if (this->smoothShading ()) {
@@ -85,3 +87,4 @@ void RenderMode::constantShading (bool v) {
 void RenderMode::renderWireframe    (bool v) { this->flags.set <3> (v); }
 void RenderMode::cameraRotationOnly (bool v) { this->flags.set <4> (v); }
 void RenderMode::noDepthTest        (bool v) { this->flags.set <5> (v); }
+void RenderMode::packedVertices     (bool v) { this->flags.set <6> (v); }
@@ -18,6 +18,7 @@ class RenderMode {
     bool        renderWireframe    () const;
     bool        cameraRotationOnly () const;
     bool        noDepthTest        () const;
+    bool        packedVertices     () const;
     const char* vertexShader       () const;
     const char* fragmentShader     () const;
 
@@ -27,6 +28,7 @@ class RenderMode {
     void        renderWireframe    (bool);
     void        cameraRotationOnly (bool);
     void        noDepthTest        (bool);
+    void        packedVertices     (bool);
 
   private:
     Bitset <unsigned int> flags;
@@ -2,8 +2,12 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include "mapped-file.hpp"
 #include "mesh.hpp"
 #include "mesh-util.hpp"
 #include "scene.hpp"
@@ -75,6 +79,253 @@ namespace {
       }
     }
   }
+
+  /* Binary files start with the magic `DLYB`, the format version and the byte order
+   * mark `0x01020304`, followed by a sequence of chunks. A chunk consists of a four
+   * character tag, the size of its payload in bytes and the payload itself. All values
+   * are 32-bit unsigned integers or floats and payload sizes are multiples of 4, i.e.
+   * payloads are aligned and can be used directly from a memory-mapped file.
+   *  `MESH`: number of vertices n, number of indices m, 3n coordinates, m indices
+   *  `SKCH`: starts a new sketch mesh, has no payload
+   *  `TREE`: number of nodes n, followed by n nodes of the current sketch in pre-order,
+   *          each with the index of its parent (invalid for the root), center and radius
+   *  `PATH`: first and last intersection, number of spheres n, followed by n spheres of
+   *          a path of the current sketch, each with center and radius
+   * Unknown chunks are skipped.
+   */
+  static_assert (sizeof (float) == 4, "binary files require 32-bit floats");
+  static_assert (sizeof (glm::vec3) == 3 * sizeof (float), "unexpected layout of glm::vec3");
+
+  const char          binaryMagic[4]  = { 'D', 'L', 'Y', 'B' };
+  const std::uint32_t binaryVersion   = 1;
+  const std::uint32_t binaryByteOrder = 0x01020304;
+
+  void writeTag (std::ostream& stream, const char* tag) {
+    stream.write (tag, 4);
+  }
+
+  template <typename T>
+  void writeValue (std::ostream& stream, const T& value) {
+    stream.write (reinterpret_cast <const char*> (&value), sizeof (T));
+  }
+
+  template <typename T>
+  void writeValues (std::ostream& stream, const T* values, std::size_t n) {
+    stream.write (reinterpret_cast <const char*> (values), n * sizeof (T));
+  }
+
+  void writeChunk (std::ostream& stream, const char* tag, std::uint32_t size) {
+    writeTag   (stream, tag);
+    writeValue (stream, size);
+  }
+
+  void toBinaryDlyFile (std::ostream& stream, const Mesh& mesh) {
+    const std::uint32_t numVertices = mesh.numVertices ();
+    const std::uint32_t numIndices  = mesh.numIndices ();
+
+    std::vector <glm::vec3>     vertices;
+    std::vector <std::uint32_t> indices;
+
+    vertices.reserve (numVertices);
+    indices .reserve (numIndices);
+
+    for (unsigned int i = 0; i < numVertices; i++) {
+      vertices.push_back (mesh.vertex (i));
+    }
+    for (unsigned int i = 0; i < numIndices; i++) {
+      indices.push_back (mesh.index (i));
+    }
+
+    writeChunk  (stream, "MESH", 8 + (12 * numVertices) + (4 * numIndices));
+    writeValue  (stream, numVertices);
+    writeValue  (stream, numIndices);
+    writeValues (stream, vertices.data (), vertices.size ());
+    writeValues (stream, indices.data (), indices.size ());
+  }
+
+  struct BinaryNode {
+    std::uint32_t parent;
+    glm::vec3     center;
+    float         radius;
+  };
+  static_assert (sizeof (BinaryNode) == 20, "unexpected layout of BinaryNode");
+
+  void makeBinaryNodes ( const SketchNode& node, std::uint32_t parent
+                       , std::vector <BinaryNode>& nodes )
+  {
+    const std::uint32_t index = nodes.size ();
+
+    nodes.push_back (BinaryNode { parent, node.data ().center (), node.data ().radius () });
+
+    node.forEachConstChild ([index, &nodes] (const SketchNode& child) {
+      makeBinaryNodes (child, index, nodes);
+    });
+  }
+
+  void toBinaryDlyFile (std::ostream& stream, const SketchPath& path) {
+    if (path.isEmpty () == false) {
+      const std::uint32_t numSpheres = path.spheres ().size ();
+
+      writeChunk (stream, "PATH", 28 + (16 * numSpheres));
+      writeValue (stream, path.intersectionFirst ());
+      writeValue (stream, path.intersectionLast ());
+      writeValue (stream, numSpheres);
+
+      for (const PrimSphere& s : path.spheres ()) {
+        writeValue (stream, s.center ());
+        writeValue (stream, s.radius ());
+      }
+    }
+  }
+
+  void toBinaryDlyFile (std::ostream& stream, const SketchMesh& mesh) {
+    if (mesh.isEmpty () == false) {
+      writeChunk (stream, "SKCH", 0);
+
+      if (mesh.tree ().hasRoot ()) {
+        std::vector <BinaryNode> nodes;
+        makeBinaryNodes (mesh.tree ().root (), Util::invalidIndex (), nodes);
+
+        writeChunk  (stream, "TREE", 4 + (sizeof (BinaryNode) * nodes.size ()));
+        writeValue  (stream, std::uint32_t (nodes.size ()));
+        writeValues (stream, nodes.data (), nodes.size ());
+      }
+
+      for (const SketchPath& p : mesh.paths ()) {
+        toBinaryDlyFile (stream, p);
+      }
+    }
+  }
+
+  /* `BinaryReader` reads values from a buffer and fails if the buffer is exhausted. */
+  struct BinaryReader {
+    const char* data;
+    std::size_t size;
+    std::size_t position;
+
+    BinaryReader (const char* d, std::size_t s)
+      : data     (d)
+      , size     (s)
+      , position (0)
+    {}
+
+    bool isEmpty () const {
+      return this->position >= this->size;
+    }
+
+    const char* skip (std::size_t n) {
+      if (n <= this->size - this->position) {
+        const char* begin = this->data + this->position;
+        this->position += n;
+        return begin;
+      }
+      else {
+        return nullptr;
+      }
+    }
+
+    template <typename T>
+    bool read (T& value) {
+      const char* begin = this->skip (sizeof (T));
+
+      if (begin) {
+        std::memcpy (&value, begin, sizeof (T));
+        return true;
+      }
+      else {
+        return false;
+      }
+    }
+  };
+
+  bool fromBinaryMesh (BinaryReader& chunk, Mesh& mesh) {
+    std::uint32_t numVertices, numIndices;
+
+    if (chunk.read (numVertices) == false || chunk.read (numIndices) == false) {
+      return false;
+    }
+    const char* vertices = chunk.skip (std::size_t (numVertices) * 12);
+    const char* indices  = chunk.skip (std::size_t (numIndices) * 4);
+
+    if (vertices == nullptr || indices == nullptr || numIndices % 3 != 0) {
+      return false;
+    }
+    // payloads are aligned (cf. `SceneUtil::fromBinaryDlyFile`)
+    const float*        v = reinterpret_cast <const float*> (vertices);
+    const unsigned int* i = reinterpret_cast <const unsigned int*> (indices);
+
+    if (std::any_of (i, i + numIndices, [numVertices] (unsigned int index) {
+                                          return index >= numVertices; }))
+    {
+      return false;
+    }
+    mesh.reserveVertices (numVertices);
+    mesh.reserveIndices  (numIndices);
+    mesh.addVertices     (v, numVertices);
+    mesh.addIndices      (i, numIndices);
+    return true;
+  }
+
+  /* Sketches are loaded into a `BinarySketch` and added to the scene once the whole
+   * file has been parsed.
+   */
+  struct BinarySketch {
+    SketchTree  tree;
+    SketchPaths paths;
+  };
+
+  bool fromBinaryTree (BinaryReader& chunk, BinarySketch& sketch) {
+    std::uint32_t             numNodes;
+    std::vector <SketchNode*> nodes;
+
+    if (chunk.read (numNodes) == false || sketch.tree.hasRoot ()) {
+      return false;
+    }
+    for (std::uint32_t i = 0; i < numNodes; i++) {
+      BinaryNode node;
+
+      if (chunk.read (node) == false) {
+        return false;
+      }
+      const PrimSphere sphere (node.center, node.radius);
+
+      if (i == 0) {
+        nodes.push_back (&sketch.tree.emplaceRoot (sphere));
+      }
+      else if (node.parent < nodes.size ()) {
+        nodes.push_back (&nodes[node.parent]->emplaceChild (sphere));
+      }
+      else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool fromBinaryPath (BinaryReader& chunk, BinarySketch& sketch) {
+    glm::vec3     intersectionFirst, intersectionLast;
+    std::uint32_t numSpheres;
+
+    if ( chunk.read (intersectionFirst) == false || chunk.read (intersectionLast) == false
+                                                 || chunk.read (numSpheres) == false )
+    {
+      return false;
+    }
+    sketch.paths.emplace_back ();
+
+    SketchPath& path = sketch.paths.back ();
+
+    for (std::uint32_t i = 0; i < numSpheres; i++) {
+      glm::vec3 center;
+      float     radius;
+
+      if (chunk.read (center) == false || chunk.read (radius) == false) {
+        return false;
+      }
+      path.addSphere (i == 0 ? intersectionFirst : intersectionLast, center, radius);
+    }
+    return true;
+  }
 };
 
 namespace SceneUtil {
@@ -92,18 +343,50 @@ namespace SceneUtil {
   }
 
   bool toDlyFile (const std::string& fileName, const Scene& scene, bool isObjFile) {
-    std::ofstream file (fileName);
+    const bool isBinary = isObjFile == false && SceneUtil::isBinaryDlyFileName (fileName);
+
+    std::ofstream file (fileName, isBinary ? std::ios::binary : std::ios::out);
 
     if (file.is_open ()) {
-      SceneUtil::toDlyFile (file, scene, isObjFile);
+      if (isBinary) {
+        SceneUtil::toBinaryDlyFile (file, scene);
+      }
+      else {
+        SceneUtil::toDlyFile (file, scene, isObjFile);
+      }
       file.close ();
-      return true;
+      return bool (file);
     }
     else {
       return false;
     }
   }
 
+  void toBinaryDlyFile (std::ostream& stream, const Scene& scene) {
+    writeTag   (stream, binaryMagic);
+    writeValue (stream, binaryVersion);
+    writeValue (stream, binaryByteOrder);
+
+    scene.forEachConstMesh ([&stream] (const WingedMesh& mesh) {
+      ::toBinaryDlyFile (stream, mesh.makePrunedMesh ());
+    });
+    scene.forEachConstMesh ([&stream] (const SketchMesh& mesh) {
+      ::toBinaryDlyFile (stream, mesh);
+    });
+  }
+
+  bool isBinaryDlyFile (const char* data, std::size_t size) {
+    return size >= 4 && std::memcmp (data, binaryMagic, 4) == 0;
+  }
+
+  bool isBinaryDlyFileName (const std::string& fileName) {
+    const std::string extension (".dlyb");
+
+    return fileName.size () >= extension.size ()
+        && fileName.compare ( fileName.size () - extension.size (), extension.size ()
+                            , extension ) == 0;
+  }
+
   bool fromDlyFile (std::istream& stream, const Config& config, Scene& scene) {
     unsigned int              lineNumber = 0;
     std::istringstream        lineStream;
@@ -283,7 +566,102 @@ namespace SceneUtil {
                     , [] (Mesh& m) { return MeshUtil::checkConsistency (m); } ))
     {
       for (Mesh& m : meshes) {
-        scene.newWingedMesh (config, m);
+        scene.newWingedMesh (config, std::move (m));
+      }
+      return true;
+    }
+    else {
+      return false;
+    }
+  }
+
+  bool fromBinaryDlyFile (const char* data, std::size_t size, const Config& config, Scene& scene) {
+    if (reinterpret_cast <std::uintptr_t> (data) % alignof (std::uint32_t) != 0) {
+      const std::vector <char> aligned (data, data + size);
+      return SceneUtil::fromBinaryDlyFile (aligned.data (), aligned.size (), config, scene);
+    }
+    BinaryReader  reader (data, size);
+    char          magic[4];
+    std::uint32_t version, byteOrder;
+
+    if (reader.read (magic) == false || std::memcmp (magic, binaryMagic, 4) != 0) {
+      DILAY_WARN ("could not parse binary file: invalid magic")
+      return false;
+    }
+    else if (reader.read (version) == false || version > binaryVersion) {
+      DILAY_WARN ("could not parse binary file: unsupported version")
+      return false;
+    }
+    else if (reader.read (byteOrder) == false || byteOrder != binaryByteOrder) {
+      DILAY_WARN ("could not parse binary file: unsupported byte order")
+      return false;
+    }
+
+    std::vector <Mesh>         meshes;
+    std::vector <BinarySketch> sketches;
+
+    while (reader.isEmpty () == false) {
+      const std::size_t offset = reader.position;
+      char              tag[4];
+      std::uint32_t     size;
+
+      if (reader.read (tag) == false || reader.read (size) == false) {
+        DILAY_WARN ("could not parse chunk header at offset %zu", offset)
+        return false;
+      }
+      else if (size % 4 != 0) {
+        DILAY_WARN ("could not parse chunk at offset %zu: unaligned size", offset)
+        return false;
+      }
+      const char* payload = reader.skip (size);
+
+      if (payload == nullptr) {
+        DILAY_WARN ("could not parse chunk at offset %zu: unexpected end of file", offset)
+        return false;
+      }
+      BinaryReader chunk (payload, size);
+
+      if (std::memcmp (tag, "MESH", 4) == 0) {
+        meshes.push_back (Mesh ());
+
+        if (fromBinaryMesh (chunk, meshes.back ()) == false) {
+          DILAY_WARN ("could not parse mesh at offset %zu", offset)
+          return false;
+        }
+      }
+      else if (std::memcmp (tag, "SKCH", 4) == 0) {
+        sketches.emplace_back ();
+      }
+      else if (std::memcmp (tag, "TREE", 4) == 0) {
+        if (sketches.empty () || fromBinaryTree (chunk, sketches.back ()) == false) {
+          DILAY_WARN ("could not parse sketch tree at offset %zu", offset)
+          return false;
+        }
+      }
+      else if (std::memcmp (tag, "PATH", 4) == 0) {
+        if (sketches.empty () || fromBinaryPath (chunk, sketches.back ()) == false) {
+          DILAY_WARN ("could not parse sketch path at offset %zu", offset)
+          return false;
+        }
+      }
+    }
+    meshes.erase ( std::remove_if ( meshes.begin ()
+                                  , meshes.end   ()
+                                  , [] (Mesh& m) { return m.numVertices () == 0; } )
+                 , meshes.end () );
+
+    if (std::all_of ( meshes.begin (), meshes.end ()
+                    , [] (Mesh& m) { return MeshUtil::checkConsistency (m); } ))
+    {
+      for (Mesh& m : meshes) {
+        scene.newWingedMesh (config, std::move (m));
+      }
+      for (const BinarySketch& s : sketches) {
+        SketchMesh& sketch = scene.newSketchMesh (config, s.tree);
+
+        for (const SketchPath& p : s.paths) {
+          sketch.addPath (p);
+        }
       }
       return true;
     }
@@ -293,7 +671,20 @@ namespace SceneUtil {
   }
 
   bool fromDlyFile (const std::string& fileName, const Config& config, Scene& scene) {
-    std::ifstream file (fileName);
+    std::ifstream file (fileName, std::ios::binary);
+    char          magic[4];
+
+    if (file.is_open () && file.read (magic, 4) && SceneUtil::isBinaryDlyFile (magic, 4)) {
+      file.close ();
+
+      const MappedFile mapped (fileName);
+
+      return mapped.data () != nullptr
+          && SceneUtil::fromBinaryDlyFile (mapped.data (), mapped.size (), config, scene);
+    }
+    file.close ();
+    file.clear ();
+    file.open  (fileName);
 
     if (file.is_open ()) {
       const bool success = SceneUtil::fromDlyFile (file, config, scene);
@@ -5,17 +5,25 @@
 #ifndef DILAY_SCENE_UTIL
 #define DILAY_SCENE_UTIL
 
+#include <cstddef>
 #include <iosfwd>
 #include <string>
 
 class Config;
 class Scene;
 
+/* Files ending in `.dlyb` are written in a chunked binary format, which is described
+ * in `scene-util.cpp`. When reading a file, its format is detected by its content.
+ */
 namespace SceneUtil {
-  void toDlyFile   (std::ostream&, const Scene&, bool);
-  bool toDlyFile   (const std::string&, const Scene&, bool);
-  bool fromDlyFile (std::istream&, const Config&, Scene&);
-  bool fromDlyFile (const std::string&, const Config&, Scene&);
+  void toDlyFile           (std::ostream&, const Scene&, bool);
+  bool toDlyFile           (const std::string&, const Scene&, bool);
+  bool fromDlyFile         (std::istream&, const Config&, Scene&);
+  bool fromDlyFile         (const std::string&, const Config&, Scene&);
+  void toBinaryDlyFile     (std::ostream&, const Scene&);
+  bool fromBinaryDlyFile   (const char*, std::size_t, const Config&, Scene&);
+  bool isBinaryDlyFile     (const char*, std::size_t);
+  bool isBinaryDlyFileName (const std::string&);
 };
 
 #endif
@@ -32,12 +32,19 @@ struct Scene :: Impl {
     this->commonRenderMode.smoothShading (true);
   }
 
-  WingedMesh& newWingedMesh (const Config& config, const Mesh& mesh) {
+  WingedMesh& newWingedMesh (const Config& config, Mesh mesh) {
+    return this->newWingedMesh (config, std::move (mesh), {}, {});
+  }
+
+  WingedMesh& newWingedMesh ( const Config& config, Mesh mesh
+                            , const std::vector <unsigned int>& freeVertices
+                            , const std::vector <unsigned int>& freeFaces )
+  {
     WingedMesh& wingedMesh = this->wingedMeshes.emplaceBack ();
 
-    wingedMesh.fromMesh (mesh);
-    wingedMesh.bufferData ();
+    wingedMesh.fromMesh (std::move (mesh), freeVertices, freeFaces);
     wingedMesh.renderMode () = this->commonRenderMode;
+    wingedMesh.bufferData ();
 
     this->runFromConfig (config, wingedMesh);
     return wingedMesh;
@@ -225,6 +232,18 @@ struct Scene :: Impl {
     this->setCommonRenderMode (this->commonRenderMode);
   }
 
+  bool packedVertices () const {
+    return this->commonRenderMode.packedVertices ();
+  }
+
+  void packedVertices (bool value) {
+    this->commonRenderMode.packedVertices (value);
+    this->setCommonRenderMode (this->commonRenderMode);
+    this->forEachMesh ([] (WingedMesh& mesh) {
+      mesh.bufferData ();
+    });
+  }
+
   bool isEmpty () const {
     return this->numWingedMeshes () == 0 && this->numSketchMeshes () == 0;
   }
@@ -288,6 +307,11 @@ struct Scene :: Impl {
   }
 
   void runFromConfig (const Config& config) {
+    const bool packed = config.get <int> ("editor/mesh/packedVertices") != 0;
+
+    if (packed != this->packedVertices ()) {
+      this->packedVertices (packed);
+    }
     this->forEachMesh ([this, &config] (WingedMesh& mesh) {
       this->runFromConfig (config, mesh);
     });
@@ -299,7 +323,8 @@ struct Scene :: Impl {
 
 DELEGATE1_BIG3_SELF (Scene, const Config&)
 
-DELEGATE2       (WingedMesh&       , Scene, newWingedMesh, const Config&, const Mesh&)
+DELEGATE2       (WingedMesh&       , Scene, newWingedMesh, const Config&, Mesh)
+DELEGATE4       (WingedMesh&       , Scene, newWingedMesh, const Config&, Mesh, const std::vector <unsigned int>&, const std::vector <unsigned int>&)
 DELEGATE2       (SketchMesh&       , Scene, newSketchMesh, const Config&, const SketchTree&)
 DELEGATE1       (void              , Scene, deleteMesh, WingedMesh&)
 DELEGATE1       (void              , Scene, deleteMesh, SketchMesh&)
@@ -327,6 +352,8 @@ DELEGATE_CONST  (bool              , Scene, renderWireframe)
 DELEGATE1       (void              , Scene, renderWireframe, bool)
 DELEGATE        (void              , Scene, toggleWireframe)
 DELEGATE        (void              , Scene, toggleShading)
+DELEGATE_CONST  (bool              , Scene, packedVertices)
+DELEGATE1       (void              , Scene, packedVertices, bool)
 DELEGATE_CONST  (bool              , Scene, isEmpty)
 DELEGATE_CONST  (unsigned int      , Scene, numWingedMeshes)
 DELEGATE_CONST  (unsigned int      , Scene, numSketchMeshes)
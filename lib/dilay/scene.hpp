@@ -8,6 +8,7 @@
 #include "globals.hpp"
 
 #include <string>
+#include <vector>
 #include "configurable.hpp"
 #include "macro.hpp"
 #include "sketch/fwd.hpp"
@@ -24,7 +25,10 @@ class DILAY_LIB_EXPORT Scene : public Configurable {
   public: 
     DECLARE_BIG3 (Scene, const Config&)
 
-    WingedMesh&        newWingedMesh      (const Config&, const Mesh&);
+    WingedMesh&        newWingedMesh      (const Config&, Mesh);
+    WingedMesh&        newWingedMesh      ( const Config&, Mesh
+                                          , const std::vector <unsigned int>&
+                                          , const std::vector <unsigned int>& );
     SketchMesh&        newSketchMesh      (const Config&, const SketchTree&);
     void               deleteMesh         (WingedMesh&);
     void               deleteMesh         (SketchMesh&);
@@ -52,6 +56,8 @@ class DILAY_LIB_EXPORT Scene : public Configurable {
     void               renderWireframe    (bool);
     void               toggleWireframe    ();
     void               toggleShading      ();
+    bool               packedVertices     () const;
+    void               packedVertices     (bool);
     bool               isEmpty            () const;
     unsigned int       numWingedMeshes    () const;
     unsigned int       numSketchMeshes    () const;
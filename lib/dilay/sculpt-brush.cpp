@@ -3,8 +3,11 @@
  * Use and redistribute under the terms of the GNU General Public License
  */
 #include <glm/gtx/norm.hpp>
+#include <vector>
 #include "affected-faces.hpp"
+#include "falloff.hpp"
 #include "intersection.hpp"
+#include "parallel.hpp"
 #include "primitive/plane.hpp"
 #include "primitive/sphere.hpp"
 #include "sculpt-brush.hpp"
@@ -14,6 +17,10 @@
 #include "winged/vertex.hpp"
 #include "variant.hpp"
 
+namespace {
+  const unsigned int minVerticesPerThread = 2048;
+}
+
 SBIntensityParameters :: SBIntensityParameters ()
   : _intensity (0.0f)
 {}
@@ -46,6 +53,7 @@ struct SculptBrush :: Impl {
   float         detailFactor;
   float         stepWidthFactor;
   bool          subdivide;
+  unsigned int  numThreads;
   WingedMesh*   mesh;
   bool          hasPosition;
   glm::vec3    _lastPosition;
@@ -66,6 +74,7 @@ struct SculptBrush :: Impl {
     , detailFactor    (0.0f)
     , stepWidthFactor (0.0f)
     , subdivide       (false)
+    , numThreads      (0)
     , hasPosition     (false)
   {}
 
@@ -83,6 +92,54 @@ struct SculptBrush :: Impl {
       );
   }
 
+  /* `displace (mesh, vs, fo, c, i, f)` computes new positions of all vertices `vs` in
+   * parallel, where `f (v, oldPos, factor, newPos)` returns `false` if `v` should not be
+   * moved and `factor` is the falloff `fo` at `oldPos` with respect to center `c`,
+   * inner radius `i` and the radius of the brush.
+   * Positions are gathered into separate coordinate arrays, such that falloffs can be
+   * evaluated in batches.
+   * Since `f` only reads old positions and new positions are written afterwards,
+   * the result does not depend on the number of threads.
+   */
+  template <typename F>
+  void displace ( WingedMesh& mesh, const VertexPtrSet& vertexSet, Falloff::Function falloff
+                , const glm::vec3& center, float innerRadius, const F& f ) const
+  {
+    const std::vector <WingedVertex*> vertices    (vertexSet.begin (), vertexSet.end ());
+    const unsigned int                n           (vertices.size ());
+    std::vector <float>               xs          (n);
+    std::vector <float>               ys          (n);
+    std::vector <float>               zs          (n);
+    std::vector <float>               factors     (n);
+    std::vector <glm::vec3>           newPos      (n);
+    std::vector <char>                isDisplaced (n);
+    const WingedMesh&                 constMesh   (mesh);
+
+    Parallel::forChunks ( n, this->numThreads, minVerticesPerThread
+                        , [&] (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        const glm::vec3 p = vertices[i]->position (constMesh);
+        xs[i] = p.x;
+        ys[i] = p.y;
+        zs[i] = p.z;
+      }
+      Falloff::evaluate ( falloff, &xs[begin], &ys[begin], &zs[begin], end - begin
+                        , center, innerRadius, this->radius, &factors[begin] );
+
+      for (unsigned int i = begin; i < end; i++) {
+        const glm::vec3 oldPos (xs[i], ys[i], zs[i]);
+        isDisplaced[i] = f (*vertices[i], oldPos, factors[i], newPos[i]);
+      }
+    });
+
+    for (unsigned int i = 0; i < n; i++) {
+      if (isDisplaced[i]) {
+        vertices[i]->writePosition (mesh, newPos[i]);
+      }
+    }
+  }
+
   void sculpt (const SBCarveParameters& parameters, AffectedFaces& faces) const {
     PrimSphere  sphere (this->position (), this->radius);
     WingedMesh& mesh   (this->self->meshRef ());
@@ -97,19 +154,18 @@ struct SculptBrush :: Impl {
                              ? glm::vec3 (0.0f)
                              : parameters.invert (WingedUtil::averageNormal (mesh, vertices)) );
 
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos    = v->position (mesh);
+      this->displace ( mesh, vertices, Falloff::Function::SmoothStep, this->position (), 0.0f
+                     , [this, &parameters, &mesh, &avgDir]
+        (const WingedVertex& v, const glm::vec3& oldPos, float falloff, glm::vec3& newPos)
+      {
         const float     intensity = parameters.intensity () * this->radius;
-        const float     factor    = intensity
-                                  * Util::smoothStep ( oldPos, this->position ()
-                                                     , 0.0f, this->radius );
+        const float     factor    = intensity * falloff;
         const glm::vec3 direction = parameters.inflate ()
-                                  ? parameters.invert (v->savedNormal (mesh))
+                                  ? parameters.invert (v.savedNormal (mesh))
                                   : avgDir;
-        const glm::vec3 newPos    = oldPos + (factor * direction);
-
-        v->writePosition (mesh, newPos);
-      }
+        newPos = oldPos + (factor * direction);
+        return true;
+      });
     }
   }
 
@@ -126,18 +182,17 @@ struct SculptBrush :: Impl {
     if (faces.isEmpty () == false) {
       VertexPtrSet vertices (faces.toVertexSet ());
 
-      float (*stepFunction) (const glm::vec3&, const glm::vec3&, float, float) =
-        parameters.linearStep () ? Util::linearStep : Util::smoothStep;
-
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos      = v->position (mesh);
-        const float     innerRadius = (1.0f - parameters.smoothness ()) * this->radius;
-        const float     factor      = stepFunction ( oldPos, this->lastPosition ()
-                                                   , innerRadius, this->radius );
-        const glm::vec3 newPos      = oldPos + (factor * this->direction ());
+      const Falloff::Function stepFunction = parameters.linearStep ()
+                                           ? Falloff::Function::LinearStep
+                                           : Falloff::Function::SmoothStep;
+      const float             innerRadius  = (1.0f - parameters.smoothness ()) * this->radius;
 
-        v->writePosition (mesh, newPos);
-      }
+      this->displace ( mesh, vertices, stepFunction, this->lastPosition (), innerRadius
+                     , [this] (const WingedVertex&, const glm::vec3& oldPos, float factor, glm::vec3& newPos)
+      {
+        newPos = oldPos + (factor * this->direction ());
+        return true;
+      });
     }
   }
 
@@ -148,6 +203,10 @@ struct SculptBrush :: Impl {
     mesh .intersects (sphere, faces);
     faces.discardBackfaces (mesh, this->direction ());
 
+    /* Vertices are smoothed one after another and in place, i.e. the center of a vertex
+     * includes neighbours that have already been smoothed. Since `displace` only reads
+     * old positions, it would smooth less per dab.
+     */
     if (faces.isEmpty () == false && parameters.relaxOnly () == false) {
       VertexPtrSet vertices (faces.toVertexSet ());
 
@@ -175,16 +234,16 @@ struct SculptBrush :: Impl {
       const glm::vec3 normal   (WingedUtil::averageNormal (mesh, vertices));
       const PrimPlane plane    (WingedUtil::center (mesh, vertices), normal);
 
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos   = v->position (mesh);
-        const float     factor   = parameters.intensity ()
-                                 * Util::linearStep ( oldPos, this->position ()
-                                                    , 0.0f, this->radius );
-        const float     distance = glm::max (0.0f, plane.distance (oldPos));
-        const glm::vec3 newPos   = oldPos - (normal * factor * distance);
+      this->displace ( mesh, vertices, Falloff::Function::LinearStep, this->position (), 0.0f
+                     , [&parameters, &normal, &plane]
+        (const WingedVertex&, const glm::vec3& oldPos, float falloff, glm::vec3& newPos)
+      {
+        const float factor   = parameters.intensity () * falloff;
+        const float distance = glm::max (0.0f, plane.distance (oldPos));
 
-        v->writePosition (mesh, newPos);
-      }
+        newPos = oldPos - (normal * factor * distance);
+        return true;
+      });
     }
   }
 
@@ -202,21 +261,26 @@ struct SculptBrush :: Impl {
       const glm::vec3 refPos   (this->position () + (avgDir * parameters.intensity () * this->radius));
       const PrimPlane plane    (refPos, avgDir);
 
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos   = v->position (mesh);
+      /* The in-plane distance is computed from the projection of a vertex rather than
+       * from the batched distance to `refPos`, which would cancel near the brush axis.
+       */
+      this->displace ( mesh, vertices, Falloff::Function::Distance, refPos, 0.0f
+                     , [this, &refPos, &plane]
+        (const WingedVertex&, const glm::vec3& oldPos, float, glm::vec3& newPos)
+      {
         const glm::vec3 projPos  = plane.project (oldPos);
         const float     distance = glm::distance (projPos, refPos);
 
-        if (glm::distance (projPos, refPos) > 0.001f) {
+        if (distance > 0.001f) {
           const float     relDistance = glm::clamp (distance / this->radius, 0.0f, 1.0f);
           const float     factor      = 0.1f * this->radius * glm::min (0.5f, 1.0f - relDistance);
           const glm::vec3 direction   = glm::normalize ( (projPos - oldPos)
                                                        + (2.0f * (refPos - projPos)) );
-          const glm::vec3 newPos      = oldPos + (factor * direction);
-
-          v->writePosition (mesh, newPos);
+          newPos = oldPos + (factor * direction);
+          return true;
         }
-      }
+        return false;
+      });
     }
   }
 
@@ -231,19 +295,20 @@ struct SculptBrush :: Impl {
     if (faces.isEmpty () == false) {
       VertexPtrSet    vertices (faces.toVertexSet ());
 
-      for (WingedVertex* v : vertices) {
-        const glm::vec3 oldPos   = v->position (mesh);
-        const float     distance = glm::distance (oldPos, this->position ());
-
+      this->displace ( mesh, vertices, Falloff::Function::Distance, this->position (), 0.0f
+                     , [this, &parameters]
+        (const WingedVertex&, const glm::vec3& oldPos, float distance, glm::vec3& newPos)
+      {
         if (distance > 0.001f) {
           const float     relDistance = glm::clamp (distance / this->radius, 0.0f, 1.0f);
           const float     factor      = 0.1f * this->radius * glm::min (0.5f, 1.0f - relDistance);
           const glm::vec3 direction   = parameters.invert (glm::normalize (this->position () - oldPos));
-          const glm::vec3 newPos      = oldPos + (factor * direction);
 
-          v->writePosition (mesh, newPos);
+          newPos = oldPos + (factor * direction);
+          return true;
         }
-      }
+        return false;
+      });
     }
   }
 
@@ -279,6 +344,10 @@ struct SculptBrush :: Impl {
     return (1.0f - this->detailFactor) * this->radius;
   }
 
+  float stepWidth () const {
+    return this->stepWidthFactor * glm::log (this->self->radius () + 1);
+  }
+
   const glm::vec3& lastPosition () const {
     assert (this->hasPosition);
     return this->_lastPosition;
@@ -308,7 +377,7 @@ struct SculptBrush :: Impl {
 
   bool updatePointOfAction (const glm::vec3& p, const glm::vec3& d) {
     if (this->hasPosition) {
-      const float stepWidth = this->stepWidthFactor * glm::log (this->self->radius () + 1);
+      const float stepWidth = this->stepWidth ();
 
       if (glm::distance2 (p, this->_position) > stepWidth * stepWidth) {
         this->_lastPosition = this->_position;
@@ -350,15 +419,18 @@ GETTER_CONST    (float            , SculptBrush, radius)
 GETTER_CONST    (float            , SculptBrush, detailFactor)
 GETTER_CONST    (float            , SculptBrush, stepWidthFactor)
 GETTER_CONST    (bool             , SculptBrush, subdivide)
+GETTER_CONST    (unsigned int     , SculptBrush, numThreads)
 GETTER_CONST    (WingedMesh*      , SculptBrush, mesh)
 DELEGATE_CONST  (float            , SculptBrush, intensity)
 SETTER          (float            , SculptBrush, radius)
 SETTER          (float            , SculptBrush, detailFactor)
 SETTER          (float            , SculptBrush, stepWidthFactor)
 SETTER          (bool             , SculptBrush, subdivide)
+SETTER          (unsigned int     , SculptBrush, numThreads)
 SETTER          (WingedMesh*      , SculptBrush, mesh)
 DELEGATE1       (void             , SculptBrush, intensity, float)
 DELEGATE_CONST  (float            , SculptBrush, subdivThreshold)
+DELEGATE_CONST  (float            , SculptBrush, stepWidth)
 GETTER_CONST    (bool             , SculptBrush, hasPosition)
 DELEGATE_CONST  (const glm::vec3& , SculptBrush, lastPosition)
 DELEGATE_CONST  (const glm::vec3& , SculptBrush, position)
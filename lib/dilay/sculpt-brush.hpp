@@ -94,6 +94,7 @@ class SculptBrush {
     float            detailFactor        () const;
     float            stepWidthFactor     () const;
     bool             subdivide           () const;
+    unsigned int     numThreads          () const;
     WingedMesh*      mesh                () const;
     float            intensity           () const;
 
@@ -101,10 +102,12 @@ class SculptBrush {
     void             detailFactor        (float);
     void             stepWidthFactor     (float);
     void             subdivide           (bool);
+    void             numThreads          (unsigned int);
     void             mesh                (WingedMesh*);
     void             intensity           (float);
 
     float            subdivThreshold     () const;
+    float            stepWidth           () const;
     bool             hasPosition         () const;
     const glm::vec3& lastPosition        () const;
     const glm::vec3& position            () const;
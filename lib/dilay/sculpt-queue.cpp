@@ -0,0 +1,160 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "action/sculpt.hpp"
+#include "affected-faces.hpp"
+#include "primitive/plane.hpp"
+#include "sculpt-brush.hpp"
+#include "sculpt-queue.hpp"
+#include "sculpt-worker.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Frame {
+    WingedMesh*       mesh;
+    Clock::time_point posted;
+  };
+}
+
+/* `domain` and `finishedFrames` are only accessed by worker commands or inside of
+ * `worker.exclusive`, all other members are only accessed by the posting thread.
+ */
+struct SculptQueue::Impl {
+  SculptWorker        worker;
+  AffectedFaces       domain;
+  std::vector <Frame> finishedFrames;
+  bool                dabsPending;
+  SculptBrush         pendingBrush;
+  Clock::time_point   pendingPosted;
+  unsigned int        numFrames;
+  float               sumLatency;
+  float               maxLatency;
+
+  Impl ()
+    : dabsPending (false)
+  {
+    this->resetLatency ();
+  }
+
+  // dabs of different meshes are finalized separately
+  void beginDab (const SculptBrush& brush) {
+    if (this->dabsPending && this->pendingBrush.mesh () != brush.mesh ()) {
+      this->postFinalize ();
+    }
+    if (this->dabsPending == false) {
+      this->dabsPending   = true;
+      this->pendingPosted = Clock::now ();
+    }
+    this->pendingBrush = brush;
+  }
+
+  void dab (const SculptBrush& brush) {
+    this->beginDab (brush);
+    this->worker.post ([this, brush] () {
+      Action::sculptDab (brush, this->domain);
+    });
+  }
+
+  void mirroredDab (const SculptBrush& brush, const PrimPlane& plane) {
+    this->beginDab (brush);
+    this->worker.post ([this, brush, plane] () {
+      Action::sculptMirroredDab (brush, plane, this->domain);
+    });
+  }
+
+  void exclusive (const std::function <void ()>& f) {
+    this->worker.exclusive (f);
+  }
+
+  void postFinalize () {
+    if (this->dabsPending) {
+      const SculptBrush       brush  (this->pendingBrush);
+      const Clock::time_point posted (this->pendingPosted);
+
+      this->worker.post ([this, brush, posted] () {
+        if (Action::remeshSculpt (brush, this->domain)) {
+          this->finishedFrames.push_back (Frame {brush.mesh (), posted});
+        }
+        this->domain.reset ();
+      });
+      this->dabsPending = false;
+    }
+  }
+
+  // must be called inside of `worker.exclusive`
+  bool upload () {
+    if (this->finishedFrames.empty ()) {
+      return false;
+    }
+    else {
+      const Clock::time_point now = Clock::now ();
+
+      for (const Frame& frame : this->finishedFrames) {
+        frame.mesh->bufferData ();
+
+        const float latency = std::chrono::duration <float, std::milli> (now - frame.posted).count ();
+
+        this->numFrames++;
+        this->sumLatency += latency;
+        this->maxLatency  = std::max (this->maxLatency, latency);
+      }
+      this->finishedFrames.clear ();
+      return true;
+    }
+  }
+
+  bool update () {
+    bool uploaded = false;
+
+    this->worker.tryExclusive ([this, &uploaded] () {
+      uploaded = this->upload ();
+    });
+    this->postFinalize ();
+    return uploaded;
+  }
+
+  void finish () {
+    this->postFinalize ();
+    this->worker.finish ();
+    this->worker.exclusive ([this] () {
+      this->upload ();
+    });
+  }
+
+  // no command is executed if the worker is idle, i.e. `finishedFrames` can be read
+  bool isIdle () const {
+    return this->dabsPending == false && this->worker.isIdle () && this->finishedFrames.empty ();
+  }
+
+  unsigned int numUploadedFrames () const {
+    return this->numFrames;
+  }
+
+  float meanLatency () const {
+    return this->numFrames > 0 ? this->sumLatency / float (this->numFrames) : 0.0f;
+  }
+
+  void resetLatency () {
+    this->numFrames  = 0;
+    this->sumLatency = 0.0f;
+    this->maxLatency = 0.0f;
+  }
+};
+
+DELEGATE_BIG2 (SculptQueue)
+DELEGATE1       (void        , SculptQueue, dab, const SculptBrush&)
+DELEGATE2       (void        , SculptQueue, mirroredDab, const SculptBrush&, const PrimPlane&)
+DELEGATE1       (void        , SculptQueue, exclusive, const std::function <void ()>&)
+DELEGATE        (bool        , SculptQueue, update)
+DELEGATE        (void        , SculptQueue, finish)
+DELEGATE_CONST  (bool        , SculptQueue, isIdle)
+DELEGATE_CONST  (unsigned int, SculptQueue, numUploadedFrames)
+DELEGATE_CONST  (float       , SculptQueue, meanLatency)
+GETTER_CONST    (float       , SculptQueue, maxLatency)
+DELEGATE        (void        , SculptQueue, resetLatency)
@@ -0,0 +1,46 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SCULPT_QUEUE
+#define DILAY_SCULPT_QUEUE
+
+#include <functional>
+#include "macro.hpp"
+
+class PrimPlane;
+class SculptBrush;
+
+/* `SculptQueue` sculpts dabs on a `SculptWorker`, which owns all modifications of the
+ * meshes of posted brushes until `finish` has been called.
+ * `update` is called once per frame by the thread that owns the OpenGL context: it posts
+ * a command that remeshes and recomputes normals of all dabs posted since the previous
+ * frame, and uploads meshes that have been finished by the worker meanwhile, i.e. the
+ * worker's mesh data serves as back buffer, while the uploaded buffers are displayed.
+ * `update` never blocks: if the worker is busy, finished meshes are uploaded by a
+ * subsequent call.
+ * `exclusive (f)` calls `f` while the worker does not modify any mesh.
+ * `finish` blocks until all dabs have been finalized and uploaded.
+ * The latency is the time from posting the first dab of a frame until its upload.
+ * Pending dabs are sculpted but not finalized before the queue is destroyed.
+ */
+class SculptQueue {
+  public:
+    DECLARE_BIG2 (SculptQueue)
+
+    void         dab               (const SculptBrush&);
+    void         mirroredDab       (const SculptBrush&, const PrimPlane&);
+    void         exclusive         (const std::function <void ()>&);
+    bool         update            ();
+    void         finish            ();
+    bool         isIdle            () const;
+    unsigned int numUploadedFrames () const;
+    float        meanLatency       () const;
+    float        maxLatency        () const;
+    void         resetLatency      ();
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
@@ -0,0 +1,167 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "sculpt-worker.hpp"
+
+struct SculptWorker::Impl {
+  typedef std::function <void ()> Command;
+
+  mutable std::mutex            queueMutex;
+  std::condition_variable       queueChanged;
+  std::deque <Command>          queue;
+  bool                          busy;
+  bool                          stop;
+  std::mutex                    executionMutex;
+  std::atomic <std::thread::id> exclusiveThread;
+  std::thread                   thread;
+
+  Impl ()
+    : busy (false)
+    , stop (false)
+  {}
+
+  ~Impl () {
+    if (this->thread.joinable ()) {
+      {
+        std::lock_guard <std::mutex> lock (this->queueMutex);
+        this->stop = true;
+      }
+      this->queueChanged.notify_all ();
+      this->thread.join ();
+    }
+  }
+
+  void post (const Command& command) {
+    {
+      std::lock_guard <std::mutex> lock (this->queueMutex);
+      this->queue.push_back (command);
+    }
+    if (this->thread.joinable () == false) {
+      this->thread = std::thread ([this] () { this->run (); });
+    }
+    this->queueChanged.notify_all ();
+  }
+
+  void exclusive (const Command& f) {
+    if (this->exclusiveThread == std::this_thread::get_id ()) {
+      f ();
+    }
+    else {
+      std::lock_guard <std::mutex> lock (this->executionMutex);
+      this->exclusiveThread = std::this_thread::get_id ();
+      f ();
+      this->exclusiveThread = std::thread::id ();
+    }
+  }
+
+  bool tryExclusive (const Command& f) {
+    if (this->exclusiveThread == std::this_thread::get_id ()) {
+      f ();
+      return true;
+    }
+    else {
+      std::unique_lock <std::mutex> lock (this->executionMutex, std::try_to_lock);
+
+      if (lock.owns_lock ()) {
+        this->exclusiveThread = std::this_thread::get_id ();
+        f ();
+        this->exclusiveThread = std::thread::id ();
+        return true;
+      }
+      else {
+        return false;
+      }
+    }
+  }
+
+  // Inside of `exclusive` the worker can not execute commands, so they are executed
+  // by the calling thread instead.
+  void finish () {
+    if (this->exclusiveThread == std::this_thread::get_id ()) {
+      Command command;
+      while (this->pop (command)) {
+        command ();
+      }
+      this->queueChanged.notify_all ();
+    }
+    else {
+      std::unique_lock <std::mutex> lock (this->queueMutex);
+      this->queueChanged.wait (lock, [this] () {
+        return this->queue.empty () && this->busy == false;
+      });
+    }
+  }
+
+  bool isIdle () const {
+    std::lock_guard <std::mutex> lock (this->queueMutex);
+    return this->queue.empty () && this->busy == false;
+  }
+
+  unsigned int numPending () const {
+    std::lock_guard <std::mutex> lock (this->queueMutex);
+    return this->queue.size () + (this->busy ? 1 : 0);
+  }
+
+  bool pop (Command& command) {
+    std::lock_guard <std::mutex> lock (this->queueMutex);
+
+    if (this->queue.empty ()) {
+      return false;
+    }
+    else {
+      command = std::move (this->queue.front ());
+      this->queue.pop_front ();
+      return true;
+    }
+  }
+
+  // Commands are popped while holding `executionMutex`, i.e. `busy` does not hold
+  // while a thread is inside of `exclusive`.
+  void run () {
+    for (;;) {
+      {
+        std::unique_lock <std::mutex> lock (this->queueMutex);
+        this->queueChanged.wait (lock, [this] () {
+          return this->stop || this->queue.empty () == false;
+        });
+        if (this->stop && this->queue.empty ()) {
+          return;
+        }
+      }
+      {
+        std::lock_guard <std::mutex> executionLock (this->executionMutex);
+        Command                      command;
+        {
+          std::lock_guard <std::mutex> lock (this->queueMutex);
+
+          if (this->queue.empty ()) {
+            continue;
+          }
+          command = std::move (this->queue.front ());
+          this->queue.pop_front ();
+          this->busy = true;
+        }
+        command ();
+        {
+          std::lock_guard <std::mutex> lock (this->queueMutex);
+          this->busy = false;
+        }
+      }
+      this->queueChanged.notify_all ();
+    }
+  }
+};
+
+DELEGATE_BIG2 (SculptWorker)
+DELEGATE1       (void        , SculptWorker, post, const std::function <void ()>&)
+DELEGATE1       (void        , SculptWorker, exclusive, const std::function <void ()>&)
+DELEGATE1       (bool        , SculptWorker, tryExclusive, const std::function <void ()>&)
+DELEGATE        (void        , SculptWorker, finish)
+DELEGATE_CONST  (bool        , SculptWorker, isIdle)
+DELEGATE_CONST  (unsigned int, SculptWorker, numPending)
@@ -0,0 +1,36 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SCULPT_WORKER
+#define DILAY_SCULPT_WORKER
+
+#include <functional>
+#include "macro.hpp"
+
+/* `SculptWorker` executes posted commands in posting order on a background thread,
+ * which is started by the first call to `post`.
+ * `exclusive (f)` calls `f` on the calling thread while no command is executed, i.e.
+ * meshes that are modified by commands may be read or modified by `f`.
+ * `tryExclusive (f)` calls `f` like `exclusive` if no command is executed at the moment,
+ * i.e. it never blocks, and returns whether `f` has been called.
+ * `finish` blocks until all posted commands have been executed, inside of `exclusive`
+ * it executes them on the calling thread.
+ * Pending commands are executed before the worker is destroyed.
+ */
+class SculptWorker {
+  public:
+    DECLARE_BIG2 (SculptWorker)
+
+    void         post         (const std::function <void ()>&);
+    void         exclusive    (const std::function <void ()>&);
+    bool         tryExclusive (const std::function <void ()>&);
+    void         finish       ();
+    bool         isIdle       () const;
+    unsigned int numPending   () const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
@@ -2,17 +2,18 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
-#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "../mesh.hpp"
-#include "distance.hpp"
 #include "mesh-util.hpp"
-#include "primitive/cone-sphere.hpp"
+#include "parallel.hpp"
 #include "sketch/conversion.hpp"
 #include "sketch/mesh.hpp"
-#include "sketch/path.hpp"
+#include "sketch/primitives.hpp"
 #include "util.hpp"
 
 /* vertex layout:          edge layout:          face layout:
@@ -30,8 +31,6 @@
  * 4------------5          o-----6------o
  */
 namespace {
-  static glm::vec3 invalidVec3 = glm::vec3 (std::numeric_limits <float>::lowest ());
-
   static int edgeVertexIndices[256][12] = {
       {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}
     , {0,0,0,-1,-1,-1,-1,-1,-1,-1,-1,-1}
@@ -323,47 +322,49 @@ namespace {
     }
   }
 
+  /* A cube stores its configuration and the index of the first mesh vertex of its
+   * vertex instances, which are stored consecutively.
+   */
   struct Cube {
-    unsigned int               configuration;
-    glm::vec3                  vertex;
-    std::vector <unsigned int> vertexInstanceIndices;
-    bool                       collapseWhenAmbiguous;
+    unsigned char configuration;
+    bool          collapseWhenAmbiguous;
+    unsigned int  firstVertex;
 
     Cube ()
-      : configuration         (Util::invalidIndex ())  
-      , vertex                (invalidVec3)
+      : configuration         (0)
       , collapseWhenAmbiguous (false)
+      , firstVertex           (Util::invalidIndex ())
     {}
 
-    void initializeVertexInstanceIndices () {
-      assert (this->configuration <= 255);
-
-      int n = -1;
-      for (unsigned int i = 0; i < 12; i++) {
-        n = glm::max (n, edgeVertexIndices[this->configuration][i]);
+    unsigned int numVertexInstances () const {
+      if (this->collapseWhenAmbiguous) {
+        return 1;
+      }
+      else {
+        int n = -1;
+        for (unsigned int i = 0; i < 12; i++) {
+          n = glm::max (n, edgeVertexIndices[this->configuration][i]);
+        }
+        return (unsigned int) (n + 1);
       }
-      this->vertexInstanceIndices.resize (n+1, Util::invalidIndex ());
     }
 
     unsigned int vertexInstanceIndex (unsigned int edge) const {
       assert (edge <= 11);
-      assert (this->configuration <= 255);
       assert (edgeVertexIndices[this->configuration][edge] >= 0);
       assert (this->collapseWhenAmbiguous == false || this->isAmbiguous ());
+      assert (this->firstVertex != Util::invalidIndex ());
 
       const unsigned int i = this->collapseWhenAmbiguous
                            ? 0
                            : (unsigned int) edgeVertexIndices[this->configuration][edge];
 
-      assert (i < this->vertexInstanceIndices.size ());
-
-      return this->vertexInstanceIndices.at (i);
+      return this->firstVertex + i;
     }
 
     bool hasAmbiguousFace ( unsigned int edge1, unsigned int edge2, unsigned int edge3
                           , unsigned int edge4 ) const
     {
-      assert (this->configuration <= 255);
       assert (edge1 <= 11);
       assert (edge2 <= 11);
       assert (edge3 <= 11);
@@ -410,8 +411,6 @@ namespace {
     }
 
     bool isAmbiguous () const {
-      assert (this->configuration <= 255);
-
       switch (Util::countOnes (this->configuration)) {
         case  5: return this->hasAmbiguousFaces ();
         case  6: return this->hasAmbiguousFaces ();
@@ -420,18 +419,32 @@ namespace {
     }
   };
 
+  /* Samples are grouped into blocks of `blockSize^3` samples.
+   * Only blocks near the surface (band blocks) store their samples, all other blocks are
+   * either completely outside or completely inside of the sketch.
+   */
+  const unsigned int blockSize    = 8;
+  const unsigned int blockVolume  = blockSize * blockSize * blockSize;
+  const unsigned int outsideBlock = Util::invalidIndex ();
+  const unsigned int insideBlock  = Util::invalidIndex () - 1;
+
   struct Parameters {
-    float               resolution;
-    glm::vec3           sampleOrigin;
-    glm::uvec3          numSamples;
-    std::vector <float> samples;
-    glm::uvec3          numCubes;
-    std::vector <Cube>  grid;
+    float                      resolution;
+    float                      band;
+    glm::vec3                  sampleOrigin;
+    glm::uvec3                 numSamples;
+    glm::uvec3                 numBlocks;
+    std::vector <unsigned int> blocks;
+    std::vector <float>        blockSamples;
+    glm::uvec3                 numCubes;
+    std::vector <Cube>         grid;
 
     Parameters ()
       : resolution   (0.0f)
+      , band         (0.0f)
       , sampleOrigin (glm::vec3 (0.0f))
       , numSamples   (glm::uvec3 (0))
+      , numBlocks    (glm::uvec3 (0))
     {}
 
     glm::vec3 samplePos (unsigned int x, unsigned int y, unsigned int z) const {
@@ -443,45 +456,44 @@ namespace {
                             * glm::vec3 (float (x), float (y), float (z)) );
     }
 
-    glm::vec3 samplePos (unsigned int i) const {
-      const std::div_t divZ = std::div (int (i), int (this->numSamples.x * this->numSamples.y));
-      const std::div_t divY = std::div (divZ.rem, int (this->numSamples.x));
+    unsigned int cubeIndex (unsigned int x, unsigned int y, unsigned int z) const {
+      return (z * this->numCubes.x * this->numCubes.y) + (y * this->numCubes.x) + x;
+    }
 
-      return this->samplePos ( (unsigned int) (divY.rem)
-                             , (unsigned int) (divY.quot)
-                             , (unsigned int) (divZ.quot) );
+    unsigned int blockIndex (unsigned int x, unsigned int y, unsigned int z) const {
+      return (z * this->numBlocks.x * this->numBlocks.y) + (y * this->numBlocks.x) + x;
     }
 
-    unsigned int sampleIndex (unsigned int x, unsigned int y, unsigned int z) const {
-      return (z * this->numSamples.x * this->numSamples.y) + (y * this->numSamples.x) + x;
+    unsigned int blockOf (unsigned int x, unsigned int y, unsigned int z) const {
+      return this->blocks[this->blockIndex (x / blockSize, y / blockSize, z / blockSize)];
     }
 
-    unsigned int sampleIndex (unsigned int cubeIndex, unsigned int vertex) const {
-      assert (vertex < 8);
+    float sample (unsigned int x, unsigned int y, unsigned int z) const {
+      assert (x < (unsigned int) this->numSamples.x);
+      assert (y < (unsigned int) this->numSamples.y);
+      assert (z < (unsigned int) this->numSamples.z);
 
-      const std::div_t   divZ = std::div ( int (cubeIndex)
-                                         , int (this->numCubes.x * this->numCubes.y));
-      const std::div_t   divY = std::div (divZ.rem, int (this->numCubes.x));
-      const unsigned int x    = (unsigned int) (divY.rem);
-      const unsigned int y    = (unsigned int) (divY.quot);
-      const unsigned int z    = (unsigned int) (divZ.quot);
+      const unsigned int block = this->blockOf (x, y, z);
 
-      switch (vertex) {
-        case 0 : return this->sampleIndex (x  , y  , z  );
-        case 1 : return this->sampleIndex (x+1, y  , z  );
-        case 2 : return this->sampleIndex (x  , y+1, z  );
-        case 3 : return this->sampleIndex (x+1, y+1, z  );
-        case 4 : return this->sampleIndex (x  , y  , z+1);
-        case 5 : return this->sampleIndex (x+1, y  , z+1);
-        case 6 : return this->sampleIndex (x  , y+1, z+1);
-        case 7 : return this->sampleIndex (x+1, y+1, z+1);
-        default: DILAY_IMPOSSIBLE
+      if (block == outsideBlock) {
+        return this->band;
+      }
+      else if (block == insideBlock) {
+        return -this->band;
+      }
+      else {
+        return this->blockSamples[ (block * blockVolume)
+                                 + ((z % blockSize) * blockSize * blockSize)
+                                 + ((y % blockSize) * blockSize)
+                                 +  (x % blockSize) ];
       }
     }
+  };
 
-    unsigned int cubeIndex (unsigned int x, unsigned int y, unsigned int z) const {
-      return (z * this->numCubes.x * this->numCubes.y) + (y * this->numCubes.x) + x;
-    }
+  struct BandBlock {
+    unsigned int               index;
+    glm::uvec3                 position;
+    std::vector <unsigned int> primitives;
   };
 
   void setupSampling (const SketchMesh& mesh, Parameters& params) {
@@ -493,167 +505,258 @@ namespace {
 
     params.sampleOrigin = min;
     params.numSamples   = glm::vec3 (1.0f) + glm::ceil ((max - min) / glm::vec3 (params.resolution));
+    params.numBlocks    = (params.numSamples + glm::uvec3 (blockSize - 1)) / blockSize;
+    params.band         = 2.0f * params.resolution;
   }
 
-  float sampleAt (const SketchMesh& mesh, const glm::vec3& pos) {
-    float distance = std::numeric_limits <float>::max ();
-      
-    if (mesh.tree ().hasRoot ()) {
-      mesh.tree ().root ().forEachConstNode ([&pos, &distance] (const SketchNode& node) {
-        const float d = node.parent ()
-                      ? Distance::distance ( PrimConeSphere ( node.data ()
-                                                            , node.parent ()->data () )
-                                           , pos )
-                      : Distance::distance (node.data (), pos);
-
-        distance = glm::min (distance, d);
-      });
+  /* Distances of sketch primitives are (at least approximately) 1-Lipschitz, i.e. the
+   * distance `D` at the center of a node bounds the distance of all its samples by
+   * `D +/- h`, where `h` is the half diagonal of the node.
+   * Nodes that are farther than `band` from the surface are classified as outside or
+   * inside.
+   * Only primitives within `D + 2h` of the center of a band block can be the closest
+   * primitive of any of its samples, thus, only these are evaluated per sample.
+   * Edges that are crossed by the surface only have samples within `resolution` of the
+   * surface, thus, all samples that are used for surface extraction are stored in band
+   * blocks.
+   */
+  void classifyNode ( const SketchPrimitives& primitives, Parameters& params
+                    , const glm::uvec3& begin, const glm::uvec3& end
+                    , std::vector <BandBlock>& bandBlocks )
+  {
+    const glm::uvec3 lastSample = glm::min (end * blockSize, params.numSamples) - glm::uvec3 (1);
+    const glm::vec3  min        = params.samplePos (begin.x * blockSize, begin.y * blockSize
+                                                   , begin.z * blockSize);
+    const glm::vec3  max        = params.samplePos (lastSample.x, lastSample.y, lastSample.z);
+    const glm::vec3  center     = 0.5f * (min + max);
+    const float      h          = 0.5f * glm::distance (min, max);
+    const float      distance   = primitives.distance (center);
+
+    if (distance > h + params.band) {
+      return;
     }
-    for (const SketchPath& p : mesh.paths ()) {
-      for (const PrimSphere& s : p.spheres ()) {
-        distance = glm::min (distance, Distance::distance (s, pos));
+    else if (distance < -(h + params.band)) {
+      for (unsigned int z = begin.z; z < end.z; z++) {
+        for (unsigned int y = begin.y; y < end.y; y++) {
+          for (unsigned int x = begin.x; x < end.x; x++) {
+            params.blocks[params.blockIndex (x,y,z)] = insideBlock;
+          }
+        }
       }
+      return;
     }
-    return distance;
-  }
 
-  void sampleThread ( const SketchMesh& mesh, Parameters& params
-                    , unsigned int numThreads, unsigned int threadId )
-  {
-    for (unsigned int z = 0; z < params.numSamples.z; z++) {
-      for (unsigned int y = 0; y < params.numSamples.y; y++) {
-        for (unsigned int x = 0; x < params.numSamples.x; x++) {
-          const unsigned int index = params.sampleIndex (x,y,z);
+    const glm::uvec3 size = end - begin;
+
+    if (size.x == 1 && size.y == 1 && size.z == 1) {
+      BandBlock block;
+      block.index    = params.blockIndex (begin.x, begin.y, begin.z);
+      block.position = begin;
+
+      primitives.primitivesWithin (center, distance + (2.0f * h), block.primitives);
+      bandBlocks.push_back (std::move (block));
+    }
+    else {
+      const unsigned int dim = size.x >= size.y && size.x >= size.z ? 0
+                             : (size.y >= size.z ? 1 : 2);
+      glm::uvec3 split1 = end;
+      glm::uvec3 split2 = begin;
 
-          if (index % numThreads == threadId) {
-            const glm::vec3    pos   = params.samplePos   (x,y,z);
+      split1[dim] = begin[dim] + (size[dim] / 2);
+      split2[dim] = split1[dim];
 
-            params.samples.at (index) = sampleAt (mesh, pos);
+      classifyNode (primitives, params, begin, split1, bandBlocks);
+      classifyNode (primitives, params, split2, end, bandBlocks);
+    }
+  }
 
-            assert ((x > 0 && x < params.numSamples.x-1) || params.samples.at (index) > 0.0f);
-            assert ((y > 0 && y < params.numSamples.y-1) || params.samples.at (index) > 0.0f);
-            assert ((z > 0 && z < params.numSamples.z-1) || params.samples.at (index) > 0.0f);
+  void sampleBlock ( const SketchPrimitives& primitives, Parameters& params
+                   , unsigned int slot, const BandBlock& block )
+  {
+    const glm::uvec3 begin = block.position * blockSize;
+    const glm::uvec3 end   = glm::min (begin + glm::uvec3 (blockSize), params.numSamples);
+    float*           data  = &params.blockSamples[slot * blockVolume];
+
+    for (unsigned int z = begin.z; z < end.z; z++) {
+      for (unsigned int y = begin.y; y < end.y; y++) {
+        for (unsigned int x = begin.x; x < end.x; x++) {
+          const glm::vec3 pos      = params.samplePos (x,y,z);
+          float           distance = std::numeric_limits <float>::max ();
+
+          for (unsigned int p : block.primitives) {
+            distance = glm::min (distance, primitives.distance (p, pos));
           }
+          data[ ((z - begin.z) * blockSize * blockSize)
+              + ((y - begin.y) * blockSize)
+              +  (x - begin.x) ] = distance;
+
+          assert ((x > 0 && x < params.numSamples.x-1) || distance > 0.0f);
+          assert ((y > 0 && y < params.numSamples.y-1) || distance > 0.0f);
+          assert ((z > 0 && z < params.numSamples.z-1) || distance > 0.0f);
         }
       }
     }
   }
 
-  void sample (const SketchMesh& mesh, Parameters& params) {
-    params.samples.resize (params.numSamples.x * params.numSamples.y * params.numSamples.z, 0.0f);
+  void sample (const SketchMesh& mesh, Parameters& params, SketchConversion::Sampling sampling) {
+    const SketchPrimitives  primitives (mesh);
+    std::vector <BandBlock> bandBlocks;
+
+    params.blocks.resize (params.numBlocks.x * params.numBlocks.y * params.numBlocks.z, outsideBlock);
 
-    const unsigned int        numThreads = std::thread::hardware_concurrency();
-    std::vector <std::thread> threads;
+    if (sampling == SketchConversion::Sampling::Dense) {
+      std::vector <unsigned int> all (primitives.numPrimitives ());
 
-    for (unsigned int i = 0; i < numThreads; i++) {
-      threads.emplace_back (sampleThread, std::ref (mesh), std::ref (params), numThreads, i);
+      for (unsigned int i = 0; i < all.size (); i++) {
+        all[i] = i;
+      }
+      for (unsigned int z = 0; z < params.numBlocks.z; z++) {
+        for (unsigned int y = 0; y < params.numBlocks.y; y++) {
+          for (unsigned int x = 0; x < params.numBlocks.x; x++) {
+            bandBlocks.push_back (BandBlock { params.blockIndex (x,y,z)
+                                            , glm::uvec3 (x,y,z), all });
+          }
+        }
+      }
     }
-    for (unsigned int i = 0; i < numThreads; i++) {
-      threads.at (i).join ();
+    else {
+      classifyNode (primitives, params, glm::uvec3 (0), params.numBlocks, bandBlocks);
     }
+
+    params.blockSamples.resize (bandBlocks.size () * blockVolume, params.band);
+
+    for (unsigned int i = 0; i < bandBlocks.size (); i++) {
+      params.blocks[bandBlocks[i].index] = i;
+    }
+    Parallel::forRange (bandBlocks.size (), 4, [&primitives, &params, &bandBlocks]
+                                               (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        sampleBlock (primitives, params, i, bandBlocks[i]);
+      }
+    });
   }
 
   bool isIntersecting (float s1, float s2) {
     return (s1 < 0.0f && s2 >= 0.0f) || (s1 >= 0.0f && s2 < 0.0f);
   }
 
-  void setCubeVertex (Parameters& params, unsigned int cubeIndex) {
-    glm::vec3    vertex          = glm::vec3 (0.0f);
-    unsigned int numCrossedEdges = 0;
-    Cube&        cube            = params.grid.at (cubeIndex);
-
-    const unsigned int indices[] = { params.sampleIndex (cubeIndex, 0)
-                                   , params.sampleIndex (cubeIndex, 1)
-                                   , params.sampleIndex (cubeIndex, 2)
-                                   , params.sampleIndex (cubeIndex, 3)
-                                   , params.sampleIndex (cubeIndex, 4)
-                                   , params.sampleIndex (cubeIndex, 5)
-                                   , params.sampleIndex (cubeIndex, 6)
-                                   , params.sampleIndex (cubeIndex, 7)
-                                   };
-
-    const float samples[] = { params.samples.at (indices [0]), params.samples.at (indices [1])
-                            , params.samples.at (indices [2]), params.samples.at (indices [3])
-                            , params.samples.at (indices [4]), params.samples.at (indices [5])
-                            , params.samples.at (indices [6]), params.samples.at (indices [7])
-                            };
-
-    const glm::vec3 positions[] = { params.samplePos (indices [0]), params.samplePos (indices [1])
-                                  , params.samplePos (indices [2]), params.samplePos (indices [3])
-                                  , params.samplePos (indices [4]), params.samplePos (indices [5])
-                                  , params.samplePos (indices [6]), params.samplePos (indices [7])
-                                  };
-
-    auto checkEdge = [&numCrossedEdges, &vertex, &samples, &positions]
-                     (unsigned short vertex1, unsigned short vertex2)
-    {
-      if (isIntersecting (samples[vertex1], samples[vertex2])) {
-        const float     factor = samples[vertex1] / (samples[vertex1] - samples[vertex2]);
-        const glm::vec3 delta  = positions[vertex2] - positions[vertex1];
-
-        vertex += positions[vertex1] + (delta * factor);
-        numCrossedEdges++;
-      }
-    };
+  /* Corner `v` of cube `(x,y,z)` is sample `(x + v_0, y + v_1, z + v_2)`, where `v_i`
+   * denotes the `i`-th bit of `v`.
+   */
+  glm::uvec3 cornerOffset (unsigned int vertex) {
+    assert (vertex < 8);
+    return glm::uvec3 (vertex & 1, (vertex >> 1) & 1, vertex >> 2);
+  }
 
-    cube.configuration = 0;
-    for (unsigned int edge = 0; edge < 12; edge++) {
-      unsigned int vertex1, vertex2;
-      vertexIndices (edge, vertex1, vertex2);
+  void cubeSamples ( const Parameters& params, unsigned int x, unsigned int y, unsigned int z
+                   , float* samples )
+  {
+    for (unsigned int v = 0; v < 8; v++) {
+      const glm::uvec3 o = cornerOffset (v);
+      samples[v] = params.sample (x + o.x, y + o.y, z + o.z);
+    }
+  }
 
-      cube.configuration |= (int (samples[vertex1] < 0.0f)) << vertex1;
-      cube.configuration |= (int (samples[vertex2] < 0.0f)) << vertex2;
+  unsigned char cubeConfiguration (const float* samples) {
+    unsigned int configuration = 0;
 
-      checkEdge (vertex1, vertex2);
+    for (unsigned int v = 0; v < 8; v++) {
+      configuration |= (int (samples[v] < 0.0f)) << v;
     }
-    assert (cube.configuration <= 255);
+    return (unsigned char) configuration;
+  }
+
+  glm::vec3 cubeVertex (const Parameters& params, unsigned int x, unsigned int y, unsigned int z) {
+    glm::vec3    vertex          = glm::vec3 (0.0f);
+    unsigned int numCrossedEdges = 0;
+    float        samples[8];
+
+    cubeSamples (params, x, y, z, samples);
 
-#ifndef NDEBUG
     for (unsigned int edge = 0; edge < 12; edge++) {
       unsigned int vertex1, vertex2;
       vertexIndices (edge, vertex1, vertex2);
 
       if (isIntersecting (samples[vertex1], samples[vertex2])) {
-        assert (edgeVertexIndices [cube.configuration][edge] != -1);
+        const glm::uvec3 o1        = cornerOffset (vertex1);
+        const glm::uvec3 o2        = cornerOffset (vertex2);
+        const glm::vec3  position1 = params.samplePos (x + o1.x, y + o1.y, z + o1.z);
+        const glm::vec3  position2 = params.samplePos (x + o2.x, y + o2.y, z + o2.z);
+        const float      factor    = samples[vertex1] / (samples[vertex1] - samples[vertex2]);
+
+        assert (edgeVertexIndices [cubeConfiguration (samples)][edge] != -1);
+
+        vertex += position1 + ((position2 - position1) * factor);
+        numCrossedEdges++;
       }
     }
-#endif
+    assert (numCrossedEdges > 0);
+    return vertex / glm::vec3 (float (numCrossedEdges));
+  }
 
-    if (numCrossedEdges > 0) {
-      cube.vertex = vertex / glm::vec3 (float (numCrossedEdges));
-      cube.initializeVertexInstanceIndices ();
-    }
+  /* Extraction runs in parallel over z-slabs of cubes, where each slab collects its
+   * vertices and indices in its own buffers, which are stitched in slab order.
+   * Thus, the resulting mesh does not depend on the number of threads.
+   */
+  struct Slab {
+    std::vector <unsigned int> cubes;
+    std::vector <glm::vec3>    vertices;
+    std::vector <unsigned int> indices;
+  };
+
+  template <typename F>
+  void forEachSlab (const Parameters& params, const F& f) {
+    Parallel::forRange (params.numCubes.z, 1, [&f] (unsigned int begin, unsigned int end) {
+      for (unsigned int z = begin; z < end; z++) {
+        f (z);
+      }
+    });
   }
 
   void makeGrid (Parameters& params) {
     params.numCubes = params.numSamples - glm::uvec3 (1);
     params.grid.resize (params.numCubes.x * params.numCubes.y * params.numCubes.z);
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
+    forEachSlab (params, [&params] (unsigned int z) {
       for (unsigned int y = 0; y < params.numCubes.y; y++) {
         for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          setCubeVertex (params, params.cubeIndex (x,y,z));
+          const unsigned int block = params.blockOf (x,y,z);
+          Cube&              cube  = params.grid[params.cubeIndex (x,y,z)];
+
+          if ( (block == outsideBlock || block == insideBlock)
+            && (x % blockSize) < blockSize - 1
+            && (y % blockSize) < blockSize - 1
+            && (z % blockSize) < blockSize - 1 )
+          {
+            cube.configuration = block == insideBlock ? 255 : 0;
+          }
+          else {
+            float samples[8];
+            cubeSamples (params, x, y, z, samples);
+            cube.configuration = cubeConfiguration (samples);
+          }
         }
       }
-    }
+    });
   }
 
   void resolveAmbiguities (Parameters& params) {
-    auto check = [&params] ( const Cube& cube, unsigned int x, unsigned int y, unsigned int z
+    auto check = [&params] ( unsigned int x, unsigned int y, unsigned int z
                            , unsigned int ambiguousFace, int dim ) -> bool
     {
-      assert (cube.isAmbiguous ());
       assert (dim == -3 || dim == -2 || dim == -1 || dim == 1 || dim == 2 || dim == 3);
 
-      Cube& other = params.grid.at ( params.cubeIndex 
-                                   ( dim == -1 ? x-1 : (dim == 1 ? x+1 : x)
-                                   , dim == -2 ? y-1 : (dim == 2 ? y+1 : y)
-                                   , dim == -3 ? z-1 : (dim == 3 ? z+1 : z) ) );
+      const Cube& other = params.grid[ params.cubeIndex 
+                                     ( dim == -1 ? x-1 : (dim == 1 ? x+1 : x)
+                                     , dim == -2 ? y-1 : (dim == 2 ? y+1 : y)
+                                     , dim == -3 ? z-1 : (dim == 3 ? z+1 : z) ) ];
       if (other.isAmbiguous ()) {
         unsigned int otherAmbiguousFace = Util::invalidIndex ();
         const bool   hasOtherAmbiguousFace = other.hasAmbiguousFaces (&otherAmbiguousFace);
 
         assert (hasOtherAmbiguousFace);
+        (void) hasOtherAmbiguousFace;
 
         return (dim == -1 && ambiguousFace == 2 && otherAmbiguousFace == 3)
             || (dim ==  1 && ambiguousFace == 3 && otherAmbiguousFace == 2)
@@ -667,23 +770,25 @@ namespace {
       }
     };
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
+    // Only `collapseWhenAmbiguous` of the slab's own cubes is written
+    forEachSlab (params, [&params, &check] (unsigned int z) {
       for (unsigned int y = 0; y < params.numCubes.y; y++) {
         for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          Cube& cube = params.grid.at (params.cubeIndex (x,y,z));
+          Cube& cube = params.grid[params.cubeIndex (x,y,z)];
 
           if (cube.isAmbiguous ()) {
             unsigned int ambiguousFace = Util::invalidIndex ();
             const bool   hasAmbiguousFace = cube.hasAmbiguousFaces (&ambiguousFace);
 
             assert (hasAmbiguousFace);
-
-            if ( (x > 0                   && check (cube, x, y, z, ambiguousFace, -1))
-              || (x < params.numCubes.x-1 && check (cube, x, y, z, ambiguousFace,  1))
-              || (y > 0                   && check (cube, x, y, z, ambiguousFace, -2))
-              || (y < params.numCubes.y-1 && check (cube, x, y, z, ambiguousFace,  2))
-              || (z > 0                   && check (cube, x, y, z, ambiguousFace, -3))
-              || (z < params.numCubes.z-1 && check (cube, x, y, z, ambiguousFace,  3)) )
+            (void) hasAmbiguousFace;
+
+            if ( (x > 0                   && check (x, y, z, ambiguousFace, -1))
+              || (x < params.numCubes.x-1 && check (x, y, z, ambiguousFace,  1))
+              || (y > 0                   && check (x, y, z, ambiguousFace, -2))
+              || (y < params.numCubes.y-1 && check (x, y, z, ambiguousFace,  2))
+              || (z > 0                   && check (x, y, z, ambiguousFace, -3))
+              || (z < params.numCubes.z-1 && check (x, y, z, ambiguousFace,  3)) )
             {
               cube.collapseWhenAmbiguous = false;
             }
@@ -696,46 +801,68 @@ namespace {
           }
         }
       }
-    }
+    });
   }
 
-  Mesh makeMesh (Parameters& params) {
-    Mesh mesh;
+  void makeVertices (Parameters& params, std::vector <Slab>& slabs) {
+    forEachSlab (params, [&params, &slabs] (unsigned int z) {
+      Slab& slab = slabs[z];
 
-    for (Cube& cube : params.grid) {
-      for (unsigned int i = 0; i < cube.vertexInstanceIndices.size (); i++) {
-        assert (cube.vertex != invalidVec3);
-        cube.vertexInstanceIndices.at (i) = mesh.addVertex (cube.vertex);
+      for (unsigned int y = 0; y < params.numCubes.y; y++) {
+        for (unsigned int x = 0; x < params.numCubes.x; x++) {
+          const unsigned int i    = params.cubeIndex (x,y,z);
+          Cube&              cube = params.grid[i];
+
+          if (cube.configuration != 0 && cube.configuration != 255) {
+            const glm::vec3    vertex = cubeVertex (params, x, y, z);
+            const unsigned int n      = cube.numVertexInstances ();
 
-        if (cube.collapseWhenAmbiguous) {
-          break;
+            cube.firstVertex = slab.vertices.size ();
+            slab.cubes.push_back (i);
+            slab.vertices.insert (slab.vertices.end (), n, vertex);
+          }
         }
       }
+    });
+
+    std::vector <unsigned int> offsets (slabs.size (), 0);
+    for (unsigned int z = 1; z < slabs.size (); z++) {
+      offsets[z] = offsets[z-1] + slabs[z-1].vertices.size ();
     }
 
-    auto makeQuad = [&params, &mesh] ( unsigned int dim, bool swap
-                                     , unsigned int i, unsigned int iu
-                                     , unsigned int iv, unsigned int iuv )
+    forEachSlab (params, [&params, &slabs, &offsets] (unsigned int z) {
+      for (unsigned int i : slabs[z].cubes) {
+        params.grid[i].firstVertex += offsets[z];
+      }
+    });
+  }
+
+  void makeFaces (const Parameters& params, const std::vector <glm::vec3>& vertices, Slab& slab
+                 , unsigned int z )
+  {
+    auto makeQuad = [&params, &vertices, &slab] ( unsigned int dim, bool swap
+                                                , unsigned int i, unsigned int iu
+                                                , unsigned int iv, unsigned int iuv )
     {
       unsigned int v1, v2, v3, v4;
 
       if (dim == 0) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (0);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (3);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (9);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (6);
+        v1 = params.grid[i]  .vertexInstanceIndex (0);
+        v2 = params.grid[iu] .vertexInstanceIndex (3);
+        v3 = params.grid[iuv].vertexInstanceIndex (9);
+        v4 = params.grid[iv] .vertexInstanceIndex (6);
       }
       else if (dim == 1) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (1);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (7);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (10);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (4);
+        v1 = params.grid[i]  .vertexInstanceIndex (1);
+        v2 = params.grid[iu] .vertexInstanceIndex (7);
+        v3 = params.grid[iuv].vertexInstanceIndex (10);
+        v4 = params.grid[iv] .vertexInstanceIndex (4);
       }
       else if (dim == 2) {
-        v1 = params.grid.at (i)  .vertexInstanceIndex (2);
-        v2 = params.grid.at (iu) .vertexInstanceIndex (5);
-        v3 = params.grid.at (iuv).vertexInstanceIndex (11);
-        v4 = params.grid.at (iv) .vertexInstanceIndex (8);
+        v1 = params.grid[i]  .vertexInstanceIndex (2);
+        v2 = params.grid[iu] .vertexInstanceIndex (5);
+        v3 = params.grid[iuv].vertexInstanceIndex (11);
+        v4 = params.grid[iv] .vertexInstanceIndex (8);
       }
       else {
         DILAY_IMPOSSIBLE
@@ -744,27 +871,25 @@ namespace {
       if (swap) {
         std::swap (v2, v4);
       }
-      if ( glm::distance2 (mesh.vertex (v1), mesh.vertex (v3))
-        <= glm::distance2 (mesh.vertex (v2), mesh.vertex (v4)) ) 
+      if ( glm::distance2 (vertices[v1], vertices[v3])
+        <= glm::distance2 (vertices[v2], vertices[v4]) ) 
       {
-        mesh.addIndex (v1); mesh.addIndex (v2); mesh.addIndex (v3);
-        mesh.addIndex (v1); mesh.addIndex (v3); mesh.addIndex (v4);
+        slab.indices.insert (slab.indices.end (), { v1, v2, v3, v1, v3, v4 });
       }
       else {
-        mesh.addIndex (v2); mesh.addIndex (v3); mesh.addIndex (v4);
-        mesh.addIndex (v2); mesh.addIndex (v4); mesh.addIndex (v1);
+        slab.indices.insert (slab.indices.end (), { v2, v3, v4, v2, v4, v1 });
       }
     };
 
-    auto makeFaces = [&params, &makeQuad]
-                     (unsigned int dim, unsigned int x, unsigned int y, unsigned int z)
+    auto makeDimFaces = [&params, &makeQuad]
+                        (unsigned int dim, unsigned int x, unsigned int y, unsigned int z)
     {
       assert (dim == 0 || dim == 1 || dim == 2);
 
-      const float s1 = params.samples.at (params.sampleIndex (x,y,z));
-      const float s2 = params.samples.at (params.sampleIndex ( dim == 0 ? x+1 : x
-                                                             , dim == 1 ? y+1 : y
-                                                             , dim == 2 ? z+1 : z ));
+      const float s1 = params.sample (x,y,z);
+      const float s2 = params.sample ( dim == 0 ? x+1 : x
+                                     , dim == 1 ? y+1 : y
+                                     , dim == 2 ? z+1 : z );
       if (isIntersecting (s1, s2)) {
         const unsigned int i   = params.cubeIndex (x,y,z);
         const unsigned int u   = (dim + 1) % 3;
@@ -784,22 +909,617 @@ namespace {
       }
     };
 
-    for (unsigned int z = 0; z < params.numCubes.z; z++) {
-      for (unsigned int y = 0; y < params.numCubes.y; y++) {
-        for (unsigned int x = 0; x < params.numCubes.x; x++) {
-          if (y > 0 && z > 0) { makeFaces (0,x,y,z); }
-          if (x > 0 && z > 0) { makeFaces (1,x,y,z); }
-          if (x > 0 && y > 0) { makeFaces (2,x,y,z); }
-        }
+    for (unsigned int y = 0; y < params.numCubes.y; y++) {
+      for (unsigned int x = 0; x < params.numCubes.x; x++) {
+        if (y > 0 && z > 0) { makeDimFaces (0,x,y,z); }
+        if (x > 0 && z > 0) { makeDimFaces (1,x,y,z); }
+        if (x > 0 && y > 0) { makeDimFaces (2,x,y,z); }
+      }
+    }
+  }
+
+  Mesh makeMesh (Parameters& params) {
+    std::vector <Slab>      slabs (params.numCubes.z);
+    std::vector <glm::vec3> vertices;
+    unsigned int            numIndices = 0;
+
+    makeVertices (params, slabs);
+
+    for (Slab& slab : slabs) {
+      vertices.insert (vertices.end (), slab.vertices.begin (), slab.vertices.end ());
+      slab.cubes    = std::vector <unsigned int> ();
+      slab.vertices = std::vector <glm::vec3> ();
+    }
+
+    forEachSlab (params, [&params, &vertices, &slabs] (unsigned int z) {
+      makeFaces (params, vertices, slabs[z], z);
+    });
+
+    Mesh mesh;
+
+    mesh.reserveVertices (vertices.size ());
+    for (const glm::vec3& v : vertices) {
+      mesh.addVertex (v);
+    }
+
+    for (const Slab& slab : slabs) {
+      numIndices += slab.indices.size ();
+    }
+    mesh.reserveIndices (numIndices);
+    for (const Slab& slab : slabs) {
+      for (unsigned int i : slab.indices) {
+        mesh.addIndex (i);
       }
     }
 
     assert (MeshUtil::checkConsistency (mesh));
     return mesh;
   }
+
+  /* Adaptive conversion refines an octree over the sample lattice of the finest
+   * resolution, i.e. positions and sizes of cells are measured in samples.
+   * Cells that may contain the surface are refined down to `maxSurfaceLevel`, below
+   * they are only refined if they are large compared to their closest primitive, if
+   * their configuration has more than one vertex instance, or if the distance field
+   * at the midpoints of their edges, faces and center deviates from the trilinear
+   * interpolation of their corners by more than `errorTolerance` (in units of the
+   * finest resolution) or differs in sign.
+   */
+  const unsigned int maxSurfaceLevel = 3;
+  const float        errorTolerance  = 0.25f;
+  const float        radiusFactor    = 0.5f;
+
+  /* The distance field has the same sign everywhere in a uniform cell.
+   */
+  struct Cell {
+    glm::uvec3   position;
+    unsigned int level;
+    float        samples[8];
+    bool         isUniform;
+
+    Cell ()
+      : position  (glm::uvec3 (0))
+      , level     (0)
+      , isUniform (false)
+    {}
+
+    unsigned int size () const {
+      return 1 << this->level;
+    }
+  };
+
+  struct Refinement {
+    bool  refine;
+    bool  isUniform;
+    float samples[27];
+  };
+
+  struct AdaptiveParameters {
+    float                                             resolution;
+    glm::vec3                                         sampleOrigin;
+    unsigned int                                      rootLevel;
+    std::vector <Cell>                                leaves;
+    std::unordered_map <std::uint64_t, unsigned int>  leafIndices;
+
+    AdaptiveParameters ()
+      : resolution   (0.0f)
+      , sampleOrigin (glm::vec3 (0.0f))
+      , rootLevel    (0)
+    {}
+
+    glm::vec3 samplePos (const glm::uvec3& p) const {
+      return this->sampleOrigin + ( glm::vec3 (this->resolution) 
+                                  * glm::vec3 (float (p.x), float (p.y), float (p.z)) );
+    }
+
+    static std::uint64_t key (unsigned int level, const glm::uvec3& p) {
+      return (std::uint64_t (level) << 60) | (std::uint64_t (p.x) << 40)
+           | (std::uint64_t (p.y) << 20)   |  std::uint64_t (p.z);
+    }
+
+    /* `findLeaf (q,l)` is the index of the leaf that contains point `q / 2`, i.e. `q`
+     * is given in doubled lattice coordinates, if its level is at least `l`.
+     */
+    unsigned int findLeaf (const glm::ivec3& q, unsigned int minLevel = 0) const {
+      const int rootSize2 = 2 << this->rootLevel;
+
+      if ( q.x < 0 || q.y < 0 || q.z < 0
+        || q.x >= rootSize2 || q.y >= rootSize2 || q.z >= rootSize2 )
+      {
+        return Util::invalidIndex ();
+      }
+      for (unsigned int l = minLevel; l <= this->rootLevel; l++) {
+        const glm::uvec3 p ( ((unsigned int) (q.x) >> (l + 1)) << l
+                           , ((unsigned int) (q.y) >> (l + 1)) << l
+                           , ((unsigned int) (q.z) >> (l + 1)) << l );
+
+        auto it = this->leafIndices.find (key (l, p));
+        if (it != this->leafIndices.end ()) {
+          return it->second;
+        }
+      }
+      return Util::invalidIndex ();
+    }
+  };
+
+  unsigned int latticeIndex (unsigned int i, unsigned int j, unsigned int k) {
+    assert (i < 3 && j < 3 && k < 3);
+    return i + (3 * j) + (9 * k);
+  }
+
+  float trilinear (const float* samples, float fx, float fy, float fz) {
+    float value = 0.0f;
+
+    for (unsigned int v = 0; v < 8; v++) {
+      const glm::uvec3 o = cornerOffset (v);
+
+      value += (o.x ? fx : 1.0f - fx) * (o.y ? fy : 1.0f - fy) * (o.z ? fz : 1.0f - fz)
+             * samples[v];
+    }
+    return value;
+  }
+
+  /* `sampleCell` evaluates the distance field at the 27 lattice points of a cell, i.e.
+   * at its corners, the midpoints of its edges and faces, and its center `d`.
+   */
+  void sampleCell ( const SketchPrimitives& primitives, const AdaptiveParameters& params
+                  , const Cell& cell, float d, float* samples )
+  {
+    const unsigned int half = cell.size () / 2;
+
+    for (unsigned int k = 0; k < 3; k++) {
+      for (unsigned int j = 0; j < 3; j++) {
+        for (unsigned int i = 0; i < 3; i++) {
+          float& s = samples[latticeIndex (i,j,k)];
+
+          if (i != 1 && j != 1 && k != 1) {
+            s = cell.samples[(i / 2) | ((j / 2) << 1) | ((k / 2) << 2)];
+          }
+          else if (i == 1 && j == 1 && k == 1) {
+            s = d;
+          }
+          else {
+            s = primitives.distance (params.samplePos (cell.position + glm::uvec3 (i,j,k) * half));
+          }
+        }
+      }
+    }
+  }
+
+  bool refineCell ( const SketchPrimitives& primitives, const AdaptiveParameters& params
+                  , const Cell& cell, Refinement& refinement )
+  {
+    float* samples = refinement.samples;
+
+    refinement.isUniform = false;
+
+    if (cell.level == 0) {
+      return false;
+    }
+    const unsigned int half    = cell.size () / 2;
+    const glm::uvec3   center  = cell.position + glm::uvec3 (half);
+    unsigned int       closest = Util::invalidIndex ();
+    const float        d       = primitives.distance (params.samplePos (center), &closest);
+
+    if (glm::abs (d) > (glm::sqrt (3.0f) * float (half) + 1.0f) * params.resolution) {
+      refinement.isUniform = true;
+      return false;
+    }
+    sampleCell (primitives, params, cell, d, samples);
+
+    if (cell.level > maxSurfaceLevel) {
+      return true;
+    }
+    else if (float (cell.size ()) * params.resolution > radiusFactor * primitives.minRadius (closest)) {
+      return true;
+    }
+
+    Cube cube;
+    cube.configuration = cubeConfiguration (cell.samples);
+
+    if (cube.numVertexInstances () > 1 || cube.isAmbiguous ()) {
+      return true;
+    }
+
+    for (unsigned int k = 0; k < 3; k++) {
+      for (unsigned int j = 0; j < 3; j++) {
+        for (unsigned int i = 0; i < 3; i++) {
+          if (i == 1 || j == 1 || k == 1) {
+            const float s = samples[latticeIndex (i,j,k)];
+            const float t = trilinear (cell.samples, 0.5f * float (i), 0.5f * float (j)
+                                                   , 0.5f * float (k));
+            if ( (s < 0.0f) != (t < 0.0f)
+              || glm::abs (s - t) > errorTolerance * params.resolution )
+            {
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  void splitCell (const Cell& cell, const float* samples, std::vector <Cell>& children) {
+    const unsigned int half = cell.size () / 2;
+
+    for (unsigned int c = 0; c < 8; c++) {
+      const glm::uvec3 o = cornerOffset (c);
+      Cell             child;
+
+      child.position = cell.position + (o * half);
+      child.level    = cell.level - 1;
+
+      for (unsigned int v = 0; v < 8; v++) {
+        const glm::uvec3 ov = cornerOffset (v);
+        child.samples[v] = samples[latticeIndex (o.x + ov.x, o.y + ov.y, o.z + ov.z)];
+      }
+      children.push_back (child);
+    }
+  }
+
+  void indexLeaves (AdaptiveParameters& params) {
+    params.leafIndices.clear ();
+    params.leafIndices.reserve (params.leaves.size ());
+
+    for (unsigned int i = 0; i < params.leaves.size (); i++) {
+      params.leafIndices.emplace ( AdaptiveParameters::key ( params.leaves[i].level
+                                                           , params.leaves[i].position ), i );
+    }
+  }
+
+  /* Cells are refined level by level, where the cells of a level are processed in
+   * parallel and their children are collected in cell order.
+   */
+  void refineCells ( const SketchPrimitives& primitives, const AdaptiveParameters& params
+                   , std::vector <Cell>&& cells, std::vector <Cell>& leaves )
+  {
+    while (cells.empty () == false) {
+      std::vector <Refinement> refinements (cells.size ());
+      std::vector <Cell>       children;
+
+      Parallel::forRange (cells.size (), 64, [&primitives, &params, &cells, &refinements]
+                                             (unsigned int begin, unsigned int end)
+      {
+        for (unsigned int i = begin; i < end; i++) {
+          refinements[i].refine = refineCell (primitives, params, cells[i], refinements[i]);
+        }
+      });
+
+      for (unsigned int i = 0; i < cells.size (); i++) {
+        if (refinements[i].refine) {
+          splitCell (cells[i], refinements[i].samples, children);
+        }
+        else {
+          leaves.push_back (cells[i]);
+          leaves.back ().isUniform = refinements[i].isUniform;
+        }
+      }
+      cells = std::move (children);
+    }
+  }
+
+  void refineOctree (const SketchPrimitives& primitives, AdaptiveParameters& params) {
+    std::vector <Cell> cells (1);
+
+    cells[0].position = glm::uvec3 (0);
+    cells[0].level    = params.rootLevel;
+
+    for (unsigned int v = 0; v < 8; v++) {
+      cells[0].samples[v] = primitives.distance 
+                              (params.samplePos (cornerOffset (v) * cells[0].size ()));
+    }
+    refineCells (primitives, params, std::move (cells), params.leaves);
+    indexLeaves (params);
+  }
+
+  /* Leaves are balanced, i.e. the levels of adjacent non-uniform leaves differ by at
+   * most one.
+   * Thus, edges of smaller leaves only end at lattice points that have been checked
+   * by `refineCell` for their larger neighbors, and sign changes along the faces of
+   * a larger leaf are consistent with its single vertex.
+   * Split leaves are replaced by their refined children, which are checked in the next
+   * iteration.
+   */
+  void balanceOctree (const SketchPrimitives& primitives, AdaptiveParameters& params) {
+    std::vector <unsigned int> checks (params.leaves.size ());
+
+    for (unsigned int i = 0; i < checks.size (); i++) {
+      checks[i] = i;
+    }
+
+    while (checks.empty () == false) {
+      std::vector <std::vector <unsigned int>> chunks ((checks.size () + 255) / 256);
+
+      Parallel::forRange (checks.size (), 256, [&params, &checks, &chunks]
+                                               (unsigned int begin, unsigned int end)
+      {
+        for (unsigned int i = begin; i < end; i++) {
+          const Cell& leaf = params.leaves[checks[i]];
+
+          if (leaf.isUniform) {
+            continue;
+          }
+          const int        size   = int (leaf.size ());
+          const glm::ivec3 center = (glm::ivec3 (leaf.position) * 2) + glm::ivec3 (size);
+
+          for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+              for (int dx = -1; dx <= 1; dx++) {
+                const glm::ivec3   point = center + (glm::ivec3 (dx, dy, dz) * (size + 1));
+                const unsigned int other = params.findLeaf (point, leaf.level + 2);
+
+                if (other != Util::invalidIndex () && params.leaves[other].isUniform == false) {
+                  chunks[begin / 256].push_back (other);
+                }
+              }
+            }
+          }
+        }
+      });
+
+      std::vector <unsigned int> splits;
+      for (const std::vector <unsigned int>& chunk : chunks) {
+        splits.insert (splits.end (), chunk.begin (), chunk.end ());
+      }
+      std::sort (splits.begin (), splits.end ());
+      splits.erase (std::unique (splits.begin (), splits.end ()), splits.end ());
+
+      std::vector <Cell> children;
+      std::vector <Cell> leaves;
+      float              samples[27];
+
+      for (unsigned int i : splits) {
+        const Cell&      leaf   = params.leaves[i];
+        const glm::uvec3 center = leaf.position + glm::uvec3 (leaf.size () / 2);
+
+        sampleCell ( primitives, params, leaf, primitives.distance (params.samplePos (center))
+                   , samples );
+        splitCell (leaf, samples, children);
+
+        params.leafIndices.erase (AdaptiveParameters::key (leaf.level, leaf.position));
+      }
+      refineCells (primitives, params, std::move (children), leaves);
+
+      checks.clear ();
+      for (unsigned int i = 0; i < leaves.size (); i++) {
+        const unsigned int index = i < splits.size () ? splits[i] : params.leaves.size ();
+
+        if (index == params.leaves.size ()) {
+          params.leaves.push_back (leaves[i]);
+        }
+        else {
+          params.leaves[index] = leaves[i];
+        }
+        params.leafIndices.emplace (AdaptiveParameters::key (leaves[i].level, leaves[i].position)
+                                   , index);
+        checks.push_back (index);
+      }
+    }
+  }
+
+  /* A minimal edge is an edge of a leaf that is not subdivided by a smaller adjacent
+   * leaf.
+   * It is emitted by the first of its four adjacent leaves of minimal size, which are
+   * ordered as in `makeFaces`.
+   * Leaves of the finest level provide a vertex instance per edge, as in the uniform
+   * case, larger leaves provide a single vertex.
+   */
+  struct MinimalEdge {
+    unsigned int slots[4];
+    glm::vec3    crossing;
+    bool         swap;
+  };
+
+  void makeMinimalEdges ( const AdaptiveParameters& params, const std::vector <Cube>& cubes
+                        , unsigned int leafIndex, std::vector <MinimalEdge>& edges )
+  {
+    static const unsigned int quadrantEdges[3][4] = { {0, 3,  9, 6}
+                                                    , {1, 7, 10, 4}
+                                                    , {2, 5, 11, 8} };
+    static const int          quadrantSigns[4][2] = { {1,1}, {-1,1}, {-1,-1}, {1,-1} };
+
+    const Cell& leaf = params.leaves[leafIndex];
+
+    for (unsigned int edge = 0; edge < 12; edge++) {
+      unsigned int vertex1, vertex2;
+      vertexIndices (edge, vertex1, vertex2);
+
+      const float s1 = leaf.samples[vertex1];
+      const float s2 = leaf.samples[vertex2];
+
+      if (isIntersecting (s1, s2) == false) {
+        continue;
+      }
+      const glm::uvec3   o1  = cornerOffset (vertex1);
+      const glm::uvec3   o2  = cornerOffset (vertex2);
+      const unsigned int dim = o2.x != o1.x ? 0 : (o2.y != o1.y ? 1 : 2);
+      const unsigned int u   = (dim + 1) % 3;
+      const unsigned int v   = (dim + 2) % 3;
+      const glm::uvec3   p1  = leaf.position + (o1 * leaf.size ());
+      const glm::uvec3   p2  = leaf.position + (o2 * leaf.size ());
+      const glm::ivec3   mid = glm::ivec3 (p1 + p2);
+
+      unsigned int quadrants[4];
+      unsigned int minLevel = leaf.level;
+      bool         isValid  = true;
+
+      for (unsigned int q = 0; q < 4 && isValid; q++) {
+        glm::ivec3 point = mid;
+        point[u] += quadrantSigns[q][0];
+        point[v] += quadrantSigns[q][1];
+
+        quadrants[q] = params.findLeaf (point);
+
+        if (quadrants[q] == Util::invalidIndex ()) {
+          isValid = false;
+        }
+        else {
+          minLevel = glm::min (minLevel, params.leaves[quadrants[q]].level);
+        }
+      }
+      if (isValid == false || minLevel < leaf.level) {
+        continue;
+      }
+
+      unsigned int owner = 0;
+      while (params.leaves[quadrants[owner]].level != minLevel) {
+        owner++;
+      }
+      if (quadrants[owner] != leafIndex) {
+        continue;
+      }
+
+      MinimalEdge minimalEdge;
+      for (unsigned int q = 0; q < 4; q++) {
+        const Cube& cube = cubes[quadrants[q]];
+
+        minimalEdge.slots[q] = params.leaves[quadrants[q]].level == 0
+                             ? cube.vertexInstanceIndex (quadrantEdges[dim][q])
+                             : cube.firstVertex;
+      }
+      const glm::vec3 position1 = params.samplePos (p1);
+      const glm::vec3 position2 = params.samplePos (p2);
+
+      minimalEdge.crossing = position1 + ((position2 - position1) * (s1 / (s1 - s2)));
+      minimalEdge.swap     = s1 >= 0.0f;
+
+      edges.push_back (minimalEdge);
+    }
+  }
+
+  /* Ambiguous leaves of the finest level are resolved as in `resolveAmbiguities`,
+   * i.e. they are not collapsed if the leaf behind their ambiguous face is an
+   * ambiguous leaf of the finest level with the opposite ambiguous face.
+   */
+  bool collapseWhenAmbiguous ( const AdaptiveParameters& params, const std::vector <Cube>& cubes
+                             , unsigned int leafIndex )
+  {
+    static const int          faceDirections[6] = { -1, 1, -1, 1, -1, 1 };
+    static const unsigned int faceDimensions[6] = {  1, 1,  0, 0,  2, 2 };
+
+    const Cube& cube = cubes[leafIndex];
+
+    if (cube.isAmbiguous () == false) {
+      return false;
+    }
+    unsigned int ambiguousFace = Util::invalidIndex ();
+    const bool   hasAmbiguousFace = cube.hasAmbiguousFaces (&ambiguousFace);
+
+    assert (hasAmbiguousFace);
+    (void) hasAmbiguousFace;
+
+    glm::ivec3 point = (glm::ivec3 (params.leaves[leafIndex].position) * 2) + glm::ivec3 (1);
+    point[faceDimensions[ambiguousFace]] += 2 * faceDirections[ambiguousFace];
+
+    const unsigned int other = params.findLeaf (point);
+
+    if (other != Util::invalidIndex () && params.leaves[other].level == 0 
+                                       && cubes[other].isAmbiguous ())
+    {
+      unsigned int otherAmbiguousFace = Util::invalidIndex ();
+      cubes[other].hasAmbiguousFaces (&otherAmbiguousFace);
+
+      return otherAmbiguousFace != (ambiguousFace ^ 1);
+    }
+    return true;
+  }
+
+  Mesh makeAdaptiveMesh (const AdaptiveParameters& params) {
+    const unsigned int                      numLeaves = params.leaves.size ();
+    std::vector <Cube>                      cubes (numLeaves);
+    std::vector <std::vector <MinimalEdge>> chunks ((numLeaves + 255) / 256);
+    unsigned int                            numSlots = 0;
+
+    for (unsigned int i = 0; i < numLeaves; i++) {
+      cubes[i].configuration = cubeConfiguration (params.leaves[i].samples);
+    }
+    for (unsigned int i = 0; i < numLeaves; i++) {
+      cubes[i].firstVertex = numSlots;
+
+      if (params.leaves[i].level == 0) {
+        cubes[i].collapseWhenAmbiguous = collapseWhenAmbiguous (params, cubes, i);
+        numSlots += cubes[i].numVertexInstances ();
+      }
+      else {
+        numSlots += 1;
+      }
+    }
+
+    Parallel::forRange (numLeaves, 256, [&params, &cubes, &chunks]
+                                        (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        makeMinimalEdges (params, cubes, i, chunks[begin / 256]);
+      }
+    });
+
+    std::vector <glm::vec3>    sums   (numSlots, glm::vec3 (0.0f));
+    std::vector <unsigned int> counts (numSlots, 0);
+
+    for (const std::vector <MinimalEdge>& chunk : chunks) {
+      for (const MinimalEdge& edge : chunk) {
+        for (unsigned int q = 0; q < 4; q++) {
+          if (std::find (edge.slots, edge.slots + q, edge.slots[q]) == edge.slots + q) {
+            sums  [edge.slots[q]] += edge.crossing;
+            counts[edge.slots[q]] += 1;
+          }
+        }
+      }
+    }
+
+    Mesh                       mesh;
+    std::vector <glm::vec3>    vertices;
+    std::vector <unsigned int> vertexIndices (numSlots, Util::invalidIndex ());
+
+    for (unsigned int i = 0; i < numSlots; i++) {
+      if (counts[i] > 0) {
+        vertexIndices[i] = vertices.size ();
+        vertices.push_back (sums[i] / glm::vec3 (float (counts[i])));
+      }
+    }
+    mesh.reserveVertices (vertices.size ());
+    for (const glm::vec3& v : vertices) {
+      mesh.addVertex (v);
+    }
+
+    for (const std::vector <MinimalEdge>& chunk : chunks) {
+      for (const MinimalEdge& edge : chunk) {
+        unsigned int vs[4];
+        unsigned int n = 0;
+
+        for (unsigned int q = 0; q < 4; q++) {
+          const unsigned int index = vertexIndices[edge.slots[edge.swap ? (4 - q) % 4 : q]];
+
+          if (n == 0 || (vs[n-1] != index && (q < 3 || vs[0] != index))) {
+            vs[n++] = index;
+          }
+        }
+
+        if (n == 3) {
+          mesh.addIndex (vs[0]); mesh.addIndex (vs[1]); mesh.addIndex (vs[2]);
+        }
+        else if (n == 4) {
+          if ( glm::distance2 (vertices[vs[0]], vertices[vs[2]])
+            <= glm::distance2 (vertices[vs[1]], vertices[vs[3]]) ) 
+          {
+            for (unsigned int i : { vs[0], vs[1], vs[2], vs[0], vs[2], vs[3] }) {
+              mesh.addIndex (i);
+            }
+          }
+          else {
+            for (unsigned int i : { vs[1], vs[2], vs[3], vs[1], vs[3], vs[0] }) {
+              mesh.addIndex (i);
+            }
+          }
+        }
+      }
+    }
+    return mesh;
+  }
 }
 
-Mesh SketchConversion :: convert (const SketchMesh& mesh, float resolution) {
+Mesh SketchConversion :: convert (const SketchMesh& mesh, float resolution, Sampling sampling) {
   assert (mesh.isEmpty () == false);
 
   Parameters params;
@@ -808,7 +1528,7 @@ Mesh SketchConversion :: convert (const SketchMesh& mesh, float resolution) {
   setupSampling (mesh, params);
 
   if (params.numSamples.x > 0 && params.numSamples.y > 0 && params.numSamples.z > 0) {
-    sample             (mesh, params);
+    sample             (mesh, params, sampling);
     makeGrid           (params);
     resolveAmbiguities (params);
     return makeMesh    (params);
@@ -817,3 +1537,39 @@ Mesh SketchConversion :: convert (const SketchMesh& mesh, float resolution) {
     return Mesh ();
   }
 }
+
+Mesh SketchConversion :: convertAdaptive (const SketchMesh& mesh, float resolution) {
+  assert (mesh.isEmpty () == false);
+
+  glm::vec3 min, max;
+  mesh.minMax (min, max);
+
+  min = min - glm::vec3 (Util::epsilon ());
+  max = max + glm::vec3 (Util::epsilon ());
+
+  const glm::vec3    extent     = glm::ceil ((max - min) / glm::vec3 (resolution));
+  const unsigned int numSamples = (unsigned int) glm::max (extent.x, glm::max (extent.y, extent.z));
+
+  const SketchPrimitives primitives (mesh);
+  AdaptiveParameters     params;
+  params.resolution   = resolution;
+  params.sampleOrigin = min;
+
+  while ((1u << params.rootLevel) < numSamples) {
+    params.rootLevel++;
+  }
+  assert (params.rootLevel < 16);
+
+  refineOctree  (primitives, params);
+  balanceOctree (primitives, params);
+
+  Mesh adaptiveMesh = makeAdaptiveMesh (params);
+
+  if (adaptiveMesh.numVertices () > 0 && MeshUtil::checkConsistency (adaptiveMesh)) {
+    return adaptiveMesh;
+  }
+  else {
+    DILAY_WARN ("inconsistent adaptive mesh at resolution %f: converting uniformly", resolution)
+    return SketchConversion::convert (mesh, resolution);
+  }
+}
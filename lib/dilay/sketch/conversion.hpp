@@ -10,7 +10,21 @@ class SketchMesh;
 
 namespace SketchConversion {
 
-  Mesh convert (const SketchMesh&, float);
+  /* `Sparse` evaluates the distance field only in blocks of samples near the surface
+   * of a sketch, `Dense` evaluates it at every sample of the bounding box.
+   * Both produce the same mesh.
+   */
+  enum class Sampling { Sparse, Dense };
+
+  Mesh convert (const SketchMesh&, float, Sampling = Sampling::Sparse);
+
+  /* `convertAdaptive (m,r)` refines an octree down to resolution `r` only where the
+   * distance field of `m` is curved or its primitives are small, and extracts a
+   * crack-free surface from leaves of different sizes.
+   * Falls back to `convert (m,r)` and logs a warning if the extracted mesh is not
+   * consistent.
+   */
+  Mesh convertAdaptive (const SketchMesh&, float);
 };
 
 #endif
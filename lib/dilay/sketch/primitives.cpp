@@ -0,0 +1,276 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <cassert>
+#include <glm/glm.hpp>
+#include <limits>
+#include "distance.hpp"
+#include "primitive/cone-sphere.hpp"
+#include "sketch/mesh.hpp"
+#include "sketch/path.hpp"
+#include "sketch/primitives.hpp"
+
+namespace {
+  static constexpr unsigned int maxLeafSize = 4;
+
+  struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    Bounds ()
+      : min (std::numeric_limits <float>::max ())
+      , max (std::numeric_limits <float>::lowest ())
+    {}
+
+    Bounds (const PrimSphere& sphere)
+      : min (sphere.center () - glm::vec3 (sphere.radius ()))
+      , max (sphere.center () + glm::vec3 (sphere.radius ()))
+    {}
+
+    void extend (const glm::vec3& p) {
+      this->min = glm::min (this->min, p);
+      this->max = glm::max (this->max, p);
+    }
+
+    void extend (const Bounds& b) {
+      this->min = glm::min (this->min, b.min);
+      this->max = glm::max (this->max, b.max);
+    }
+
+    glm::vec3 center () const {
+      return 0.5f * (this->min + this->max);
+    }
+
+    /** `distance (p)` is a lower bound of the distance of `p` to all primitives
+     * inside of the bounds if it is positive */
+    float distance (const glm::vec3& p) const {
+      return glm::length (glm::max (glm::vec3 (0.0f), glm::max (this->min - p, p - this->max)));
+    }
+  };
+
+  struct Node {
+    Bounds       bounds;
+    unsigned int first; // first child (inner node) or first primitive reference (leaf)
+    unsigned int count; // number of primitive references, 0 for inner nodes
+
+    bool isLeaf () const {
+      return this->count > 0;
+    }
+  };
+}
+
+struct SketchPrimitives::Impl {
+  std::vector <PrimConeSphere> coneSpheres;
+  std::vector <PrimSphere>     spheres;
+  std::vector <Bounds>         bounds;
+  std::vector <Node>           nodes;
+  std::vector <unsigned int>   refs;
+
+  Impl (const SketchMesh& mesh) {
+    if (mesh.tree ().hasRoot ()) {
+      mesh.tree ().root ().forEachConstNode ([this] (const SketchNode& node) {
+        if (node.parent ()) {
+          this->coneSpheres.emplace_back (node.data (), node.parent ()->data ());
+        }
+        else {
+          this->spheres.push_back (node.data ());
+        }
+      });
+    }
+    for (const SketchPath& p : mesh.paths ()) {
+      for (const PrimSphere& s : p.spheres ()) {
+        this->spheres.push_back (s);
+      }
+    }
+
+    for (const PrimConeSphere& c : this->coneSpheres) {
+      this->bounds.emplace_back (c.sphere1 ());
+      this->bounds.back ().extend (Bounds (c.sphere2 ()));
+    }
+    for (const PrimSphere& s : this->spheres) {
+      this->bounds.emplace_back (s);
+    }
+    this->build ();
+  }
+
+  unsigned int numPrimitives () const {
+    return this->bounds.size ();
+  }
+
+  float distance (unsigned int i, const glm::vec3& pos) const {
+    assert (i < this->numPrimitives ());
+
+    return i < this->coneSpheres.size ()
+         ? Distance::distance (this->coneSpheres[i], pos)
+         : Distance::distance (this->spheres[i - this->coneSpheres.size ()], pos);
+  }
+
+  /* Primitives are partitioned at the median of their centroids along the longest axis
+   * of the centroid bounds.
+   */
+  void build () {
+    struct Task {
+      unsigned int node;
+      unsigned int begin;
+      unsigned int end;
+    };
+    std::vector <Task> tasks;
+
+    this->refs.resize (this->numPrimitives ());
+    for (unsigned int i = 0; i < this->refs.size (); i++) {
+      this->refs[i] = i;
+    }
+    if (this->refs.empty ()) {
+      return;
+    }
+    this->nodes.push_back (Node ());
+    tasks.push_back ({ 0, 0, (unsigned int) this->refs.size () });
+
+    while (tasks.empty () == false) {
+      const Task task = tasks.back ();
+      tasks.pop_back ();
+
+      Bounds bounds;
+      Bounds centroids;
+      for (unsigned int i = task.begin; i < task.end; i++) {
+        const Bounds& b = this->bounds[this->refs[i]];
+
+        bounds   .extend (b);
+        centroids.extend (b.center ());
+      }
+      this->nodes[task.node].bounds = bounds;
+
+      if (task.end - task.begin <= maxLeafSize) {
+        this->nodes[task.node].first = task.begin;
+        this->nodes[task.node].count = task.end - task.begin;
+      }
+      else {
+        const glm::vec3    extent = centroids.max - centroids.min;
+        const unsigned int axis   = extent.x >= extent.y && extent.x >= extent.z ? 0
+                                  : (extent.y >= extent.z ? 1 : 2);
+        const unsigned int middle = (task.begin + task.end) / 2;
+
+        std::nth_element ( this->refs.begin () + task.begin
+                         , this->refs.begin () + middle
+                         , this->refs.begin () + task.end
+                         , [this, axis] (unsigned int a, unsigned int b)
+        {
+          return this->bounds[a].center ()[axis] < this->bounds[b].center ()[axis];
+        });
+
+        const unsigned int first = this->nodes.size ();
+
+        this->nodes[task.node].first = first;
+        this->nodes[task.node].count = 0;
+        this->nodes.push_back (Node ());
+        this->nodes.push_back (Node ());
+
+        tasks.push_back ({ first    , task.begin, middle   });
+        tasks.push_back ({ first + 1, middle    , task.end });
+      }
+    }
+  }
+
+  /* Calls `f (i)` for all primitives `i` whose bounds are not farther than
+   * `maxDistance ()` from `pos`, where `maxDistance` may shrink during traversal.
+   */
+  template <typename MaxDistance, typename F>
+  void forEachNear (const glm::vec3& pos, const MaxDistance& maxDistance, const F& f) const {
+    if (this->nodes.empty ()) {
+      return;
+    }
+    unsigned int stack[64];
+    unsigned int stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+      const Node& node = this->nodes[stack[--stackSize]];
+      const float d    = node.bounds.distance (pos);
+
+      if (d > 0.0f && d > maxDistance ()) {
+        continue;
+      }
+      else if (node.isLeaf ()) {
+        for (unsigned int i = node.first; i < node.first + node.count; i++) {
+          const float dPrim = this->bounds[this->refs[i]].distance (pos);
+
+          if (dPrim <= 0.0f || dPrim <= maxDistance ()) {
+            f (this->refs[i]);
+          }
+        }
+      }
+      else {
+        assert (stackSize + 2 <= 64);
+
+        const unsigned int c1 = node.first;
+        const unsigned int c2 = node.first + 1;
+
+        // the nearer child is visited first
+        if (this->nodes[c1].bounds.distance (pos) <= this->nodes[c2].bounds.distance (pos)) {
+          stack[stackSize++] = c2;
+          stack[stackSize++] = c1;
+        }
+        else {
+          stack[stackSize++] = c1;
+          stack[stackSize++] = c2;
+        }
+      }
+    }
+  }
+
+  float distance (const glm::vec3& pos, unsigned int* closest) const {
+    float distance = std::numeric_limits <float>::max ();
+
+    auto maxDistance = [&distance] () { return distance; };
+
+    this->forEachNear (pos, maxDistance, [this, &pos, &distance, closest] (unsigned int i) {
+      const float d = this->distance (i, pos);
+
+      if (d < distance) {
+        distance = d;
+
+        if (closest) {
+          *closest = i;
+        }
+      }
+    });
+    return distance;
+  }
+
+  float minRadius (unsigned int i) const {
+    assert (i < this->numPrimitives ());
+
+    if (i < this->coneSpheres.size ()) {
+      return glm::min ( this->coneSpheres[i].sphere1 ().radius ()
+                      , this->coneSpheres[i].sphere2 ().radius () );
+    }
+    else {
+      return this->spheres[i - this->coneSpheres.size ()].radius ();
+    }
+  }
+
+  void primitivesWithin ( const glm::vec3& pos, float maxDistance
+                        , std::vector <unsigned int>& primitives ) const
+  {
+    primitives.clear ();
+
+    auto constMaxDistance = [maxDistance] () { return maxDistance; };
+
+    this->forEachNear (pos, constMaxDistance, [this, &pos, maxDistance, &primitives] (unsigned int i) {
+      if (this->distance (i, pos) <= maxDistance) {
+        primitives.push_back (i);
+      }
+    });
+    std::sort (primitives.begin (), primitives.end ());
+  }
+};
+
+DELEGATE1_BIG2 (SketchPrimitives, const SketchMesh&)
+DELEGATE_CONST  (unsigned int, SketchPrimitives, numPrimitives)
+DELEGATE2_CONST (float       , SketchPrimitives, distance, unsigned int, const glm::vec3&)
+DELEGATE2_CONST (float       , SketchPrimitives, distance, const glm::vec3&, unsigned int*)
+DELEGATE1_CONST (float       , SketchPrimitives, minRadius, unsigned int)
+DELEGATE3_CONST (void        , SketchPrimitives, primitivesWithin, const glm::vec3&, float, std::vector <unsigned int>&)
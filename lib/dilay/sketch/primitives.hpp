@@ -0,0 +1,42 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SKETCH_PRIMITIVES
+#define DILAY_SKETCH_PRIMITIVES
+
+#include <glm/fwd.hpp>
+#include <vector>
+#include "macro.hpp"
+
+class SketchMesh;
+
+/* `SketchPrimitives` are the cone spheres of all nodes of a sketch that have a parent,
+ * the sphere of its root node and the spheres of all its paths.
+ * Queries are accelerated by a bounding volume hierarchy over the bounding boxes of
+ * all primitives, which is built once on construction.
+ */
+class SketchPrimitives {
+  public:
+    DECLARE_BIG2 (SketchPrimitives, const SketchMesh&)
+
+    unsigned int numPrimitives    () const;
+
+    /** `distance (i,p)` is the signed distance of `p` to primitive `i` */
+    float        distance         (unsigned int, const glm::vec3&) const;
+
+    /** `distance (p,c)` is the signed distance of `p` to the closest primitive,
+     * whose index is stored in `c` if `c != nullptr` */
+    float        distance         (const glm::vec3&, unsigned int* = nullptr) const;
+
+    /** `minRadius (i)` is the smallest radius of primitive `i` */
+    float        minRadius        (unsigned int) const;
+
+    /** `primitivesWithin (p,d,ps)` sets `ps` to all primitives with distance `<= d` to `p` */
+    void         primitivesWithin (const glm::vec3&, float, std::vector <unsigned int>&) const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
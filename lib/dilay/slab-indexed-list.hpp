@@ -0,0 +1,331 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_SLAB_INDEXED_LIST
+#define DILAY_SLAB_INDEXED_LIST
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#if defined(_WIN32) || defined(_WIN64)
+#include <malloc.h>
+#endif
+
+/* `SlabIndexedList <T>` stores its elements in fixed-size chunks of `2^chunkBits`
+ * elements, so that element `i` lives at slot `i % 2^chunkBits` of chunk `i >> chunkBits`.
+ * Elements never move, i.e. addresses are stable until an element is deleted.
+ * Indices of deleted elements are reused by subsequent insertions.
+ * Each free index knows its position in the list of free indices, i.e. a specific free
+ * index is reused by `emplaceAt` in constant time.
+ * Iteration visits elements in index order.
+ * Its interface is compatible to `IntrusiveIndexedList <T>`: elements are constructed
+ * by `T (index, args ...)` and must provide `index ()`.
+ * Chunks are aligned to their (power-of-two rounded) size and store a pointer to the
+ * owner of the list behind their last slot, so that `ownerOf (e)` finds the owner
+ * of element `e` without storing it in every element.
+ */
+template <typename T, unsigned int chunkBits = 12>
+class SlabIndexedList {
+    static_assert (chunkBits > 0 && chunkBits < 32, "invalid chunk size");
+
+    typedef typename std::aligned_storage <sizeof (T), alignof (T)>::type Slot;
+
+    static constexpr unsigned int chunkSize = 1u << chunkBits;
+    static constexpr unsigned int chunkMask = chunkSize - 1u;
+
+    // position of indices that are not free
+    static constexpr unsigned int notFree = ~0u;
+
+    static constexpr std::size_t roundToPowerOfTwo (std::size_t n, std::size_t p = 1) {
+      return p >= n ? p : roundToPowerOfTwo (n, p << 1);
+    }
+
+    static constexpr std::size_t ownerOffset    = chunkSize * sizeof (Slot);
+    static constexpr std::size_t chunkAlignment = roundToPowerOfTwo (ownerOffset);
+    static constexpr std::size_t chunkBytes     = ownerOffset + sizeof (void*);
+
+    static_assert (ownerOffset % alignof (void*) == 0, "misaligned owner pointer");
+
+    struct FreeChunk {
+      void operator() (Slot* chunk) const {
+#if defined(_WIN32) || defined(_WIN64)
+        _aligned_free (chunk);
+#else
+        std::free (chunk);
+#endif
+      }
+    };
+
+    typedef std::unique_ptr <Slot[], FreeChunk> Chunk;
+
+  public:
+    SlabIndexedList ()
+      : _numElements (0)
+      , _owner       (nullptr)
+    {}
+
+    SlabIndexedList (const SlabIndexedList&) = delete;
+
+    SlabIndexedList (SlabIndexedList&& o)
+      : SlabIndexedList ()
+    {
+      this->operator= (std::move (o));
+    }
+
+    ~SlabIndexedList () {
+      this->reset ();
+    }
+
+    SlabIndexedList& operator= (const SlabIndexedList&) = delete;
+
+    SlabIndexedList& operator= (SlabIndexedList&& o) {
+      if (this != &o) {
+        this->reset ();
+
+        this->_chunks        = std::move (o._chunks);
+        this->_freePositions = std::move (o._freePositions);
+        this->_freeIndices   = std::move (o._freeIndices);
+        this->_numElements   = o._numElements;
+
+        for (Chunk& c : this->_chunks) {
+          this->setChunkOwner (c);
+        }
+        o._chunks       .clear ();
+        o._freePositions.clear ();
+        o._freeIndices  .clear ();
+        o._numElements = 0;
+      }
+      return *this;
+    }
+
+    /* The owner is stored per chunk and is therefore not moved along with the elements.
+     */
+    void owner (void* o) {
+      this->_owner = o;
+      for (Chunk& c : this->_chunks) {
+        this->setChunkOwner (c);
+      }
+    }
+
+    void* owner () const { return this->_owner; }
+
+    static void* ownerOf (const T& element) {
+      const std::uintptr_t chunk = reinterpret_cast <std::uintptr_t> (&element)
+                                 & ~std::uintptr_t (chunkAlignment - 1);
+      return *reinterpret_cast <void* const*> (chunk + ownerOffset);
+    }
+
+    unsigned int numElements () const { return this->_numElements; }
+    bool         isEmpty     () const { return this->_numElements == 0; }
+
+    // number of indices that have been handed out so far (including free ones)
+    unsigned int numIndices  () const { return this->_freePositions.size (); }
+
+    T& front () {
+      assert (this->isEmpty () == false);
+      return *this->slot (this->firstIndex ());
+    }
+
+    const T& front () const {
+      assert (this->isEmpty () == false);
+      return *this->slot (this->firstIndex ());
+    }
+
+    T& back () {
+      assert (this->isEmpty () == false);
+      return *this->slot (this->lastIndex ());
+    }
+
+    const T& back () const {
+      assert (this->isEmpty () == false);
+      return *this->slot (this->lastIndex ());
+    }
+
+    template <typename ... Args>
+    T& emplaceBack (const Args& ... args) {
+      if (this->hasFreeIndices ()) {
+        const unsigned int index   = this->_freeIndices.back ();
+              T*           element = new (this->slot (index)) T (index, args ...);
+
+        this->_freeIndices.pop_back ();
+        this->_freePositions [index] = notFree;
+        this->_numElements++;
+        return *element;
+      }
+      else {
+        const unsigned int index = this->numIndices ();
+
+        if ((index & chunkMask) == 0) {
+          this->_chunks.emplace_back (allocateChunk ());
+          this->setChunkOwner (this->_chunks.back ());
+        }
+        T* element = new (this->slot (index)) T (index, args ...);
+
+        this->_freePositions.push_back (notFree);
+        this->_numElements++;
+        return *element;
+      }
+    }
+
+    /* Constructs an element at a specific free `index`. Missing indices up to `index`
+     * are added as free indices.
+     */
+    template <typename ... Args>
+    T& emplaceAt (unsigned int index, const Args& ... args) {
+      while (this->numIndices () <= index) {
+        const unsigned int i = this->numIndices ();
+
+        if ((i & chunkMask) == 0) {
+          this->_chunks.emplace_back (allocateChunk ());
+          this->setChunkOwner (this->_chunks.back ());
+        }
+        this->_freePositions.push_back (this->_freeIndices.size ());
+        this->_freeIndices  .push_back (i);
+      }
+      assert (this->isFree (index));
+
+      const unsigned int position = this->_freePositions [index];
+      const unsigned int last     = this->_freeIndices.back ();
+
+      this->_freeIndices   [position] = last;
+      this->_freePositions [last]     = position;
+      this->_freeIndices.pop_back ();
+
+      T* element = new (this->slot (index)) T (index, args ...);
+
+      this->_freePositions [index] = notFree;
+      this->_numElements++;
+      return *element;
+    }
+
+    void deleteElement (T& element) {
+      const unsigned int index = element.index ();
+
+      assert (index < this->numIndices ());
+      assert (this->isFree (index) == false);
+      assert (this->slot (index) == &element);
+
+      element.~T ();
+      this->_freePositions [index] = this->_freeIndices.size ();
+      this->_freeIndices.push_back (index);
+      this->_numElements--;
+    }
+
+    void reset () {
+      for (unsigned int i = 0; i < this->numIndices (); i++) {
+        if (this->_freePositions [i] == notFree) {
+          this->slot (i)->~T ();
+        }
+      }
+      this->_chunks       .clear ();
+      this->_freePositions.clear ();
+      this->_freeIndices  .clear ();
+      this->_numElements = 0;
+    }
+
+    /* Elements may be deleted while iterating.
+     * Elements that are added while iterating are visited iff their index
+     * is greater than the index of the current element.
+     */
+    template <typename F>
+    void forEachElement (const F& f) {
+      for (unsigned int i = 0; i < this->numIndices (); i++) {
+        if (this->_freePositions [i] == notFree) {
+          f (*this->slot (i));
+        }
+      }
+    }
+
+    template <typename F>
+    void forEachConstElement (const F& f) const {
+      for (unsigned int i = 0; i < this->numIndices (); i++) {
+        if (this->_freePositions [i] == notFree) {
+          f (*this->slot (i));
+        }
+      }
+    }
+
+    T* get (unsigned int index) {
+      return this->isFree (index) ? nullptr : this->slot (index);
+    }
+
+    const T* get (unsigned int index) const {
+      return this->isFree (index) ? nullptr : this->slot (index);
+    }
+
+    const std::vector <unsigned int>& freeIndices () const { return this->_freeIndices; }
+
+    bool hasFreeIndices () const {
+      return this->_freeIndices.empty () == false;
+    }
+
+    bool isFree (unsigned int index) const {
+      assert (index < this->numIndices ());
+      return this->_freePositions [index] != notFree;
+    }
+
+    bool isFreeSLOW (unsigned int index) const {
+      return this->_freePositions.at (index) != notFree;
+    }
+
+  private:
+    static Chunk allocateChunk () {
+#if defined(_WIN32) || defined(_WIN64)
+      void* memory = _aligned_malloc (chunkBytes, chunkAlignment);
+#else
+      void* memory = nullptr;
+      if (posix_memalign (&memory, chunkAlignment, chunkBytes) != 0) {
+        memory = nullptr;
+      }
+#endif
+      if (memory == nullptr) {
+        throw std::bad_alloc ();
+      }
+      return Chunk (static_cast <Slot*> (memory));
+    }
+
+    void setChunkOwner (Chunk& chunk) {
+      *reinterpret_cast <void**> (reinterpret_cast <unsigned char*> (chunk.get ()) + ownerOffset)
+        = this->_owner;
+    }
+
+    T* slot (unsigned int index) {
+      return reinterpret_cast <T*> (&this->_chunks [index >> chunkBits][index & chunkMask]);
+    }
+
+    const T* slot (unsigned int index) const {
+      return reinterpret_cast <const T*> (&this->_chunks [index >> chunkBits][index & chunkMask]);
+    }
+
+    unsigned int firstIndex () const {
+      unsigned int i = 0;
+      while (this->isFree (i)) {
+        i++;
+      }
+      return i;
+    }
+
+    unsigned int lastIndex () const {
+      unsigned int i = this->numIndices () - 1;
+      while (this->isFree (i)) {
+        i--;
+      }
+      return i;
+    }
+
+    std::vector <Chunk>        _chunks;
+    std::vector <unsigned int> _freePositions;
+    std::vector <unsigned int> _freeIndices;
+    unsigned int               _numElements;
+    void*                      _owner;
+};
+
+template <typename T, unsigned int chunkBits>
+constexpr unsigned int SlabIndexedList <T, chunkBits>::notFree;
+
+#endif
@@ -2,6 +2,7 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
 #include <memory>
 #include "cache.hpp"
 #include "camera.hpp"
@@ -11,6 +12,7 @@
 #include "mesh-util.hpp"
 #include "scene.hpp"
 #include "state.hpp"
+#include "task-pool.hpp"
 #include "tool.hpp"
 
 struct State::Impl {
@@ -32,6 +34,7 @@ struct State::Impl {
     , _status    (EngineStatus::None)
   {
     this->scene.newWingedMesh (this->config, MeshUtil::icosphere (3));
+    this->taskPoolFromConfig ();
   }
 
   ~Impl () {
@@ -63,7 +66,21 @@ struct State::Impl {
     }
   }
 
+  // tools may still modify the scene asynchronously (see `ToolSculpt`)
+  void finishTool () {
+    if (this->hasTool ()) {
+      this->toolPtr->finish ();
+    }
+  }
+
+  // the task pool must be idle when it is restarted
+  void taskPoolFromConfig () {
+    this->finishTool ();
+    TaskPool::global ().numThreads (std::max (0, this->config.get <int> ("editor/numThreads")));
+  }
+
   void fromConfig () {
+    this->taskPoolFromConfig ();
     this->camera .fromConfig (this->config);
     this->history.fromConfig (this->config);
     this->scene  .fromConfig (this->config);
@@ -74,10 +91,12 @@ struct State::Impl {
   }
 
   void undo () {
+    this->finishTool ();
     this->history.undo (*this->self);
   }
 
   void redo () {
+    this->finishTool ();
     this->history.redo (*this->self);
   }
 
@@ -112,6 +131,7 @@ DELEGATE  (bool              , State, hasTool)
 DELEGATE  (Tool&             , State, tool)
 DELEGATE1 (void              , State, setTool, Tool&&)
 DELEGATE1 (void              , State, resetTool, bool)
+DELEGATE  (void              , State, finishTool)
 DELEGATE  (void              , State, fromConfig)
 DELEGATE  (void              , State, undo)
 DELEGATE  (void              , State, redo)
@@ -37,6 +37,9 @@ class DILAY_LIB_EXPORT State {
     Tool&           tool               ();
     void            setTool            (Tool&&);
     void            resetTool          (bool = true);
+    /** `finishTool` must be called before the scene is accessed from outside of the
+     * current tool, e.g. before saving (see `Tool::finish`) */
+    void            finishTool         ();
     void            fromConfig         ();
     void            undo               ();
     void            redo               ();
@@ -0,0 +1,299 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "task-pool.hpp"
+
+namespace {
+  typedef std::function <void ()> Task;
+
+  // Detached tasks are only executed by workers, but not by threads that wait for a group
+  struct Entry {
+    Task task;
+    bool isDetached;
+  };
+
+  struct Worker {
+    std::mutex         mutex;
+    std::deque <Entry> entries;
+  };
+
+  unsigned int hardwareThreads () {
+    return std::max (1u, std::thread::hardware_concurrency ());
+  }
+}
+
+struct TaskPool::Impl {
+  std::vector <std::unique_ptr <Worker>> workers;
+  std::vector <std::thread>              threads;
+  unsigned int                           numThreads;
+  std::mutex                             sleepMutex;
+  std::condition_variable                wakeUp;
+  std::atomic <unsigned int>             numQueued;
+  std::atomic <unsigned int>             nextWorker;
+  bool                                   stop;
+
+  // the pool and the index of the worker that is executed by the current thread
+  static thread_local const Impl*        currentPool;
+  static thread_local unsigned int       currentWorker;
+
+  Impl (unsigned int n)
+    : numThreads (0)
+    , numQueued  (0)
+    , nextWorker (0)
+    , stop       (false)
+  {
+    this->start (n);
+  }
+
+  ~Impl () {
+    this->shutdown ();
+  }
+
+  void start (unsigned int n) {
+    assert (this->threads.empty ());
+
+    this->numThreads = n > 0 ? n : hardwareThreads ();
+    this->stop       = false;
+
+    const unsigned int numWorkers = std::max (1u, this->numThreads - 1);
+
+    for (unsigned int i = 0; i < numWorkers; i++) {
+      this->workers.emplace_back (new Worker);
+    }
+    for (unsigned int i = 0; i < numWorkers; i++) {
+      this->threads.emplace_back ([this, i] () { this->run (i); });
+    }
+  }
+
+  // Workers exit once all queued tasks have been executed
+  void shutdown () {
+    {
+      std::lock_guard <std::mutex> lock (this->sleepMutex);
+      this->stop = true;
+    }
+    this->wakeUp.notify_all ();
+
+    for (std::thread& thread : this->threads) {
+      thread.join ();
+    }
+    this->threads.clear ();
+    this->workers.clear ();
+  }
+
+  void setNumThreads (unsigned int n) {
+    if ((n > 0 ? n : hardwareThreads ()) != this->numThreads) {
+      this->shutdown ();
+      this->start (n);
+    }
+  }
+
+  bool isWorker () const {
+    return currentPool == this;
+  }
+
+  void push (const Task& task, bool isDetached) {
+    const unsigned int w = this->isWorker ()
+                         ? currentWorker
+                         : this->nextWorker++ % this->workers.size ();
+    {
+      std::lock_guard <std::mutex> lock (this->workers[w]->mutex);
+      this->workers[w]->entries.push_back (Entry { task, isDetached });
+    }
+    {
+      std::lock_guard <std::mutex> lock (this->sleepMutex);
+      this->numQueued++;
+    }
+    this->wakeUp.notify_one ();
+  }
+
+  bool popBack (Worker& worker, bool includeDetached, Task& task) {
+    std::lock_guard <std::mutex> lock (worker.mutex);
+
+    for (auto it = worker.entries.rbegin (); it != worker.entries.rend (); ++it) {
+      if (includeDetached || it->isDetached == false) {
+        task = std::move (it->task);
+        worker.entries.erase (std::next (it).base ());
+        this->numQueued--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool popFront (Worker& worker, bool includeDetached, Task& task) {
+    std::lock_guard <std::mutex> lock (worker.mutex);
+
+    for (auto it = worker.entries.begin (); it != worker.entries.end (); ++it) {
+      if (includeDetached || it->isDetached == false) {
+        task = std::move (it->task);
+        worker.entries.erase (it);
+        this->numQueued--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Workers pop from the back of their own deque before they steal from the front of
+   * other deques.
+   */
+  bool pop (bool includeDetached, Task& task) {
+    const unsigned int n = this->workers.size ();
+
+    if (this->isWorker ()) {
+      if (this->popBack (*this->workers[currentWorker], includeDetached, task)) {
+        return true;
+      }
+      for (unsigned int i = 1; i < n; i++) {
+        if (this->popFront (*this->workers[(currentWorker + i) % n], includeDetached, task)) {
+          return true;
+        }
+      }
+    }
+    else {
+      for (unsigned int i = 0; i < n; i++) {
+        if (this->popFront (*this->workers[i], includeDetached, task)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void run (unsigned int index) {
+    currentPool   = this;
+    currentWorker = index;
+
+    for (;;) {
+      Task task;
+
+      if (this->pop (true, task)) {
+        task ();
+      }
+      else {
+        std::unique_lock <std::mutex> lock (this->sleepMutex);
+        this->wakeUp.wait (lock, [this] () {
+          return this->stop || this->numQueued > 0;
+        });
+        if (this->stop && this->numQueued == 0) {
+          return;
+        }
+      }
+    }
+  }
+
+  std::future <void> async (const std::function <void ()>& f) {
+    std::shared_ptr <std::packaged_task <void ()>> task =
+      std::make_shared <std::packaged_task <void ()>> (f);
+
+    std::future <void> future = task->get_future ();
+    this->push ([task] () { (*task) (); }, true);
+    return future;
+  }
+};
+
+thread_local const TaskPool::Impl* TaskPool::Impl::currentPool   = nullptr;
+thread_local unsigned int          TaskPool::Impl::currentWorker = 0;
+
+TaskPool& TaskPool :: global () {
+  static TaskPool pool (0);
+  return pool;
+}
+
+DELEGATE1_BIG2 (TaskPool, unsigned int)
+GETTER_CONST    (unsigned int      , TaskPool, numThreads)
+DELEGATE1       (std::future <void>, TaskPool, async, const std::function <void ()>&)
+
+void TaskPool :: numThreads (unsigned int n) {
+  this->impl->setNumThreads (n);
+}
+
+struct TaskGroup::Impl {
+  TaskPool::Impl&            pool;
+  std::atomic <unsigned int> numPending;
+  std::mutex                 mutex;
+  std::condition_variable    finished;
+  std::exception_ptr         exception;
+
+  Impl (TaskPool& p)
+    : pool       (*p.impl)
+    , numPending (0)
+  {}
+
+  // exceptions of tasks are discarded if the group is destroyed without `wait`
+  ~Impl () {
+    this->waitForTasks ();
+  }
+
+  /* The last task notifies while holding `mutex`, which `wait` acquires before it returns,
+   * i.e. the group is not destroyed while it is notified.
+   * A task that throws is still counted as executed, its exception is stored if it is
+   * the first one of the group.
+   */
+  void run (const Task& task) {
+    this->numPending++;
+    this->pool.push ([this, task] () {
+      std::exception_ptr e;
+      try {
+        task ();
+      }
+      catch (...) {
+        e = std::current_exception ();
+      }
+
+      std::lock_guard <std::mutex> lock (this->mutex);
+      if (e && this->exception == nullptr) {
+        this->exception = e;
+      }
+      if (--this->numPending == 0) {
+        this->finished.notify_all ();
+      }
+    }, false);
+  }
+
+  /* Tasks of the group are pushed by the waiting thread only, i.e. if no task can be
+   * popped, all tasks of the group are running and the last one notifies `finished`.
+   */
+  void waitForTasks () {
+    while (this->numPending > 0) {
+      Task task;
+
+      if (this->pool.pop (false, task)) {
+        task ();
+      }
+      else {
+        std::unique_lock <std::mutex> lock (this->mutex);
+        this->finished.wait (lock, [this] () {
+          return this->numPending == 0;
+        });
+      }
+    }
+    std::lock_guard <std::mutex> lock (this->mutex);
+  }
+
+  void wait () {
+    this->waitForTasks ();
+
+    if (this->exception) {
+      std::exception_ptr e = this->exception;
+
+      this->exception = nullptr;
+      std::rethrow_exception (e);
+    }
+  }
+};
+
+DELEGATE1_BIG2 (TaskGroup, TaskPool&)
+DELEGATE1      (void, TaskGroup, run, const std::function <void ()>&)
+DELEGATE       (void, TaskGroup, wait)
@@ -0,0 +1,61 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TASK_POOL
+#define DILAY_TASK_POOL
+
+#include <functional>
+#include <future>
+#include "macro.hpp"
+
+/* `TaskPool` executes tasks on persistent worker threads.
+ * Each worker owns a deque of tasks: tasks that are run by a worker are pushed to the
+ * back of its own deque, which it pops in LIFO order, while idle threads steal from the
+ * front of other deques. Tasks that are run by other threads are distributed round-robin.
+ * A pool of `n` threads has `n-1` workers (but at least one), the remaining thread is
+ * the one that waits for a `TaskGroup`.
+ * `TaskPool::global ()` is shared by the whole library.
+ */
+class TaskPool {
+  public:
+    DECLARE_BIG2 (TaskPool, unsigned int)
+
+    static TaskPool&   global     ();
+
+    unsigned int       numThreads () const;
+
+    /** `numThreads (n)` executes all pending tasks and restarts the pool with `n` threads,
+     * or with the number of hardware threads if `n == 0`. It must not be called while
+     * tasks are running. */
+    void               numThreads (unsigned int);
+
+    /** `async (f)` runs `f` on a worker, the returned future becomes ready afterwards.
+     * Threads that wait for a group do not execute `f`. */
+    std::future <void> async      (const std::function <void ()>&);
+
+  private:
+    friend class TaskGroup;
+
+    IMPLEMENTATION
+};
+
+/* `TaskGroup` runs tasks on a pool and waits for them.
+ * `wait` executes pending tasks of the pool until all tasks of the group have been
+ * started, i.e. groups may be nested and waited for from inside of tasks, and then
+ * sleeps until the running tasks of the group have been executed.
+ * If tasks throw, `wait` rethrows the first exception after all tasks have been executed.
+ * A group waits for its tasks before it is destroyed.
+ */
+class TaskGroup {
+  public:
+    DECLARE_BIG2 (TaskGroup, TaskPool& = TaskPool::global ())
+
+    void run  (const std::function <void ()>&);
+    void wait ();
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
@@ -5,8 +5,8 @@
 #include "cache.hpp"
 #include "camera.hpp"
 #include "dimension.hpp"
+#include "flat-index-octree.hpp"
 #include "history.hpp"
-#include "index-octree.hpp"
 #include "intersection.hpp"
 #include "mesh.hpp"
 #include "mirror.hpp"
@@ -47,6 +47,18 @@ struct Tool::Impl {
     }
   }
 
+  void update () {
+    this->self->runUpdate ();
+  }
+
+  void finish () {
+    this->self->runFinish ();
+  }
+
+  bool isIdle () const {
+    return this->self->runIsIdle ();
+  }
+
   void pointingEvent (const ViewPointingEvent& e) {
     this->self->runPointingEvent (e);
 
@@ -98,14 +110,19 @@ struct Tool::Impl {
     this->state.history ().snapshotSketchMeshes (this->state.scene ());
   }
 
+  void recordWingedMeshes () {
+    this->state.history ().recordWingedMeshes (this->state.scene ());
+  }
+
   bool intersectsRecentOctree (const glm::ivec2& pos, Intersection& intersection) const {
     assert (this->state.history ().hasRecentOctrees ());
 
-    const PrimRay ray = this->state.camera ().ray (pos);
+    const PrimRay               ray = this->state.camera ().ray (pos);
+    FlatIndexOctree::Candidates candidates;
 
     this->state.history ().forEachRecentOctree (
-      [&ray, &intersection] (const Mesh& mesh, const IndexOctree& octree) {
-        octree.intersects (ray, [&ray, &mesh, &intersection] (unsigned int i) {
+      [&ray, &intersection, &candidates] (const Mesh& mesh, const FlatIndexOctree& octree) {
+        octree.forEachCandidate (ray, candidates, [&ray, &mesh, &intersection] (unsigned int i) {
           const PrimTriangle tri ( mesh.vertex (mesh.index ((3 * i) + 0))
                                  , mesh.vertex (mesh.index ((3 * i) + 1))
                                  , mesh.vertex (mesh.index ((3 * i) + 2)) );
@@ -196,6 +213,9 @@ struct Tool::Impl {
 DELEGATE2_BIG3_SELF (Tool, State&, const char*)
 DELEGATE        (void    , Tool, initialize)
 DELEGATE_CONST  (void            , Tool, render)
+DELEGATE        (void            , Tool, update)
+DELEGATE        (void            , Tool, finish)
+DELEGATE_CONST  (bool            , Tool, isIdle)
 DELEGATE1       (void    , Tool, pointingEvent, const ViewPointingEvent&)
 DELEGATE1       (void    , Tool, wheelEvent, const ViewWheelEvent&)
 DELEGATE1       (void    , Tool, cursorUpdate, const glm::ivec2&)
@@ -208,6 +228,7 @@ DELEGATE1_CONST (CacheProxy      , Tool, cache, const char*)
 DELEGATE        (void            , Tool, snapshotAll)
 DELEGATE        (void            , Tool, snapshotWingedMeshes)
 DELEGATE        (void            , Tool, snapshotSketchMeshes)
+DELEGATE        (void            , Tool, recordWingedMeshes)
 DELEGATE2_CONST (bool            , Tool, intersectsRecentOctree, const glm::ivec2&, Intersection&)
 DELEGATE_CONST  (bool            , Tool, hasMirror)
 DELEGATE_CONST  (const Mirror&   , Tool, mirror)
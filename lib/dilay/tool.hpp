@@ -27,6 +27,12 @@ class DILAY_LIB_EXPORT Tool {
 
     void             initialize             ();
     void             render                 () const;
+    void             update                 ();
+    /** `finish` blocks until the tool does not modify the scene asynchronously anymore,
+     * i.e. it must be called before the scene is accessed from outside of the tool */
+    void             finish                 ();
+    /** `isIdle` holds if the tool does not modify the scene asynchronously at the moment */
+    bool             isIdle                 () const;
     void             pointingEvent          (const ViewPointingEvent&);
     void             wheelEvent             (const ViewWheelEvent&);
     void             cursorUpdate           (const glm::ivec2&);
@@ -44,6 +50,7 @@ class DILAY_LIB_EXPORT Tool {
     void             snapshotAll            ();
     void             snapshotWingedMeshes   ();
     void             snapshotSketchMeshes   ();
+    void             recordWingedMeshes     ();
     bool             intersectsRecentOctree (const glm::ivec2&, Intersection&) const;
     const Mirror&    mirror                 () const;
     void             renderMirror           (bool);
@@ -62,6 +69,9 @@ class DILAY_LIB_EXPORT Tool {
     virtual const char*  key              () const = 0;
     virtual void         runInitialize    ()                         {}
     virtual void         runRender        () const                   {}
+    virtual void         runUpdate        ()                         {}
+    virtual void         runFinish        ()                         {}
+    virtual bool         runIsIdle        () const                   { return true; }
     virtual void         runPointingEvent (const ViewPointingEvent&);
     virtual void         runPressEvent    (const ViewPointingEvent&) {}
     virtual void         runMoveEvent     (const ViewPointingEvent&) {}
@@ -86,6 +96,8 @@ class DILAY_LIB_EXPORT Tool {
 
 #define DECLARE_TOOL_RUN_INITIALIZE        void         runInitialize    ();
 #define DECLARE_TOOL_RUN_RENDER            void         runRender        () const;
+#define DECLARE_TOOL_RUN_UPDATE            void         runUpdate        ();
+#define DECLARE_TOOL_RUN_FINISH            void         runFinish        ();
 #define DECLARE_TOOL_RUN_POINTING_EVENT    void         runPointingEvent (const ViewPointingEvent&);
 #define DECLARE_TOOL_RUN_PRESS_EVENT       void         runPressEvent    (const ViewPointingEvent&);
 #define DECLARE_TOOL_RUN_MOVE_EVENT        void         runMoveEvent     (const ViewPointingEvent&);
@@ -100,6 +112,8 @@ class DILAY_LIB_EXPORT Tool {
 
 #define DELEGATE_TOOL_RUN_INITIALIZE(n)        DELEGATE       (void        , n, runInitialize)
 #define DELEGATE_TOOL_RUN_RENDER(n)            DELEGATE_CONST (void        , n, runRender)
+#define DELEGATE_TOOL_RUN_UPDATE(n)            DELEGATE       (void        , n, runUpdate)
+#define DELEGATE_TOOL_RUN_FINISH(n)            DELEGATE       (void        , n, runFinish)
 #define DELEGATE_TOOL_RUN_POINTING_EVENT(n)    DELEGATE1      (void        , n, runPointingEvent, const ViewPointingEvent&)
 #define DELEGATE_TOOL_RUN_PRESS_EVENT(n)       DELEGATE1      (void        , n, runPressEvent, const ViewPointingEvent&)
 #define DELEGATE_TOOL_RUN_MOVE_EVENT(n)        DELEGATE1      (void        , n, runMoveEvent, const ViewPointingEvent&)
@@ -34,6 +34,7 @@ struct ToolConvertSketch::Impl {
   float              resolution;
   bool               moveToCenter;
   bool               smoothMesh;
+  bool               adaptive;
 
   Impl (ToolConvertSketch* s)
     : self          (s)
@@ -42,6 +43,7 @@ struct ToolConvertSketch::Impl {
     , resolution    (s->cache ().get <float> ("resolution", 0.06))
     , moveToCenter  (s->cache ().get <bool>  ("moveToCenter", true))
     , smoothMesh    (s->cache ().get <bool>  ("smoothMesh", true))
+    , adaptive      (s->cache ().get <bool>  ("adaptive", false))
   {
     this->self->renderMirror (false);
   }
@@ -56,9 +58,10 @@ struct ToolConvertSketch::Impl {
         this->self->snapshotAll ();
         sMesh.optimizePaths ();
 
-        Mesh mesh = SketchConversion::convert ( sMesh
-                                              , this->maxResolution + this->minResolution
-                                                                    - this->resolution );
+        const float resolution = this->maxResolution + this->minResolution - this->resolution;
+
+        Mesh mesh = this->adaptive ? SketchConversion::convertAdaptive (sMesh, resolution)
+                                   : SketchConversion::convert         (sMesh, resolution);
         WingedMesh& wMesh = this->self->state ().scene ()
                                                 .newWingedMesh ( this->self->state ().config ()
                                                                , mesh );
@@ -119,3 +122,12 @@ void ToolConvertSketch::setSmoothMesh(bool b)
     cache ().set ("smoothMesh", b);
 }
 
+bool ToolConvertSketch::getAdaptive() const
+{
+    return impl->adaptive;
+}
+void ToolConvertSketch::setAdaptive(bool b)
+{
+    impl->adaptive = b;
+    cache ().set ("adaptive", b);
+}
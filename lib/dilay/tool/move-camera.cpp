@@ -149,9 +149,11 @@ const glm::uvec2& resolution = cam.resolution ();
       state.setStatus(EngineStatus::Redraw);
   }
 
+  // the current tool may still modify the scene (cf. `State::finishTool`)
   void moveTo(State& state, const glm::ivec2& position) {
       Camera& cam = state.camera ();
       Intersection intersection;
+      state.finishTool ();
       if (state.scene ().intersects (cam.ray (position), intersection)) {
         cam.set ( intersection.position ()
                 , cam.position () - intersection.position ()
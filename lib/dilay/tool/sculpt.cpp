@@ -2,14 +2,21 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#if defined (DILAY_PRINT_UPLOADED_BYTES) || defined (DILAY_PRINT_SNAPSHOT_LATENCY)
+#include <iostream>
+#endif
 #include "action/sculpt.hpp"
+#include "affected-faces.hpp"
 #include "cache.hpp"
 #include "camera.hpp"
 #include "config.hpp"
 #include "history.hpp"
+#include "mesh.hpp"
 #include "mirror.hpp"
+#include "primitive/plane.hpp"
 #include "scene.hpp"
 #include "sculpt-brush.hpp"
+#include "sculpt-queue.hpp"
 #include "state.hpp"
 #include "tool/sculpt.hpp"
 #include "tool/util/movement.hpp"
@@ -17,13 +24,24 @@
 #include "view/pointing-event.hpp"
 #include "winged/face-intersection.hpp"
 
+/* Dabs are sculpted by `queue`, which owns all modifications of the brush's mesh until
+ * `finishDabs` has been called: reading the scene requires `queue.exclusive`.
+ * Remeshing and normals are computed by the queue's worker as well, the GUI thread only
+ * uploads finished meshes once per frame, i.e. `runUpdate` never waits for the worker.
+ * Since each stroke is finished when its primary button is released, the worker is idle
+ * outside of strokes.
+ */
 struct ToolSculpt::Impl {
-  ToolSculpt*       self;
-  SculptBrush       brush;
-  ViewCursor        cursor;
-  CacheProxy        commonCache;
-  bool              absoluteRadius;
-  bool              sculpted;
+  ToolSculpt*   self;
+  SculptBrush   brush;
+  SculptQueue   queue;
+  ViewCursor    cursor;
+  CacheProxy    commonCache;
+  bool          absoluteRadius;
+  bool          sculpted;
+  bool          snapshotPending;
+  unsigned long uploadedBytes;
+  float         dabSpacing;
 
   float radius;
 
@@ -32,6 +50,9 @@ struct ToolSculpt::Impl {
     , commonCache     (this->self->cache ("sculpt"))
 	, absoluteRadius  (this->commonCache.get <bool> ("absoluteRadius", true))
     , sculpted        (false)
+    , snapshotPending (false)
+    , uploadedBytes   (0)
+    , dabSpacing      (1.0f)
 	, radius          (this->commonCache.get <float> ("radius", 0.1f))
   {}
 
@@ -78,34 +99,75 @@ struct ToolSculpt::Impl {
     }
   }
 
+  void runUpdate () {
+    this->queue.update ();
+
+    if (this->queue.isIdle () == false) {
+      this->self->state ().setStatus (EngineStatus::Redraw);
+    }
+  }
+
+  void runFinish () {
+    this->finishDabs ();
+  }
+
+  bool runIsIdle () const {
+    return this->queue.isIdle ();
+  }
+
+  void runClose () {
+    this->finishDabs ();
+  }
+
   void runPointingEvent (const ViewPointingEvent& e) {
     if (e.releaseEvent ()) {
       if (e.primaryButton ()) {
+        this->finishDabs ();
         this->brush.resetPointOfAction ();
 
-        if (this->sculpted == false) {
+        if (this->snapshotPending) {
+          this->snapshotPending = false;
+        }
+        else if (this->sculpted == false) {
           this->self->state ().history ().dropSnapshot ();
         }
+        else {
+#ifdef DILAY_PRINT_UPLOADED_BYTES
+          std::cout << "uploaded bytes per stroke: " 
+                    << (Mesh::uploadedBytes () - this->uploadedBytes) << std::endl;
+#endif
+#ifdef DILAY_PRINT_SNAPSHOT_LATENCY
+          const History& history = this->self->state ().history ();
+          std::cout << "snapshot latency per stroke: "
+                    << history.blockingLatency () << "ms blocking, "
+                    << history.totalLatency () << "ms total" << std::endl;
+#endif
+        }
       }
       this->cursor.enable ();
       this->self->state().setStatus(EngineStatus::Redraw);
     }
     else {
       if (e.pressEvent () && e.primaryButton ()) {
-        this->self->snapshotWingedMeshes ();
-        this->sculpted = false;
+        this->snapshotPending = true;
+        this->sculpted        = false;
+        this->uploadedBytes   = Mesh::uploadedBytes ();
       }
 
-      if (this->self->runSculptPointingEvent (e)) {
-        this->sculpted = true;
-      }
+      this->queue.exclusive ([this, &e] () {
+        if (this->self->runSculptPointingEvent (e)) {
+          this->sculpted = true;
+        }
+      });
       this->self->state().setStatus(EngineStatus::Redraw);
     }
   }
 
 
   void runCursorUpdate (const glm::ivec2& pos) {
-    this->updateBrushAndCursorByIntersection (pos, false, false);
+    this->queue.exclusive ([this, &pos] () {
+      this->updateBrushAndCursorByIntersection (pos, false, false);
+    });
     this->self->state().setStatus(EngineStatus::Redraw);
   }
 
@@ -115,15 +177,74 @@ struct ToolSculpt::Impl {
 	this->brush.detailFactor    (config.get <float> ("editor/tool/sculpt/detailFactor"));
 	this->brush.stepWidthFactor (config.get <float> ("editor/tool/sculpt/stepWidthFactor"));
 
+    this->dabSpacing = glm::max (0.0f, config.get <float> ("editor/tool/sculpt/dabSpacing"));
+
 	this->cursor.color  (this->self->config ().get <Color> ("editor/tool/sculpt/cursorColor"));
   }
 
+  /* Snapshots are taken lazily before the first modification of a stroke:
+   * strokes that intersect the recent octrees need a full snapshot,
+   * all other strokes only record the touched vertices and faces.
+   */
+  void snapshot (bool useRecentOctree) {
+    if (this->snapshotPending) {
+      if (useRecentOctree) {
+        this->self->snapshotWingedMeshes ();
+      }
+      else {
+        this->self->recordWingedMeshes ();
+      }
+      this->snapshotPending = false;
+    }
+  }
+
+  /* Dabs only displace vertices: remeshing, normals and the buffer upload of all
+   * pending dabs are done once per frame by `queue.update`.
+   * The snapshot is taken before the first dab is posted, and a dab and its mirrored
+   * counterpart are sculpted by a single command, i.e. the worker executes them in
+   * input order.
+   */
   void sculpt () {
-    Action::sculpt (this->brush);
+    this->snapshot (false);
+
     if (this->self->hasMirror ()) {
-      this->brush.mirror (this->self->mirror ().plane ());
-      Action::sculpt (this->brush);
-      this->brush.mirror (this->self->mirror ().plane ());
+      this->queue.mirroredDab (this->brush, this->self->mirror ().plane ());
+    }
+    else {
+      this->queue.dab (this->brush);
+    }
+  }
+
+  /* Carvelike dabs are placed along the path from the last to the current point of
+   * action, such that their distance is at most `dabSpacing` times the step width.
+   */
+  void sculptAlongPath () {
+    const glm::vec3    from     = this->brush.lastPosition ();
+    const glm::vec3    to       = this->brush.position ();
+    const glm::vec3    normal   = this->brush.direction ();
+    const float        spacing  = this->dabSpacing * this->brush.stepWidth ();
+    const unsigned int numSteps = spacing > 0.0f
+                                ? (unsigned int) (glm::distance (from, to) / spacing)
+                                : 0;
+    if (numSteps <= 1) {
+      this->sculpt ();
+    }
+    else {
+      for (unsigned int i = 1; i <= numSteps; i++) {
+        this->brush.setPointOfAction (glm::mix (from, to, float (i) / float (numSteps)), normal);
+        this->sculpt ();
+      }
+    }
+  }
+
+  void finishDabs () {
+    this->queue.finish ();
+  }
+
+  void setBrushMesh (WingedMesh& mesh) {
+    if (this->brush.mesh () != &mesh) {
+      this->finishDabs ();
+      this->brush.mesh (&mesh);
     }
   }
 
@@ -141,9 +262,11 @@ struct ToolSculpt::Impl {
       }
 
       if (buttonPressed) {
-        this->brush.mesh (&intersection.mesh ());
+        this->setBrushMesh (intersection.mesh ());
 
-        if (useRecentOctree) {
+        // the first sample of a stroke does not need to wait for the recent octrees,
+        // since the scene has not been modified yet
+        if (useRecentOctree && this->sculpted) {
           Intersection octreeIntersection;
           if (this->self->intersectsRecentOctree (pos, octreeIntersection)) {
             return this->brush.updatePointOfAction ( octreeIntersection.position ()
@@ -177,6 +300,8 @@ struct ToolSculpt::Impl {
   bool carvelikeStroke ( const ViewPointingEvent& e, bool useRecentOctree
                        , const std::function <void ()>* toggle )
   {
+    this->snapshot (useRecentOctree);
+
     if (this->updateBrushAndCursorByIntersection (e, useRecentOctree)) {
       const float defaultIntesity = this->brush.intensity ();
 
@@ -184,11 +309,11 @@ struct ToolSculpt::Impl {
 
       if (toggle && e.modifiers () == KeyboardModifiers::ShiftModifier) {
         (*toggle) ();
-        this->sculpt ();
+        this->sculptAlongPath ();
         (*toggle) ();
       }
       else {
-        this->sculpt ();
+        this->sculptAlongPath ();
       }
 
       this->brush.intensity (defaultIntesity);
@@ -203,7 +328,7 @@ struct ToolSculpt::Impl {
     if (e.primaryButton ()) {
       WingedFaceIntersection intersection;
       if (this->self->intersectsScene (e, intersection)) {
-        this->brush.mesh (&intersection.mesh ());
+        this->setBrushMesh (intersection.mesh ());
         this->brush.setPointOfAction (intersection.position (), intersection.normal ());
         
         this->cursor.disable ();
@@ -279,8 +404,12 @@ DELEGATE2       (bool        , ToolSculpt, initializeDraglikeStroke, const ViewP
 DELEGATE2       (bool        , ToolSculpt, draglikeStroke, const ViewPointingEvent&, ToolUtilMovement&)
 DELEGATE        (void        , ToolSculpt, runInitialize)
 DELEGATE_CONST  (void        , ToolSculpt, runRender)
+DELEGATE        (void        , ToolSculpt, runUpdate)
+DELEGATE        (void        , ToolSculpt, runFinish)
+DELEGATE_CONST  (bool        , ToolSculpt, runIsIdle)
 DELEGATE1       (void        , ToolSculpt, runPointingEvent, const ViewPointingEvent&)
 DELEGATE1       (void        , ToolSculpt, runCursorUpdate, const glm::ivec2&)
+DELEGATE        (void        , ToolSculpt, runClose)
 DELEGATE        (void        , ToolSculpt, runFromConfig)
 
 
@@ -330,6 +459,7 @@ void ToolSculpt::subdivide(bool b)
 
 void ToolSculpt::syncMirror()
 {
+	impl->finishDabs ();
 	mirrorWingedMeshes ();
     state().setStatus(EngineStatus::Redraw);
 }
@@ -42,8 +42,12 @@ class DILAY_LIB_EXPORT ToolSculpt : public Tool {
 
     void         runInitialize    ();
     void         runRender        () const;
+    void         runUpdate        ();
+    void         runFinish        ();
+    bool         runIsIdle        () const;
     void         runPointingEvent (const ViewPointingEvent&);
     void         runCursorUpdate  (const glm::ivec2&);
+    void         runClose         ();
     void         runFromConfig    ();
 
     virtual const char* key                    () const = 0;
@@ -89,6 +89,8 @@ DECLARE_TOOL2(ToolConvertSketch, "convert-sketch", DECLARE_TOOL_RUN_RELEASE_EVEN
                                                    void setMoveToCenter(bool b);
                                                    bool getSmoothMesh() const;
                                                    void setSmoothMesh(bool b);
+                                                   bool getAdaptive() const;
+                                                   void setAdaptive(bool b);
 )
 
 DECLARE_TOOL2 (ToolSketchSpheres, "sketch-spheres", DECLARE_TOOL_RUN_INITIALIZE
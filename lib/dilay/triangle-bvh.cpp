@@ -0,0 +1,570 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <limits>
+#include "intersection.hpp"
+#include "mesh.hpp"
+#include "primitive/ray.hpp"
+#include "primitive/triangle.hpp"
+#include "triangle-bvh.hpp"
+
+namespace {
+  typedef std::uint32_t Index;
+
+  static constexpr Index        none                  = std::numeric_limits <Index>::max ();
+  static constexpr Index        overflow              = none - 1;
+  static constexpr unsigned int numBins               = 16;
+  static constexpr unsigned int maxLeafSize           = 4;
+  static constexpr unsigned int maxSahLeafSize        = 16;
+  static constexpr float        traversalCost         = 1.0f;
+  static constexpr unsigned int minOverflowForRebuild = 256;
+  static constexpr float        maxSahCostGrowth      = 1.5f;
+
+  struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    Bounds ()
+      : min (std::numeric_limits <float>::max ())
+      , max (std::numeric_limits <float>::lowest ())
+    {}
+
+    bool isEmpty () const {
+      return this->min.x > this->max.x;
+    }
+
+    void extend (const glm::vec3& p) {
+      this->min = glm::min (this->min, p);
+      this->max = glm::max (this->max, p);
+    }
+
+    void extend (const Bounds& b) {
+      this->min = glm::min (this->min, b.min);
+      this->max = glm::max (this->max, b.max);
+    }
+
+    float area () const {
+      if (this->isEmpty ()) {
+        return 0.0f;
+      }
+      else {
+        const glm::vec3 d = this->max - this->min;
+        return 2.0f * ((d.x * d.y) + (d.y * d.z) + (d.z * d.x));
+      }
+    }
+
+    /** `intersects (o,i,l,t)` computes the entry parameter `t` of a ray with origin `o`
+     * and inverse direction `i`, where `l` denotes if the ray is an unbounded line. */
+    bool intersects ( const glm::vec3& origin, const glm::vec3& invDirection, bool isLine
+                    , float& tNear ) const
+    {
+      if (this->isEmpty ()) {
+        return false;
+      }
+      const glm::vec3 lowerTs = (this->min - origin) * invDirection;
+      const glm::vec3 upperTs = (this->max - origin) * invDirection;
+      const glm::vec3 minTs   = glm::min (lowerTs, upperTs);
+      const glm::vec3 maxTs   = glm::max (lowerTs, upperTs);
+      const float     tMin    = glm::max (glm::max (minTs.x, minTs.y), minTs.z);
+      const float     tMax    = glm::min (glm::min (maxTs.x, maxTs.y), maxTs.z);
+
+      tNear = tMin;
+      return (tMax >= 0.0f || isLine) && tMin <= tMax;
+    }
+  };
+
+  struct TriangleBvhNode {
+    Bounds bounds;
+    Index  first; // first child (inner node) or first face reference (leaf)
+    Index  count; // number of face references, 0 for inner nodes
+
+    TriangleBvhNode ()
+      : first (none)
+      , count (0)
+    {}
+
+    bool isLeaf () const {
+      return this->count > 0;
+    }
+  };
+
+  struct BuildItem {
+    Index     face;
+    Bounds    bounds;
+    glm::vec3 centroid;
+  };
+
+  PrimTriangle triangle (const Mesh& mesh, Index face) {
+    return PrimTriangle ( mesh.vertex (mesh.index ((3 * face) + 0))
+                        , mesh.vertex (mesh.index ((3 * face) + 1))
+                        , mesh.vertex (mesh.index ((3 * face) + 2)) );
+  }
+
+  Bounds triangleBounds (const PrimTriangle& tri) {
+    Bounds bounds;
+    bounds.extend (tri.vertex1 ());
+    bounds.extend (tri.vertex2 ());
+    bounds.extend (tri.vertex3 ());
+    return bounds;
+  }
+}
+
+struct TriangleBvh::Impl {
+  typedef TriangleBvhNode Node;
+
+  /* `faceLeaf [f]` is the leaf that contains face `f`, `overflow` if `f` is stored in
+   * `overflowFaces` at position `faceSlot [f]`, or `none` if `f` is not part of the bvh.
+   * References in `faceRefs` to faces that have moved to another place are stale and
+   * ignored.
+   * `weightedArea` is the sum of the areas of all nodes weighted by their SAH costs,
+   * which is kept up to date by `refit`. `buildSahCost` is the SAH cost after `build`.
+   */
+  std::vector <Node>  nodes;
+  std::vector <Index> parents;
+  std::vector <Index> faceRefs;
+  std::vector <Index> faceLeaf;
+  std::vector <Index> faceSlot;
+  std::vector <Index> overflowFaces;
+  std::vector <Index> dirtyFaces;
+  std::vector <bool>  isDirty;
+  unsigned int        numFaces;
+  double              weightedArea;
+  float               buildSahCost;
+
+  Impl ()
+    : numFaces     (0)
+    , weightedArea (0.0)
+    , buildSahCost (0.0f)
+  {}
+
+  bool isEmpty () const {
+    return this->nodes.empty () && this->overflowFaces.empty ();
+  }
+
+  void reset () {
+    this->nodes        .clear ();
+    this->parents      .clear ();
+    this->faceRefs     .clear ();
+    this->faceLeaf     .clear ();
+    this->faceSlot     .clear ();
+    this->overflowFaces.clear ();
+    this->dirtyFaces   .clear ();
+    this->isDirty      .clear ();
+    this->numFaces     = 0;
+    this->weightedArea = 0.0;
+    this->buildSahCost = 0.0f;
+  }
+
+  static double weightedNodeArea (const Node& node) {
+    return double (node.bounds.area ()) * (node.isLeaf () ? double (node.count) : double (traversalCost));
+  }
+
+  float sahCost () const {
+    if (this->nodes.empty ()) {
+      return 0.0f;
+    }
+    const double rootArea = double (this->nodes [0].bounds.area ());
+    return rootArea > 0.0 ? float (this->weightedArea / rootArea) : 0.0f;
+  }
+
+  void resizeFaceMaps (Index face) {
+    if (face >= this->faceLeaf.size ()) {
+      this->faceLeaf.resize (face + 1, none);
+      this->faceSlot.resize (face + 1, none);
+      this->isDirty .resize (face + 1, false);
+    }
+  }
+
+  Index makeNode (Index parent) {
+    this->nodes  .emplace_back ();
+    this->parents.push_back    (parent);
+    return Index (this->nodes.size () - 1);
+  }
+
+  bool findSplit ( const std::vector <BuildItem>& items, Index begin, Index end
+                 , const Bounds& bounds, const Bounds& centroidBounds
+                 , unsigned int& splitAxis, float& splitPosition ) const
+  {
+    const Index count      = end - begin;
+    const float leafCost   = float (count);
+    const float nodeArea   = glm::max (bounds.area (), std::numeric_limits <float>::min ());
+    float       bestCost   = std::numeric_limits <float>::max ();
+    bool        foundSplit = false;
+
+    for (unsigned int axis = 0; axis < 3; axis++) {
+      const float extent = centroidBounds.max [axis] - centroidBounds.min [axis];
+
+      if (extent <= 0.0f) {
+        continue;
+      }
+      Bounds       binBounds [numBins];
+      unsigned int binCounts [numBins] = {};
+      const float  scale               = float (numBins) / extent;
+
+      for (Index i = begin; i < end; i++) {
+        const float        offset = items [i].centroid [axis] - centroidBounds.min [axis];
+        const unsigned int b      = glm::min (numBins - 1, (unsigned int) (offset * scale));
+
+        binBounds [b].extend (items [i].bounds);
+        binCounts [b]++;
+      }
+
+      float        leftAreas  [numBins - 1];
+      unsigned int leftCounts [numBins - 1];
+      Bounds       left;
+      unsigned int leftCount = 0;
+
+      for (unsigned int b = 0; b < numBins - 1; b++) {
+        left.extend (binBounds [b]);
+        leftCount     += binCounts [b];
+        leftAreas  [b] = left.area ();
+        leftCounts [b] = leftCount;
+      }
+
+      Bounds       right;
+      unsigned int rightCount = 0;
+
+      for (unsigned int b = numBins - 1; b > 0; b--) {
+        right.extend (binBounds [b]);
+        rightCount += binCounts [b];
+
+        if (leftCounts [b - 1] > 0 && rightCount > 0) {
+          const float cost = traversalCost
+                           + ( (leftAreas [b - 1] * float (leftCounts [b - 1]))
+                             + (right.area () * float (rightCount)) ) / nodeArea;
+          if (cost < bestCost) {
+            bestCost      = cost;
+            splitAxis     = axis;
+            splitPosition = centroidBounds.min [axis] + (float (b) / scale);
+            foundSplit    = true;
+          }
+        }
+      }
+    }
+    return foundSplit && (bestCost < leafCost || count > maxSahLeafSize);
+  }
+
+  void build (const Mesh& mesh, const std::vector <unsigned int>& faces) {
+    this->reset ();
+
+    if (faces.empty ()) {
+      return;
+    }
+    std::vector <BuildItem> items;
+    items.reserve (faces.size ());
+
+    for (unsigned int f : faces) {
+      const Bounds bounds = triangleBounds (triangle (mesh, f));
+      items.push_back ({ f, bounds, (bounds.min + bounds.max) * 0.5f });
+      this->resizeFaceMaps (f);
+    }
+
+    struct Task {
+      Index node;
+      Index begin;
+      Index end;
+    };
+    std::vector <Task> tasks;
+
+    this->nodes  .reserve ((2 * items.size ()) / maxLeafSize);
+    this->parents.reserve ((2 * items.size ()) / maxLeafSize);
+    tasks.push_back ({ this->makeNode (none), 0, Index (items.size ()) });
+
+    while (tasks.empty () == false) {
+      const Task task = tasks.back ();
+      tasks.pop_back ();
+
+      Bounds bounds;
+      Bounds centroidBounds;
+
+      for (Index i = task.begin; i < task.end; i++) {
+        bounds        .extend (items [i].bounds);
+        centroidBounds.extend (items [i].centroid);
+      }
+      this->nodes [task.node].bounds = bounds;
+
+      unsigned int axis;
+      float        position;
+
+      if ( task.end - task.begin > maxLeafSize
+        && this->findSplit (items, task.begin, task.end, bounds, centroidBounds, axis, position) )
+      {
+        auto mid = std::partition ( items.begin () + task.begin, items.begin () + task.end
+                                  , [axis, position] (const BuildItem& item) {
+                                      return item.centroid [axis] < position;
+                                    });
+        Index split = Index (mid - items.begin ());
+
+        if (split == task.begin || split == task.end) {
+          split = task.begin + ((task.end - task.begin) / 2);
+        }
+        const Index left  = this->makeNode (task.node);
+        const Index right = this->makeNode (task.node);
+
+        assert (right == left + 1);
+        this->nodes [task.node].first = left;
+        this->nodes [task.node].count = 0;
+
+        tasks.push_back ({ right, split, task.end });
+        tasks.push_back ({ left, task.begin, split });
+      }
+      else {
+        this->nodes [task.node].first = task.begin;
+        this->nodes [task.node].count = task.end - task.begin;
+      }
+    }
+
+    this->faceRefs.reserve (items.size ());
+    for (const BuildItem& item : items) {
+      this->faceRefs.push_back (item.face);
+    }
+    for (Index n = 0; n < this->nodes.size (); n++) {
+      const Node& node = this->nodes [n];
+
+      if (node.isLeaf ()) {
+        for (Index i = node.first; i < node.first + node.count; i++) {
+          this->faceLeaf [this->faceRefs [i]] = n;
+        }
+      }
+    }
+    this->numFaces = items.size ();
+
+    for (const Node& node : this->nodes) {
+      this->weightedArea += weightedNodeArea (node);
+    }
+    this->buildSahCost = this->sahCost ();
+  }
+
+  void updateFace (unsigned int face) {
+    if (this->isEmpty () == false) {
+      this->resizeFaceMaps (face);
+
+      if (this->isDirty [face] == false) {
+        this->isDirty [face] = true;
+        this->dirtyFaces.push_back (face);
+      }
+    }
+  }
+
+  void deleteFace (unsigned int face) {
+    if (face < this->faceLeaf.size ()) {
+      const Index leaf = this->faceLeaf [face];
+
+      if (leaf == overflow) {
+        const Index slot = this->faceSlot [face];
+        const Index last = this->overflowFaces.back ();
+
+        this->overflowFaces [slot] = last;
+        this->faceSlot [last]      = slot;
+        this->overflowFaces.pop_back ();
+      }
+      if (leaf != none) {
+        this->numFaces--;
+      }
+      this->faceLeaf [face] = none;
+      this->faceSlot [face] = none;
+      this->isDirty  [face] = false;
+    }
+  }
+
+  /* A rebuild is needed if too many faces are tested linearly, or if refitting has
+   * degraded the hierarchy, e.g. because faces have been stretched far beyond their
+   * original leaves.
+   */
+  bool needsRebuild () const {
+    return this->overflowFaces.size () > glm::max (minOverflowForRebuild, this->numFaces / 8)
+        || this->sahCost () > this->buildSahCost * maxSahCostGrowth;
+  }
+
+  void refit (const Mesh& mesh) {
+    if (this->dirtyFaces.empty ()) {
+      return;
+    }
+    std::vector <Index> marked;
+    std::vector <bool>  isMarked (this->nodes.size (), false);
+
+    for (Index face : this->dirtyFaces) {
+      if (this->isDirty [face] == false) {
+        continue;
+      }
+      this->isDirty [face] = false;
+
+      const Index leaf = this->faceLeaf [face];
+
+      if (leaf == none) {
+        this->faceLeaf [face] = overflow;
+        this->faceSlot [face] = this->overflowFaces.size ();
+        this->overflowFaces.push_back (face);
+        this->numFaces++;
+      }
+      else if (leaf != overflow) {
+        for (Index n = leaf; n != none && isMarked [n] == false; n = this->parents [n]) {
+          isMarked [n] = true;
+          marked.push_back (n);
+        }
+      }
+    }
+    this->dirtyFaces.clear ();
+
+    // children are stored after their parents
+    std::sort (marked.begin (), marked.end (), [] (Index a, Index b) { return a > b; });
+
+    for (Index n : marked) {
+      Node&  node = this->nodes [n];
+      Bounds bounds;
+
+      this->weightedArea -= weightedNodeArea (node);
+
+      if (node.isLeaf ()) {
+        for (Index i = node.first; i < node.first + node.count; i++) {
+          const Index face = this->faceRefs [i];
+
+          if (this->faceLeaf [face] == n) {
+            bounds.extend (triangleBounds (triangle (mesh, face)));
+          }
+        }
+      }
+      else {
+        bounds.extend (this->nodes [node.first + 0].bounds);
+        bounds.extend (this->nodes [node.first + 1].bounds);
+      }
+      node.bounds         = bounds;
+      this->weightedArea += weightedNodeArea (node);
+    }
+  }
+
+  bool intersects (const Mesh& mesh, const PrimRay& ray, unsigned int& face, float& t) const {
+    bool  isIntersection = false;
+    float nearest        = std::numeric_limits <float>::max ();
+
+    auto intersectsFace = [&] (Index f) {
+      const PrimTriangle tri = triangle (mesh, f);
+      float              tFace;
+
+      if (IntersectionUtil::intersects (ray, tri, &tFace) && tFace < nearest) {
+        nearest        = tFace;
+        face           = f;
+        isIntersection = true;
+      }
+    };
+
+    for (Index f : this->overflowFaces) {
+      intersectsFace (f);
+    }
+
+    if (this->nodes.empty () == false) {
+      struct Entry {
+        Index node;
+        float tNear;
+      };
+      const glm::vec3     origin       = ray.origin ();
+      const glm::vec3     invDirection = glm::vec3 (1.0f) / ray.direction ();
+      const bool          isLine       = ray.isLine ();
+      std::vector <Entry> stack;
+      float               tRoot;
+
+      stack.reserve (64);
+
+      if (this->nodes [0].bounds.intersects (origin, invDirection, isLine, tRoot)) {
+        stack.push_back ({ 0, tRoot });
+      }
+      while (stack.empty () == false) {
+        const Entry entry = stack.back ();
+        stack.pop_back ();
+
+        if (entry.tNear > nearest) {
+          continue;
+        }
+        const Node& node = this->nodes [entry.node];
+
+        if (node.isLeaf ()) {
+          for (Index i = node.first; i < node.first + node.count; i++) {
+            if (this->faceLeaf [this->faceRefs [i]] == entry.node) {
+              intersectsFace (this->faceRefs [i]);
+            }
+          }
+        }
+        else {
+          const Index left  = node.first;
+          const Index right = node.first + 1;
+          float       tLeft, tRight;
+          const bool  hitLeft  = this->nodes [left] .bounds.intersects (origin, invDirection, isLine, tLeft);
+          const bool  hitRight = this->nodes [right].bounds.intersects (origin, invDirection, isLine, tRight);
+
+          if (hitLeft && hitRight) {
+            if (tLeft < tRight) {
+              stack.push_back ({ right, tRight });
+              stack.push_back ({ left , tLeft  });
+            }
+            else {
+              stack.push_back ({ left , tLeft  });
+              stack.push_back ({ right, tRight });
+            }
+          }
+          else if (hitLeft) {
+            stack.push_back ({ left, tLeft });
+          }
+          else if (hitRight) {
+            stack.push_back ({ right, tRight });
+          }
+        }
+      }
+    }
+    if (isIntersection) {
+      t = nearest;
+    }
+    return isIntersection;
+  }
+
+  void printStatistics () const {
+    unsigned int numLeaves = 0;
+    unsigned int maxDepth  = 0;
+    std::vector <std::pair <Index, unsigned int>> stack;
+
+    if (this->nodes.empty () == false) {
+      stack.push_back ({ 0, 0 });
+    }
+    while (stack.empty () == false) {
+      const auto entry = stack.back ();
+      stack.pop_back ();
+
+      maxDepth = glm::max (maxDepth, entry.second);
+
+      if (this->nodes [entry.first].isLeaf ()) {
+        numLeaves++;
+      }
+      else {
+        stack.push_back ({ this->nodes [entry.first].first + 0, entry.second + 1 });
+        stack.push_back ({ this->nodes [entry.first].first + 1, entry.second + 1 });
+      }
+    }
+    std::cout << "bvh:"
+              << "\n\tnum nodes:\t\t\t"        << this->nodes.size ()
+              << "\n\tnum leaves:\t\t\t"       << numLeaves
+              << "\n\tnum faces:\t\t\t"        << this->numFaces
+              << "\n\tnum overflow faces:\t\t" << this->overflowFaces.size ()
+              << "\n\tmax depth:\t\t\t"        << maxDepth
+              << "\n\tsah cost:\t\t\t"         << this->sahCost ()
+              << "\n\tsah cost after build:\t\t" << this->buildSahCost
+              << std::endl;
+  }
+};
+
+DELEGATE_BIG6 (TriangleBvh)
+
+DELEGATE_CONST  (bool        , TriangleBvh, isEmpty)
+DELEGATE2       (void        , TriangleBvh, build, const Mesh&, const std::vector <unsigned int>&)
+DELEGATE1       (void        , TriangleBvh, updateFace, unsigned int)
+DELEGATE1       (void        , TriangleBvh, deleteFace, unsigned int)
+DELEGATE_CONST  (bool        , TriangleBvh, needsRebuild)
+DELEGATE_CONST  (float       , TriangleBvh, sahCost)
+DELEGATE1       (void        , TriangleBvh, refit, const Mesh&)
+DELEGATE        (void        , TriangleBvh, reset)
+GETTER_CONST    (unsigned int, TriangleBvh, numFaces)
+DELEGATE4_CONST (bool        , TriangleBvh, intersects, const Mesh&, const PrimRay&, unsigned int&, float&)
+DELEGATE_CONST  (void        , TriangleBvh, printStatistics)
@@ -0,0 +1,45 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TRIANGLE_BVH
+#define DILAY_TRIANGLE_BVH
+
+#include <vector>
+#include "macro.hpp"
+
+class Mesh;
+class PrimRay;
+
+/* `TriangleBvh` is a bounding volume hierarchy over the faces of a mesh, where face `i`
+ * is the triangle of indices `3*i`, `3*i+1` and `3*i+2`.
+ * `build` partitions faces using the surface area heuristic on binned centroids.
+ * Faces that are marked by `updateFace` are refitted by the next call to `refit`:
+ * bounds of their leaves and all ancestors are recomputed, faces that are not part of
+ * the hierarchy yet are kept in an overflow list, which is tested linearly.
+ * `needsRebuild` holds if the overflow list has become too large, or if the SAH cost
+ * of the refitted hierarchy has grown too much since it has been built.
+ */
+class TriangleBvh {
+  public:
+    DECLARE_BIG6 (TriangleBvh)
+
+    bool         isEmpty         () const;
+    void         build           (const Mesh&, const std::vector <unsigned int>&);
+    void         updateFace      (unsigned int);
+    void         deleteFace      (unsigned int);
+    bool         needsRebuild    () const;
+    float        sahCost         () const;
+    void         refit           (const Mesh&);
+    void         reset           ();
+    unsigned int numFaces        () const;
+
+    /** `intersects (m,r,f,t)` finds the nearest face `f` of `m` that is hit by `r` at `t` */
+    bool         intersects      (const Mesh&, const PrimRay&, unsigned int&, float&) const;
+    void         printStatistics () const;
+
+  private:
+    IMPLEMENTATION
+};
+
+#endif
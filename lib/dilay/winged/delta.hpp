@@ -0,0 +1,47 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_WINGED_DELTA
+#define DILAY_WINGED_DELTA
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/* `WingedMeshDelta` stores the state of all vertices and faces of a winged mesh
+ * that have been touched since a recording was started (see `WingedMesh::startRecording`).
+ * Applying a delta restores positions, vertex indices and free-flags of recorded elements.
+ * Elements that have been appended during recording are not stored, since they are
+ * freed when the delta is applied (the vertex and index arrays are not truncated).
+ */
+struct WingedMeshDelta {
+  struct Vertex {
+    unsigned int index;
+    bool         isFree;
+    glm::vec3    position;
+  };
+
+  struct Face {
+    unsigned int index;
+    bool         isFree;
+    unsigned int vertexIndices [3];
+  };
+
+  unsigned int         numVertices;
+  unsigned int         numFaces;
+  std::vector <Vertex> vertices;
+  std::vector <Face>   faces;
+
+  WingedMeshDelta ()
+    : numVertices (0)
+    , numFaces    (0)
+  {}
+
+  std::size_t numBytes () const {
+    return sizeof (WingedMeshDelta)
+         + (this->vertices.capacity () * sizeof (Vertex))
+         + (this->faces   .capacity () * sizeof (Face));
+  }
+};
+
+#endif
@@ -7,20 +7,24 @@
 #include "adjacent-iterator.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
+#include "winged/mesh.hpp"
 #include "winged/vertex.hpp"
   
+namespace {
+  template <typename T>
+  unsigned int indexOf (const T* element) {
+    return element ? element->index () : WingedTopology::none;
+  }
+}
+
 WingedEdge :: WingedEdge (unsigned int i) 
-  : _index            (i)
-  , _vertex1          (nullptr)
-  , _vertex2          (nullptr)
-  , _leftFace         (nullptr)
-  , _rightFace        (nullptr)
-  , _leftPredecessor  (nullptr)
-  , _leftSuccessor    (nullptr)
-  , _rightPredecessor (nullptr)
-  , _rightSuccessor   (nullptr)
+  : _index (i)
   {}
 
+WingedMesh& WingedEdge :: mesh () const {
+  return *static_cast <WingedMesh*> (SlabIndexedList <WingedEdge>::ownerOf (*this));
+}
+
 bool WingedEdge::operator== (const WingedEdge& other) const {
   return this->_index == other._index;
 }
@@ -29,11 +33,37 @@ bool WingedEdge::operator!= (const WingedEdge& other) const {
   return ! this->operator== (other);
 }
 
+WingedVertex* WingedEdge :: vertex1 () const {
+  return this->mesh ().vertex (this->mesh ().topology ().edgeVertex1 (this->_index)); }
+
+WingedVertex* WingedEdge :: vertex2 () const {
+  return this->mesh ().vertex (this->mesh ().topology ().edgeVertex2 (this->_index)); }
+
+WingedFace* WingedEdge :: leftFace () const {
+  return this->mesh ().face (this->mesh ().topology ().edgeLeftFace (this->_index)); }
+
+WingedFace* WingedEdge :: rightFace () const {
+  return this->mesh ().face (this->mesh ().topology ().edgeRightFace (this->_index)); }
+
+WingedEdge* WingedEdge :: leftPredecessor () const {
+  return this->mesh ().edge (this->mesh ().topology ().edgeLeftPredecessor (this->_index)); }
+
+WingedEdge* WingedEdge :: leftSuccessor () const {
+  return this->mesh ().edge (this->mesh ().topology ().edgeLeftSuccessor (this->_index)); }
+
+WingedEdge* WingedEdge :: rightPredecessor () const {
+  return this->mesh ().edge (this->mesh ().topology ().edgeRightPredecessor (this->_index)); }
+
+WingedEdge* WingedEdge :: rightSuccessor () const {
+  return this->mesh ().edge (this->mesh ().topology ().edgeRightSuccessor (this->_index)); }
+
 bool WingedEdge :: isLeftFace (const WingedFace& face) const {
-  if (face == *this->_leftFace) {
+  const WingedTopology& topology = this->mesh ().topology ();
+
+  if (face.index () == topology.edgeLeftFace (this->_index)) {
     return true;
   }
-  else if (face == *this->_rightFace) {
+  else if (face.index () == topology.edgeRightFace (this->_index)) {
     return false;
   }
   else {
@@ -46,10 +76,12 @@ bool WingedEdge :: isRightFace (const WingedFace& face) const {
 }
 
 bool WingedEdge :: isVertex1 (const WingedVertex& vertex) const {
-  if (vertex == *this->_vertex1) {
+  const WingedTopology& topology = this->mesh ().topology ();
+
+  if (vertex.index () == topology.edgeVertex1 (this->_index)) {
     return true;
   }
-  else if (vertex == *this->_vertex2) {
+  else if (vertex.index () == topology.edgeVertex2 (this->_index)) {
     return false;
   }
   else {
@@ -79,6 +111,30 @@ WingedFace* WingedEdge :: otherFace (const WingedFace& face) const {
 WingedVertex* WingedEdge :: otherVertex (const WingedVertex& vertex) const {
   return this->isVertex1 (vertex) ? this->vertex2 () : this->vertex1 (); }
 
+void WingedEdge :: vertex1 (WingedVertex* v) {
+  this->mesh ().topology ().edgeVertex1 (this->_index, indexOf (v)); }
+
+void WingedEdge :: vertex2 (WingedVertex* v) {
+  this->mesh ().topology ().edgeVertex2 (this->_index, indexOf (v)); }
+
+void WingedEdge :: leftFace (WingedFace* f) {
+  this->mesh ().topology ().edgeLeftFace (this->_index, indexOf (f)); }
+
+void WingedEdge :: rightFace (WingedFace* f) {
+  this->mesh ().topology ().edgeRightFace (this->_index, indexOf (f)); }
+
+void WingedEdge :: leftPredecessor (WingedEdge* e) {
+  this->mesh ().topology ().edgeLeftPredecessor (this->_index, indexOf (e)); }
+
+void WingedEdge :: leftSuccessor (WingedEdge* e) {
+  this->mesh ().topology ().edgeLeftSuccessor (this->_index, indexOf (e)); }
+
+void WingedEdge :: rightPredecessor (WingedEdge* e) {
+  this->mesh ().topology ().edgeRightPredecessor (this->_index, indexOf (e)); }
+
+void WingedEdge :: rightSuccessor (WingedEdge* e) {
+  this->mesh ().topology ().edgeRightSuccessor (this->_index, indexOf (e)); }
+
 void WingedEdge :: setGeometry ( WingedVertex* v1, WingedVertex* v2
                                , WingedFace* left, WingedFace* right
                                , WingedEdge* leftPred , WingedEdge* leftSucc
@@ -136,8 +192,8 @@ void WingedEdge :: successor (const WingedFace& f, WingedEdge* e) {
 }
 
 glm::vec3 WingedEdge :: vector (const WingedMesh& mesh) const {
-  glm::vec3 a = this->_vertex1->position (mesh);
-  glm::vec3 b = this->_vertex2->position (mesh);
+  glm::vec3 a = this->vertex1Ref ().position (mesh);
+  glm::vec3 b = this->vertex2Ref ().position (mesh);
   return b-a;
 }
 
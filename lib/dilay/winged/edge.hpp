@@ -6,14 +6,13 @@
 #define DILAY_WINGED_EDGE
 
 #include <glm/fwd.hpp>
-#include "intrusive-list.hpp"
 #include "macro.hpp"
 
 class WingedVertex;
 class WingedFace;
 class WingedMesh;
 
-class WingedEdge : public IntrusiveList <WingedEdge>::Item {
+class WingedEdge {
   public:
     WingedEdge (unsigned int);
     WingedEdge (const WingedEdge&)  = delete;
@@ -23,14 +22,14 @@ class WingedEdge : public IntrusiveList <WingedEdge>::Item {
     bool            operator!=       (const WingedEdge&) const;
 
     unsigned int    index            () const { return this->_index; }
-    WingedVertex*   vertex1          () const { return this->_vertex1; }
-    WingedVertex*   vertex2          () const { return this->_vertex2; }
-    WingedFace*     leftFace         () const { return this->_leftFace; }
-    WingedFace*     rightFace        () const { return this->_rightFace; }
-    WingedEdge*     leftPredecessor  () const { return this->_leftPredecessor; }
-    WingedEdge*     leftSuccessor    () const { return this->_leftSuccessor; }
-    WingedEdge*     rightPredecessor () const { return this->_rightPredecessor; }
-    WingedEdge*     rightSuccessor   () const { return this->_rightSuccessor; }
+    WingedVertex*   vertex1          () const;
+    WingedVertex*   vertex2          () const;
+    WingedFace*     leftFace         () const;
+    WingedFace*     rightFace        () const;
+    WingedEdge*     leftPredecessor  () const;
+    WingedEdge*     leftSuccessor    () const;
+    WingedEdge*     rightPredecessor () const;
+    WingedEdge*     rightSuccessor   () const;
 
     bool            isLeftFace       (const WingedFace&)   const;
     bool            isRightFace      (const WingedFace&)   const;
@@ -49,14 +48,14 @@ class WingedEdge : public IntrusiveList <WingedEdge>::Item {
                                      , WingedEdge*, WingedEdge*
                                      , WingedEdge*, WingedEdge* );
 
-    void            vertex1          (WingedVertex* v) { this->_vertex1          = v; }
-    void            vertex2          (WingedVertex* v) { this->_vertex2          = v; }
-    void            leftFace         (WingedFace* f)   { this->_leftFace         = f; }
-    void            rightFace        (WingedFace* f)   { this->_rightFace        = f; }
-    void            leftPredecessor  (WingedEdge* e)   { this->_leftPredecessor  = e; }
-    void            leftSuccessor    (WingedEdge* e)   { this->_leftSuccessor    = e; }
-    void            rightPredecessor (WingedEdge* e)   { this->_rightPredecessor = e; }
-    void            rightSuccessor   (WingedEdge* e)   { this->_rightSuccessor   = e; }
+    void            vertex1          (WingedVertex*);
+    void            vertex2          (WingedVertex*);
+    void            leftFace         (WingedFace*);
+    void            rightFace        (WingedFace*);
+    void            leftPredecessor  (WingedEdge*);
+    void            leftSuccessor    (WingedEdge*);
+    void            rightPredecessor (WingedEdge*);
+    void            rightSuccessor   (WingedEdge*);
 
     void            firstVertex      (const WingedFace&, WingedVertex*);
     void            secondVertex     (const WingedFace&, WingedVertex*);
@@ -96,19 +95,9 @@ class WingedEdge : public IntrusiveList <WingedEdge>::Item {
     SAFE_REF2_CONST (WingedVertex, vertex, const WingedFace&, unsigned int)
 
   private:
-    const unsigned int _index;
-
-    WingedVertex*      _vertex1;
-    WingedVertex*      _vertex2;
-
-    WingedFace*        _leftFace;
-    WingedFace*        _rightFace;
+    WingedMesh&        mesh () const;
 
-    WingedEdge*        _leftPredecessor;
-    WingedEdge*        _leftSuccessor;
-
-    WingedEdge*        _rightPredecessor;
-    WingedEdge*        _rightSuccessor;
+    const unsigned int _index;
 };
 
 #endif
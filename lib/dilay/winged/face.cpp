@@ -10,10 +10,13 @@
 #include "winged/vertex.hpp"
 
 WingedFace :: WingedFace (unsigned int i)
-  : _index      (i)
-  , _edge       (nullptr)
+  : _index (i)
   {}
 
+WingedMesh& WingedFace :: mesh () const {
+  return *static_cast <WingedMesh*> (SlabIndexedList <WingedFace>::ownerOf (*this));
+}
+
 bool WingedFace::operator== (const WingedFace& other) const {
   return this->_index == other._index;
 }
@@ -22,8 +25,16 @@ bool WingedFace::operator!= (const WingedFace& other) const {
   return ! this->operator== (other);
 }
 
+WingedEdge* WingedFace :: edge () const {
+  return this->mesh ().edge (this->mesh ().topology ().faceEdge (this->_index));
+}
+
+void WingedFace :: edge (WingedEdge* e) {
+  this->mesh ().topology ().faceEdge (this->_index, e ? e->index () : WingedTopology::none);
+}
+
 WingedVertex* WingedFace :: vertex (unsigned int index) const { 
-  return this->_edge->vertex (*this, index);
+  return this->edgeRef ().vertex (*this, index);
 }
 
 void WingedFace :: writeIndices (WingedMesh& mesh) {
@@ -5,7 +5,6 @@
 #ifndef DILAY_WINGED_FACE
 #define DILAY_WINGED_FACE
 
-#include "intrusive-list.hpp"
 #include "macro.hpp"
 
 class AdjEdges;
@@ -16,7 +15,7 @@ class WingedEdge;
 class WingedVertex;
 class WingedMesh;
 
-class WingedFace : public IntrusiveList <WingedFace>::Item {
+class WingedFace {
   public:                      
     WingedFace (unsigned int);
     WingedFace (const WingedFace&)  = delete;
@@ -26,9 +25,9 @@ class WingedFace : public IntrusiveList <WingedFace>::Item {
     bool          operator!=       (const WingedFace&) const;
 
     unsigned int  index            () const { return this->_index; }
-    WingedEdge*   edge             () const { return this->_edge; }
+    WingedEdge*   edge             () const;
 
-    void          edge             (WingedEdge*  e) { this->_edge = e; }
+    void          edge             (WingedEdge*);
 
     WingedVertex* vertex           (unsigned int) const;
     void          writeIndices     (WingedMesh&);
@@ -46,8 +45,9 @@ class WingedFace : public IntrusiveList <WingedFace>::Item {
     SAFE_REF_CONST  (WingedEdge  , edge)
     SAFE_REF1_CONST (WingedVertex, vertex, unsigned int)
   private:
+    WingedMesh&        mesh () const;
+
     const unsigned int _index;
-    WingedEdge*        _edge;
 };
 
 #endif
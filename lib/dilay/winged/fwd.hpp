@@ -8,6 +8,7 @@
 #include <list>
 #include <unordered_set>
 #include <vector>
+#include "indexed-ptr-set.hpp"
 
 class WingedMesh;
 class WingedFace;
@@ -15,9 +16,9 @@ class WingedEdge;
 class WingedVertex;
 
 typedef std::unordered_set <WingedMesh*>   MeshPtrSet;
-typedef std::unordered_set <WingedFace*>   FacePtrSet;
+typedef IndexedPtrSet      <WingedFace>    FacePtrSet;
 typedef std::unordered_set <WingedEdge*>   EdgePtrSet;
-typedef std::unordered_set <WingedVertex*> VertexPtrSet;
+typedef IndexedPtrSet      <WingedVertex>  VertexPtrSet;
 typedef std::vector        <WingedMesh*>   MeshPtrVec;
 typedef std::vector        <WingedFace*>   FacePtrVec;
 typedef std::vector        <WingedEdge*>   EdgePtrVec;
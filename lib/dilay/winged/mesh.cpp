@@ -2,25 +2,48 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
 #include "../util.hpp"
 #include "action/finalize.hpp"
+#include "adjacent-iterator.hpp"
 #include "affected-faces.hpp"
 #include "edge-map.hpp"
 #include "hash.hpp"
 #include "intersection.hpp"
 #include "mesh-util.hpp"
+#include "parallel.hpp"
 #include "primitive/ray.hpp"
 #include "primitive/triangle.hpp"
+#include "task-pool.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
 #include "winged/face-intersection.hpp"
 #include "winged/mesh.hpp"
 #include "winged/vertex.hpp"
 
+namespace {
+  static constexpr unsigned int minNumFacesForBvh     = 10000;
+  static constexpr unsigned int minElementsPerThread  = 4096;
+}
 
   WingedMesh::WingedMesh (unsigned int i)
-    : _index  (i)
-  {}
+    : _index       (i)
+    , _isRecording (false)
+    , _version     (1)
+  {
+    this->_vertices.owner (this);
+    this->_edges   .owner (this);
+    this->_faces   .owner (this);
+  }
+
+  // a pending bvh build refers to this mesh
+  WingedMesh::~WingedMesh () {
+    this->resetBvh ();
+  }
 
   bool WingedMesh::operator== (const WingedMesh& other) const {
     return this->_index == other.index ();
@@ -36,15 +59,15 @@
   glm::vec3    WingedMesh::normal (unsigned int i) const { return this->_mesh.normal (i); }
 
   WingedVertex* WingedMesh::vertex (unsigned int i) {
-    return this->_vertices.get (i);
+    return i == Util::invalidIndex () ? nullptr : this->_vertices.get (i);
   }
 
   WingedEdge* WingedMesh::edge (unsigned int i) {
-    return this->_edges.get (i);
+    return i == Util::invalidIndex () ? nullptr : this->_edges.get (i);
   }
 
   WingedFace* WingedMesh::face (unsigned int i) {
-    return this->_faces.get (i);
+    return i == Util::invalidIndex () ? nullptr : this->_faces.get (i);
   }
 
   WingedFace* WingedMesh::someDegeneratedFace () {
@@ -56,6 +79,10 @@
   WingedVertex& WingedMesh::addVertex (const glm::vec3& pos) {
     WingedVertex& vertex = this->_vertices.emplaceBack ();
 
+    this->recordVertex        (vertex.index (), true);
+    this->_topology.addVertex (vertex.index ());
+    this->touchVertex         (vertex.index ());
+
     if (vertex.index () == this->_mesh.numVertices ()) {
       this->_mesh.addVertex (pos);
     }
@@ -67,7 +94,10 @@
   }
 
   WingedEdge& WingedMesh::addEdge () {
-    return this->_edges.emplaceBack ();
+    WingedEdge& edge = this->_edges.emplaceBack ();
+
+    this->_topology.addEdge (edge.index ());
+    return edge;
   }
 
   void WingedMesh::addFaceToOctree (const WingedFace& face, const PrimTriangle& geometry) {
@@ -77,11 +107,15 @@
     else {
       this->_octree.addElement (face.index (), geometry.center (), geometry.maxDimExtent ());
     }
+    this->updateBvhFace (face.index (), geometry.isDegenerated () == false);
   }
 
   WingedFace& WingedMesh::addFace (const PrimTriangle& geometry) {
     WingedFace& face = this->_faces.emplaceBack ();
 
+    this->recordFace        (face.index (), true);
+    this->_topology.addFace (face.index ());
+
     this->addFaceToOctree (face, geometry);
 
     if (3 * face.index () == this->_mesh.numIndices ()) {
@@ -93,11 +127,17 @@
   }
 
   void WingedMesh::setIndex (unsigned int index, unsigned int vertexIndex) {
+    if (this->_isRecording) {
+      this->recordFace (index / 3, this->_faces.isFree (index / 3));
+    }
+    this->touchFace (index / 3);
     return this->_mesh.setIndex (index, vertexIndex);
   }
 
   void WingedMesh::setVertex (unsigned int index, const glm::vec3& v) {
     assert (this->_vertices.isFreeSLOW (index) == false);
+    this->recordVertex (index, false);
+    this->touchVertex  (index);
     return this->_mesh.setVertex (index,v);
   }
 
@@ -106,10 +146,27 @@
     return this->_mesh.setNormal (index,n);
   }
 
-  const IndexOctree& WingedMesh::octree () const {
+  bool WingedMesh::faceNormal (const WingedFace& face, glm::vec3& normal) const {
+    normal = this->cachedFace (face.index ()).normal;
+    return normal != glm::vec3 (0.0f);
+  }
+
+  float WingedMesh::faceArea (const WingedFace& face) const {
+    return this->cachedFace (face.index ()).area;
+  }
+
+  const FlatIndexOctree& WingedMesh::octree () const {
       return _octree;
   }
 
+  WingedTopology& WingedMesh::topology () {
+      return _topology;
+  }
+
+  const WingedTopology& WingedMesh::topology () const {
+      return _topology;
+  }
+
   const Mesh& WingedMesh::mesh () const {
       return _mesh;
   }
@@ -119,11 +176,25 @@
   }
 
   void WingedMesh::deleteFace (WingedFace& face) {
-    this->_octree.deleteElement (face.index ());
+    const unsigned int index = face.index ();
+
+    this->recordFace (index, false);
+    this->_octree.deleteElement (index);
     this->_faces.deleteElement (face);
+    this->updateBvhFace (index, false);
+    this->resetFreeFace (index);
+  }
+
+  // free faces are rendered as degenerated triangles, which are never rasterized
+  void WingedMesh::resetFreeFace (unsigned int index) {
+    this->touchFace (index);
+    this->_mesh.setIndex ((3 * index) + 0, 0);
+    this->_mesh.setIndex ((3 * index) + 1, 0);
+    this->_mesh.setIndex ((3 * index) + 2, 0);
   }
 
   void WingedMesh::deleteVertex (WingedVertex& vertex) {
+    this->recordVertex (vertex.index (), false);
     this->_vertices.deleteElement (vertex);
   }
 
@@ -133,7 +204,7 @@
   }
 
   void WingedMesh::realignFace (const WingedFace& face) {
-    this->realignFace (face.index (), face.triangle (*this));
+    this->realignFace (face, face.triangle (*this));
   }
 
   void WingedMesh::realignAllFaces () {
@@ -218,7 +289,20 @@
     return prunedMesh;
   }
 
-  void WingedMesh::fromMesh (const Mesh& mesh, const PrimPlane* mirror) {
+  void WingedMesh::fromMesh (Mesh mesh, const PrimPlane* mirror) {
+    if (mirror) {
+      this->fromMesh (MeshUtil::mirror (mesh, *mirror), {}, {});
+    }
+    else {
+      this->fromMesh (std::move (mesh), {}, {});
+    }
+  }
+
+  void WingedMesh::fromMesh ( Mesh mesh, const std::vector <unsigned int>& freeVertices
+                            , const std::vector <unsigned int>& freeFaces )
+  {
+    assert (this->_isRecording == false);
+
     EdgeMap <WingedEdge*> edgeMap;
 
     /** `findOrAddEdge (m,i1,i2,f)` searches an edge between vertices 
@@ -261,8 +345,19 @@
     // mesh
     this->reset ();
 
-    this->_mesh = bool (mirror) ? MeshUtil::mirror (mesh, *mirror)
-                               : mesh;
+    this->_mesh = std::move (mesh);
+
+    assert (this->_mesh.numIndices () % 3 == 0);
+
+    std::vector <bool> isFreeVertex (this->_mesh.numVertices (), false);
+    std::vector <bool> isFreeFace   (this->_mesh.numIndices () / 3, false);
+
+    for (unsigned int i : freeVertices) {
+      isFreeVertex.at (i) = true;
+    }
+    for (unsigned int i : freeFaces) {
+      isFreeFace.at (i) = true;
+    }
 
     // octree
     glm::vec3 minVertex, maxVertex;
@@ -276,15 +371,17 @@
 
     // vertices
     for (unsigned int i = 0; i < this->_mesh.numVertices (); i++) {
-      this->_vertices.emplaceBack ();
+      this->_topology.addVertex (this->_vertices.emplaceBack ().index ());
     }
 
     // faces & edges
-    assert (this->_mesh.numIndices () % 3 == 0);
-
     edgeMap.resize (this->_mesh.numVertices ());
 
     for (unsigned int i = 0; i < this->_mesh.numIndices (); i += 3) {
+      if (isFreeFace [i / 3]) {
+        this->_topology.addFace (this->_faces.emplaceBack ().index ());
+        continue;
+      }
       unsigned int index1 = this->_mesh.index (i + 0);
       unsigned int index2 = this->_mesh.index (i + 1);
       unsigned int index3 = this->_mesh.index (i + 2);
@@ -306,11 +403,32 @@
       e3.successor   (f, &e1);
     }
 
+    // free indices
+    for (unsigned int i : freeFaces) {
+      this->_faces.deleteElement (this->faceRef (i));
+      this->resetFreeFace (i);
+    }
+    for (unsigned int i : freeVertices) {
+      this->_vertices.deleteElement (this->vertexRef (i));
+    }
+
     if (this->_octree.numDegeneratedElements () > 0) {
       Action::collapseDegeneratedFaces (*this);
     }
     this->writeAllNormals ();
     this->bufferData      ();
+
+    if (this->numFaces () >= minNumFacesForBvh) {
+      this->buildBvhAsync ();
+    }
+  }
+
+  const std::vector <unsigned int>& WingedMesh::freeVertexIndices () const {
+    return this->_vertices.freeIndices ();
+  }
+
+  const std::vector <unsigned int>& WingedMesh::freeFaceIndices () const {
+    return this->_faces.freeIndices ();
   }
 
   void WingedMesh::writeAllIndices () {
@@ -319,26 +437,64 @@
     });
   }
 
+  /* All stale faces are cached first, such that vertex normals can be interpolated in
+   * parallel by reading the cache only.
+   * Normals are written serially, since `Mesh::setNormal` tracks the modified range.
+   */
   void WingedMesh::writeAllNormals () {
-    this->_vertices.forEachElement ([this] (WingedVertex& v) {
-      v.writeNormal (*this, v.interpolatedNormal (*this));
+    const unsigned int numFaceIndices   = this->_faces.numIndices ();
+    const unsigned int numVertexIndices = this->_vertices.numIndices ();
+    const unsigned int numThreads       = Parallel::numThreads (0);
+
+    if (this->_cachedFaces.size () < numFaceIndices) {
+      this->_cachedFaces.resize (numFaceIndices, CachedFace {});
+    }
+    Parallel::forChunks ( numFaceIndices, numThreads, minElementsPerThread
+                        , [this] (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        if (this->_faces.isFree (i) == false && this->isCached (this->_cachedFaces[i], i) == false) {
+          this->cacheFace (this->_cachedFaces[i], i);
+        }
+      }
+    });
+
+    std::vector <glm::vec3> normals (numVertexIndices);
+
+    Parallel::forChunks ( numVertexIndices, numThreads, minElementsPerThread
+                        , [this, &normals] (unsigned int begin, unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        if (this->_vertices.isFree (i) == false) {
+          normals[i] = this->_vertices.get (i)->interpolatedNormal (*this);
+        }
+      }
+    });
+
+    this->_vertices.forEachElement ([this, &normals] (WingedVertex& v) {
+      v.writeNormal (*this, normals[v.index ()]);
     });
   }
 
-  void WingedMesh::bufferData  () {
-    auto resetFreeFaceIndices = [this] () {
-      if (this->numFaces () > 0) {
-        WingedFace& someFace = this->_faces.front ();
-
-        for (unsigned int index : this->_faces.freeIndices ()) {
-          this->setIndex ((3 * index) + 0, this->index ((3 * someFace.index ()) + 0));
-          this->setIndex ((3 * index) + 1, this->index ((3 * someFace.index ()) + 1));
-          this->setIndex ((3 * index) + 2, this->index ((3 * someFace.index ()) + 2));
+  void WingedMesh::writeInterpolatedNormals (const VertexPtrSet& vertices) {
+    if (this->_cachedFaces.size () < this->_faces.numIndices ()) {
+      this->_cachedFaces.resize (this->_faces.numIndices (), CachedFace {});
+    }
+    for (WingedVertex* v : vertices) {
+      for (WingedFace& f : v->adjacentFaces ()) {
+        CachedFace& cached = this->_cachedFaces[f.index ()];
+
+        if (this->isCached (cached, f.index ()) == false) {
+          this->cacheFace (cached, f.index ());
         }
       }
-    };
+    }
+    for (WingedVertex* v : vertices) {
+      v->writeInterpolatedNormal (*this);
+    }
+  }
 
-    resetFreeFaceIndices  ();
+  void WingedMesh::bufferData  () {
     this->_mesh.bufferData ();
   }
 
@@ -354,7 +510,10 @@
     this->_vertices.reset ();
     this->_edges   .reset ();
     this->_faces   .reset ();
+    this->_topology.reset ();
     this->_octree  .reset ();
+    this->resetBvh        ();
+    this->resetFaceCache  ();
   }
 
   void WingedMesh::mirror (const PrimPlane& plane) {
@@ -369,8 +528,109 @@
   const RenderMode& WingedMesh::renderMode () const { return this->_mesh.renderMode (); }
   RenderMode&       WingedMesh::renderMode ()       { return this->_mesh.renderMode (); }
 
+  /* Bvhs are built on the global task pool from a copy of `_mesh`, which shares its
+   * geometry with `_mesh` (cf. `Mesh`). Faces that are modified in the meantime are
+   * logged in `_nextBvhFaces` and updated once the new bvh replaces `_bvh`.
+   */
+  void WingedMesh::buildBvhAsync () {
+    assert (this->_nextBvhBuilt.valid () == false);
+
+    this->_nextBvhFaces.clear ();
+    this->_nextBvhBuilt = TaskPool::global ().async (
+      [this, mesh = Mesh (this->_mesh), freeFaces = this->_faces.freeIndices ()] ()
+    {
+      std::vector <bool> isFree (mesh.numIndices () / 3, false);
+      for (unsigned int i : freeFaces) {
+        isFree [i] = true;
+      }
+
+      std::vector <unsigned int> faces;
+      faces.reserve (isFree.size ());
+
+      for (unsigned int i = 0; i < isFree.size (); i++) {
+        const PrimTriangle triangle ( mesh.vertex (mesh.index ((3 * i) + 0))
+                                    , mesh.vertex (mesh.index ((3 * i) + 1))
+                                    , mesh.vertex (mesh.index ((3 * i) + 2)) );
+
+        if (isFree [i] == false && triangle.isDegenerated () == false) {
+          faces.push_back (i);
+        }
+      }
+      this->_nextBvh.build (mesh, faces);
+    });
+  }
+
+  // `isFace` holds if face `index` exists and is not degenerated
+  void WingedMesh::updateBvhFace (unsigned int index, bool isFace) {
+    if (isFace) {
+      this->_bvh.updateFace (index);
+    }
+    else {
+      this->_bvh.deleteFace (index);
+    }
+
+    if (this->_nextBvhBuilt.valid ()) {
+      this->_nextBvhFaces.push_back (index);
+    }
+  }
+
+  void WingedMesh::resetBvh () {
+    if (this->_nextBvhBuilt.valid ()) {
+      this->_nextBvhBuilt.get ();
+      this->_nextBvh     .reset ();
+      this->_nextBvhFaces.clear ();
+    }
+    this->_bvh.reset ();
+  }
+
+  /* Returns true if `_bvh` can be used for intersection tests. A new bvh is built in
+   * the background if there is none, or if refitting has degraded the current one.
+   */
+  bool WingedMesh::updateBvh () {
+    if (this->_nextBvhBuilt.valid ()) {
+      if (this->_nextBvhBuilt.wait_for (std::chrono::seconds (0)) == std::future_status::ready) {
+        this->_nextBvhBuilt.get ();
+        this->_bvh = std::move (this->_nextBvh);
+        this->_nextBvh.reset ();
+
+        for (unsigned int i : this->_nextBvhFaces) {
+          const bool isFace = i < this->_faces.numIndices () && this->_faces.isFree (i) == false
+                           && this->faceRef (i).triangle (*this).isDegenerated () == false;
+          this->updateBvhFace (i, isFace);
+        }
+        this->_nextBvhFaces.clear ();
+      }
+    }
+    if (this->_bvh.isEmpty ()) {
+      if (this->_nextBvhBuilt.valid () == false) {
+        this->buildBvhAsync ();
+      }
+      return false;
+    }
+    this->_bvh.refit (this->_mesh);
+
+    if (this->_bvh.needsRebuild () && this->_nextBvhBuilt.valid () == false) {
+      this->buildBvhAsync ();
+    }
+    return true;
+  }
+
   bool WingedMesh::intersects (const PrimRay& ray, WingedFaceIntersection& intersection) {
-    this->_octree.intersects (ray, [this, &ray, &intersection] (unsigned int i) {
+    if (this->numFaces () >= minNumFacesForBvh && this->updateBvh ()) {
+      unsigned int index;
+      float        t;
+
+      if (this->_bvh.intersects (this->_mesh, ray, index, t)) {
+        WingedFace& face = this->faceRef (index);
+
+        intersection.update (t, ray.pointAt (t), face.triangle (*this).normal (), *this, face);
+      }
+      return intersection.isIntersection ();
+    }
+    // candidates are buffered per thread, i.e. queries of different threads do not share it
+    static thread_local FlatIndexOctree::Candidates candidates;
+
+    this->_octree.forEachCandidate (ray, candidates, [this, &ray, &intersection] (unsigned int i) {
       WingedFace&        face = this->faceRef (i);
       const PrimTriangle tri  = face.triangle (*this);
       float              t;
@@ -383,7 +643,9 @@
   }
 
   bool WingedMesh::intersects (const PrimSphere& sphere, AffectedFaces& faces) {
-    this->_octree.intersects (sphere, [this, &sphere, &faces] (unsigned int i) {
+    static thread_local FlatIndexOctree::Candidates candidates;
+
+    this->_octree.forEachCandidate (sphere, candidates, [this, &sphere, &faces] (unsigned int i) {
       WingedFace&        face = this->faceRef (i);
       const PrimTriangle tri  = face.triangle (*this);
 
@@ -395,6 +657,392 @@
     return faces.isEmpty () == false;
   }
 
+  /* Each modification of a vertex increments `_version` and assigns it to the vertex,
+   * i.e. a cached face is valid as long as its indices have not changed and none of its
+   * vertices has a newer version. The cache is reset before `_version` overflows.
+   */
+  void WingedMesh::touchVertex (unsigned int index) {
+    if (this->_version == std::numeric_limits <unsigned int>::max ()) {
+      this->resetFaceCache ();
+    }
+    if (index >= this->_vertexVersions.size ()) {
+      this->_vertexVersions.resize (index + 1, 0);
+    }
+    this->_vertexVersions[index] = ++this->_version;
+  }
+
+  void WingedMesh::touchFace (unsigned int index) {
+    if (index < this->_cachedFaces.size ()) {
+      this->_cachedFaces[index].version = 0;
+    }
+  }
+
+  unsigned int WingedMesh::vertexVersion (unsigned int index) const {
+    return index < this->_vertexVersions.size () ? this->_vertexVersions[index] : 0;
+  }
+
+  bool WingedMesh::isCached (const CachedFace& cached, unsigned int index) const {
+    if (cached.version == 0) {
+      return false;
+    }
+    for (unsigned int j = 0; j < 3; j++) {
+      if (this->vertexVersion (this->_mesh.index ((3 * index) + j)) > cached.version) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void WingedMesh::cacheFace (CachedFace& cached, unsigned int index) const {
+    const PrimTriangle triangle ( this->vector (this->_mesh.index ((3 * index) + 0))
+                                , this->vector (this->_mesh.index ((3 * index) + 1))
+                                , this->vector (this->_mesh.index ((3 * index) + 2)) );
+
+    cached.version = this->_version;
+
+    if (triangle.isDegenerated ()) {
+      cached.normal = glm::vec3 (0.0f);
+      cached.area   = 0.0f;
+    }
+    else {
+      cached.normal = triangle.normal ();
+      cached.area   = 0.5f * glm::length (triangle.cross ());
+    }
+  }
+
+  WingedMesh::CachedFace WingedMesh::cachedFace (unsigned int index) const {
+    if (index < this->_cachedFaces.size () && this->isCached (this->_cachedFaces[index], index)) {
+      return this->_cachedFaces[index];
+    }
+    else {
+      CachedFace cached;
+      this->cacheFace (cached, index);
+      return cached;
+    }
+  }
+
+  void WingedMesh::resetFaceCache () {
+    this->_version = 1;
+    this->_vertexVersions.clear ();
+    this->_cachedFaces   .clear ();
+  }
+
+  void WingedMesh::recordVertex (unsigned int index, bool isFree) {
+    if ( this->_isRecording && index < this->_delta.numVertices 
+                            && this->_recordedVertices [index] == false )
+    {
+      this->_delta.vertices.push_back ({ index, isFree, this->_mesh.vertex (index) });
+      this->_recordedVertices [index] = true;
+    }
+  }
+
+  void WingedMesh::recordFace (unsigned int index, bool isFree) {
+    if ( this->_isRecording && index < this->_delta.numFaces 
+                            && this->_recordedFaces [index] == false )
+    {
+      this->_delta.faces.push_back ({ index, isFree, { this->_mesh.index ((3 * index) + 0)
+                                                     , this->_mesh.index ((3 * index) + 1)
+                                                     , this->_mesh.index ((3 * index) + 2) } });
+      this->_recordedFaces [index] = true;
+    }
+  }
+
+  void WingedMesh::startRecording () {
+    assert (this->_mesh.numIndices () % 3 == 0);
+
+    this->_delta             = WingedMeshDelta ();
+    this->_delta.numVertices = this->_mesh.numVertices ();
+    this->_delta.numFaces    = this->_mesh.numIndices () / 3;
+    this->_isRecording       = true;
+
+    this->_recordedVertices.assign (this->_delta.numVertices, false);
+    this->_recordedFaces   .assign (this->_delta.numFaces, false);
+  }
+
+  WingedMeshDelta WingedMesh::stopRecording () {
+    assert (this->_isRecording);
+
+    this->_isRecording = false;
+    this->_recordedVertices.clear ();
+    this->_recordedFaces   .clear ();
+    this->_recordedVertices.shrink_to_fit ();
+    this->_recordedFaces   .shrink_to_fit ();
+    this->_delta.vertices  .shrink_to_fit ();
+    this->_delta.faces     .shrink_to_fit ();
+
+    return std::move (this->_delta);
+  }
+
+  bool WingedMesh::isRecording () const {
+    return this->_isRecording;
+  }
+
+  WingedMeshDelta WingedMesh::applyDelta (const WingedMeshDelta& delta) {
+    assert (this->_isRecording == false);
+    assert (this->_mesh.numIndices () % 3 == 0);
+
+    const unsigned int numVertices = this->_mesh.numVertices ();
+    const unsigned int numFaces    = this->_mesh.numIndices () / 3;
+
+    WingedMeshDelta inverse;
+    inverse.numVertices = numVertices;
+    inverse.numFaces    = numFaces;
+
+    auto saveVertex = [this, &inverse] (unsigned int i) {
+      inverse.vertices.push_back ({ i, this->_vertices.isFree (i), this->_mesh.vertex (i) });
+    };
+
+    auto saveFace = [this, &inverse] (unsigned int i) {
+      inverse.faces.push_back ({ i, this->_faces.isFree (i), { this->_mesh.index ((3 * i) + 0)
+                                                             , this->_mesh.index ((3 * i) + 1)
+                                                             , this->_mesh.index ((3 * i) + 2) } });
+    };
+
+    // inverse delta
+    for (const WingedMeshDelta::Vertex& v : delta.vertices) {
+      if (v.index < numVertices) {
+        saveVertex (v.index);
+      }
+    }
+    for (unsigned int i = delta.numVertices; i < numVertices; i++) {
+      saveVertex (i);
+    }
+    for (const WingedMeshDelta::Face& f : delta.faces) {
+      if (f.index < numFaces) {
+        saveFace (f.index);
+      }
+    }
+    for (unsigned int i = delta.numFaces; i < numFaces; i++) {
+      saveFace (i);
+    }
+
+    /* The delta is applied in place: all touched faces are detached from their edges
+     * and removed, vertices are restored, and the recorded faces are re-attached to the
+     * remaining (resp. new) edges. Edges are not part of a delta, i.e. their indices
+     * are not preserved. Elements beyond the recorded sizes become free.
+     */
+    typedef std::unordered_map <std::uint64_t, WingedEdge*> HalfEdges;
+
+    auto edgeKey = [] (unsigned int i1, unsigned int i2) {
+      return (std::uint64_t (std::min (i1, i2)) << 32) | std::uint64_t (std::max (i1, i2));
+    };
+
+    auto isLive = [] (const auto& list, unsigned int i) {
+      return i < list.numIndices () && list.isFree (i) == false;
+    };
+
+    HalfEdges                  halfEdges;
+    std::vector <unsigned int> affectedVertices;
+    std::vector <unsigned int> removedFaces;
+
+    // vertices whose edge may get deleted keep a list of their incident edges
+    std::unordered_map <unsigned int, std::vector <unsigned int>> incidentEdges;
+
+    auto affectVertex = [this, &affectedVertices, &incidentEdges, &isLive] (unsigned int v) {
+      if (incidentEdges.count (v) == 0) {
+        std::vector <unsigned int>& edges = incidentEdges [v];
+
+        if (isLive (this->_vertices, v) && this->vertexRef (v).edge ()) {
+          for (WingedEdge& e : this->vertexRef (v).adjacentEdges ()) {
+            edges.push_back (e.index ());
+          }
+        }
+        affectedVertices.push_back (v);
+      }
+    };
+
+    for (const WingedMeshDelta::Face& f : delta.faces) {
+      if (isLive (this->_faces, f.index)) {
+        removedFaces.push_back (f.index);
+      }
+      if (f.isFree == false) {
+        for (unsigned int v : f.vertexIndices) {
+          affectVertex (v);
+        }
+      }
+    }
+    for (unsigned int i = delta.numFaces; i < numFaces; i++) {
+      if (isLive (this->_faces, i)) {
+        removedFaces.push_back (i);
+      }
+    }
+    for (unsigned int i : removedFaces) {
+      for (WingedVertex& v : this->faceRef (i).adjacentVertices ()) {
+        affectVertex (v.index ());
+      }
+    }
+    for (const WingedMeshDelta::Vertex& v : delta.vertices) {
+      affectVertex (v.index);
+    }
+
+    // detach removed faces
+    for (unsigned int i : removedFaces) {
+      WingedFace& face = this->faceRef (i);
+      WingedEdge* edges [3];
+      unsigned int n = 0;
+
+      for (WingedEdge& e : face.adjacentEdges ()) {
+        assert (n < 3);
+        edges [n++] = &e;
+      }
+      for (unsigned int j = 0; j < n; j++) {
+        WingedEdge& e = *edges [j];
+
+        e.predecessor (face, nullptr);
+        e.successor   (face, nullptr);
+        e.face        (face, nullptr);
+
+        const std::uint64_t key = edgeKey (e.vertex1Ref ().index (), e.vertex2Ref ().index ());
+
+        if (e.leftFace () == nullptr && e.rightFace () == nullptr) {
+          halfEdges.erase (key);
+          this->deleteEdge (e);
+        }
+        else {
+          halfEdges [key] = &e;
+        }
+      }
+      this->deleteFace (face);
+    }
+
+    // restore vertices
+    for (unsigned int i = delta.numVertices; i < numVertices; i++) {
+      if (isLive (this->_vertices, i)) {
+        this->deleteVertex (this->vertexRef (i));
+      }
+    }
+    for (const WingedMeshDelta::Vertex& v : delta.vertices) {
+      if (v.isFree) {
+        if (isLive (this->_vertices, v.index)) {
+          this->deleteVertex (this->vertexRef (v.index));
+        }
+      }
+      else {
+        if (isLive (this->_vertices, v.index) == false) {
+          this->_vertices.emplaceAt (v.index);
+          this->_topology.addVertex (v.index);
+        }
+        while (this->_mesh.numVertices () <= v.index) {
+          this->_mesh.addVertex (glm::vec3 (0.0f));
+        }
+        this->_mesh.setVertex (v.index, v.position);
+        this->touchVertex     (v.index);
+      }
+    }
+
+    // restore faces
+    auto attachEdge = [this, &halfEdges, &edgeKey, &incidentEdges]
+      (unsigned int i1, unsigned int i2, WingedFace& face) -> WingedEdge&
+    {
+      const std::uint64_t key = edgeKey (i1, i2);
+      auto                it  = halfEdges.find (key);
+
+      if (it != halfEdges.end ()) {
+        WingedEdge& edge = *it->second;
+
+        if (edge.vertex1Ref ().index () == i1) {
+          assert (edge.leftFace () == nullptr);
+          edge.leftFace (&face);
+        }
+        else {
+          assert (edge.rightFace () == nullptr);
+          edge.rightFace (&face);
+        }
+        return edge;
+      }
+      else {
+        WingedEdge& edge = this->addEdge ();
+
+        edge.vertex1  (this->vertex (i1));
+        edge.vertex2  (this->vertex (i2));
+        edge.leftFace (&face);
+
+        halfEdges.emplace (key, &edge);
+        incidentEdges [i1].push_back (edge.index ());
+        incidentEdges [i2].push_back (edge.index ());
+        return edge;
+      }
+    };
+
+    for (const WingedMeshDelta::Face& f : delta.faces) {
+      if (f.isFree) {
+        continue;
+      }
+      WingedFace& face = this->_faces.emplaceAt (f.index);
+      this->_topology.addFace (f.index);
+
+      while (this->_mesh.numIndices () < 3 * (f.index + 1)) {
+        this->_mesh.addIndex (0);
+      }
+      for (unsigned int j = 0; j < 3; j++) {
+        this->_mesh.setIndex ((3 * f.index) + j, f.vertexIndices [j]);
+        this->touchFace      (f.index);
+      }
+
+      WingedEdge& e1 = attachEdge (f.vertexIndices [0], f.vertexIndices [1], face);
+      WingedEdge& e2 = attachEdge (f.vertexIndices [1], f.vertexIndices [2], face);
+      WingedEdge& e3 = attachEdge (f.vertexIndices [2], f.vertexIndices [0], face);
+
+      e1.predecessor (face, &e3);
+      e1.successor   (face, &e2);
+      e2.predecessor (face, &e1);
+      e2.successor   (face, &e3);
+      e3.predecessor (face, &e2);
+      e3.successor   (face, &e1);
+      face.edge      (&e1);
+
+      this->addFaceToOctree (face, face.triangle (*this));
+    }
+
+#ifndef NDEBUG
+    for (const auto& e : halfEdges) {
+      assert (e.second->leftFace () && e.second->rightFace ());
+    }
+#endif
+
+    // vertices whose edge has been deleted (or reused) get another incident edge
+    for (unsigned int v : affectedVertices) {
+      if (isLive (this->_vertices, v) == false) {
+        continue;
+      }
+      auto isIncident = [this, v, &isLive] (unsigned int e) {
+        return e != WingedTopology::none && isLive (this->_edges, e)
+            && ( this->_topology.edgeVertex1 (e) == v 
+              || this->_topology.edgeVertex2 (e) == v );
+      };
+
+      if (isIncident (this->_topology.vertexEdge (v)) == false) {
+        this->_topology.vertexEdge (v, WingedTopology::none);
+
+        for (unsigned int e : incidentEdges [v]) {
+          if (isIncident (e)) {
+            this->_topology.vertexEdge (v, e);
+            break;
+          }
+        }
+        assert (this->_topology.vertexEdge (v) != WingedTopology::none);
+      }
+    }
+
+    // geometry of faces and normals around affected vertices
+    VertexPtrSet normalVertices;
+
+    for (unsigned int v : affectedVertices) {
+      if (isLive (this->_vertices, v)) {
+        for (WingedFace& f : this->vertexRef (v).adjacentFaces ()) {
+          this->realignFace (f);
+
+          for (WingedVertex& a : f.adjacentVertices ()) {
+            normalVertices.insert (&a);
+          }
+        }
+      }
+    }
+    this->writeInterpolatedNormals (normalVertices);
+    this->bufferData ();
+    return inverse;
+  }
+
   void               WingedMesh::scale          (const glm::vec3& v)   { return this->_mesh.scale (v); }
   void               WingedMesh::scaling        (const glm::vec3& v)   { return this->_mesh.scaling (v); }
   glm::vec3          WingedMesh::scaling        () const               { return this->_mesh.scaling (); }
@@ -410,6 +1058,7 @@
   void WingedMesh::normalize () {
     this->_mesh.normalize ();
     this->_octree.reset ();
+    this->resetFaceCache ();
 
     this->forEachFace ([this] (WingedFace& face) { 
       this->addFaceToOctree (face, face.triangle (*this));
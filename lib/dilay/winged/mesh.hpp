@@ -6,15 +6,21 @@
 #define DILAY_WINGED_MESH
 
 #include <functional>
-#include <glm/fwd.hpp>
+#include <future>
+#include <glm/glm.hpp>
 #include <vector>
 #include "../mesh.hpp"
 #include "intrusive-list.hpp"
+#include "slab-indexed-list.hpp"
+#include "winged/delta.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
+#include "winged/fwd.hpp"
+#include "winged/topology.hpp"
 #include "winged/vertex.hpp"
-#include "index-octree.hpp"
+#include "flat-index-octree.hpp"
 #include "macro.hpp"
+#include "triangle-bvh.hpp"
 
 class AffectedFaces;
 class Camera;
@@ -30,7 +36,10 @@ class WingedFaceIntersection;
 
 class WingedMesh : public IntrusiveList <WingedMesh>::Item {
   public: 
-    WingedMesh(unsigned int);
+    WingedMesh (unsigned int);
+    WingedMesh (const WingedMesh&)  = delete;
+    WingedMesh (      WingedMesh&&) = delete;
+    ~WingedMesh ();
 
     bool               operator==          (const WingedMesh&) const;
     bool               operator!=          (const WingedMesh&) const;
@@ -50,7 +59,22 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     void               setVertex           (unsigned int, const glm::vec3&);
     void               setNormal           (unsigned int, const glm::vec3&);
 
-    const IndexOctree& octree              () const;
+    /** Normals and areas of faces are cached until one of their vertices is moved or
+     * replaced. `faceNormal (f,n)` returns false if `f` is degenerated.
+     * Both accessors only read the cache and compute stale faces on the fly, i.e. they
+     * can be called concurrently. The cache is filled by `writeInterpolatedNormals` and
+     * `writeAllNormals`.
+     */
+    bool               faceNormal          (const WingedFace&, glm::vec3&) const;
+    float              faceArea            (const WingedFace&) const;
+
+    /** `writeInterpolatedNormals (vs)` caches all faces adjacent to `vs` and writes the
+     * interpolated normals of `vs` */
+    void               writeInterpolatedNormals (const VertexPtrSet&);
+
+    const FlatIndexOctree& octree          () const;
+    WingedTopology&    topology            ();
+    const WingedTopology& topology         () const;
     const Mesh&        mesh                () const;
 
     void               deleteEdge          (WingedEdge&);
@@ -69,7 +93,15 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     bool               isEmpty             () const;
 
     Mesh               makePrunedMesh      (std::vector <unsigned int>* = nullptr) const;
-    void               fromMesh            (const Mesh&, const PrimPlane* = nullptr);
+    void               fromMesh            (Mesh, const PrimPlane* = nullptr);
+    /** `fromMesh (m,vs,fs)` preserves all vertex and face indices of `m`.
+     * `vs` and `fs` are indices of free vertices and faces, which do not become part
+     * of the resulting mesh.
+     */
+    void               fromMesh            ( Mesh, const std::vector <unsigned int>&
+                                           , const std::vector <unsigned int>& );
+    const std::vector <unsigned int>& freeVertexIndices () const;
+    const std::vector <unsigned int>& freeFaceIndices   () const;
     void               writeAllIndices     (); 
     void               writeAllNormals     (); 
     void               bufferData          ();
@@ -80,9 +112,23 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     const RenderMode&  renderMode          () const;
     RenderMode&        renderMode          ();
     
+    /** Ray intersections of meshes with many faces are computed using a bvh, that is
+     * refitted to all faces that have been realigned since. Bvhs are built in the
+     * background, when a mesh is set up and when refitting has degraded the current bvh.
+     * The octree is used until the first bvh is ready.
+     */
     bool               intersects          (const PrimRay&, WingedFaceIntersection&);
     bool               intersects          (const PrimSphere&, AffectedFaces&);
 
+    /** While recording, the previous state of every touched vertex and face is stored.
+     * `stopRecording ()` returns the recorded delta.
+     * `applyDelta (d)` restores the state recorded in `d` and returns its inverse.
+     */
+    void               startRecording      ();
+    WingedMeshDelta    stopRecording       ();
+    bool               isRecording         () const;
+    WingedMeshDelta    applyDelta          (const WingedMeshDelta&);
+
     void               scale               (const glm::vec3&);
     void               scaling             (const glm::vec3&);
     glm::vec3          scaling             () const;
@@ -113,15 +159,51 @@ class WingedMesh : public IntrusiveList <WingedMesh>::Item {
     SAFE_REF1 (WingedFace  , face  , unsigned int)
 
 private:
-    void addFaceToOctree (const WingedFace&, const PrimTriangle&);
+    /* A face is cached at `version`, which is valid as long as no vertex of the face has
+     * been moved or added at a later version, and as long as the face's indices have not
+     * been modified. Degenerated faces have a zero normal.
+     */
+    struct CachedFace {
+      glm::vec3    normal;
+      float        area;
+      unsigned int version;
+    };
+
+    void              addFaceToOctree (const WingedFace&, const PrimTriangle&);
+    void              resetFreeFace   (unsigned int);
+    void              touchVertex     (unsigned int);
+    void              touchFace       (unsigned int);
+    unsigned int      vertexVersion   (unsigned int) const;
+    bool              isCached        (const CachedFace&, unsigned int) const;
+    void              cacheFace       (CachedFace&, unsigned int) const;
+    CachedFace        cachedFace      (unsigned int) const;
+    void              resetFaceCache  ();
+    void              buildBvhAsync   ();
+    void              updateBvhFace   (unsigned int, bool);
+    void              resetBvh        ();
+    bool              updateBvh       ();
+    void              recordVertex    (unsigned int, bool);
+    void              recordFace      (unsigned int, bool);
 
 private:
     const unsigned int                  _index;
     Mesh                                _mesh;
-    IntrusiveIndexedList <WingedVertex> _vertices;
-    IntrusiveIndexedList <WingedEdge>   _edges;
-    IntrusiveIndexedList <WingedFace>   _faces;
-    IndexOctree                         _octree;
+    SlabIndexedList <WingedVertex>      _vertices;
+    SlabIndexedList <WingedEdge>        _edges;
+    SlabIndexedList <WingedFace>        _faces;
+    WingedTopology                      _topology;
+    FlatIndexOctree                     _octree;
+    TriangleBvh                         _bvh;
+    TriangleBvh                         _nextBvh;
+    std::future <void>                  _nextBvhBuilt;
+    std::vector <unsigned int>          _nextBvhFaces;
+    bool                                _isRecording;
+    WingedMeshDelta                     _delta;
+    std::vector <bool>                  _recordedVertices;
+    std::vector <bool>                  _recordedFaces;
+    unsigned int                        _version;
+    std::vector <unsigned int>          _vertexVersions;
+    std::vector <CachedFace>            _cachedFaces;
 };
 
 #endif
@@ -0,0 +1,96 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_WINGED_TOPOLOGY
+#define DILAY_WINGED_TOPOLOGY
+
+#include <cstdint>
+#include <vector>
+#include "../util.hpp"
+
+/* `WingedTopology` stores the connectivity of a winged mesh as 32-bit indices in
+ * parallel arrays, which are indexed by vertex, edge or face index respectively.
+ * A missing reference is denoted by `WingedTopology::none`.
+ */
+class WingedTopology {
+  public:
+    typedef std::uint32_t Index;
+
+    static constexpr Index none = Util::invalidIndex ();
+
+    Index vertexEdge           (Index v) const { return this->_vertexEdges  [v]; }
+    Index faceEdge             (Index f) const { return this->_faceEdges    [f]; }
+    Index edgeVertex1          (Index e) const { return this->_edgeVertices [(2 * e) + 0]; }
+    Index edgeVertex2          (Index e) const { return this->_edgeVertices [(2 * e) + 1]; }
+    Index edgeLeftFace         (Index e) const { return this->_edgeFaces    [(2 * e) + 0]; }
+    Index edgeRightFace        (Index e) const { return this->_edgeFaces    [(2 * e) + 1]; }
+    Index edgeLeftPredecessor  (Index e) const { return this->_edgeSiblings [(4 * e) + 0]; }
+    Index edgeLeftSuccessor    (Index e) const { return this->_edgeSiblings [(4 * e) + 1]; }
+    Index edgeRightPredecessor (Index e) const { return this->_edgeSiblings [(4 * e) + 2]; }
+    Index edgeRightSuccessor   (Index e) const { return this->_edgeSiblings [(4 * e) + 3]; }
+
+    void  vertexEdge           (Index v, Index i) { this->_vertexEdges  [v]           = i; }
+    void  faceEdge             (Index f, Index i) { this->_faceEdges    [f]           = i; }
+    void  edgeVertex1          (Index e, Index i) { this->_edgeVertices [(2 * e) + 0] = i; }
+    void  edgeVertex2          (Index e, Index i) { this->_edgeVertices [(2 * e) + 1] = i; }
+    void  edgeLeftFace         (Index e, Index i) { this->_edgeFaces    [(2 * e) + 0] = i; }
+    void  edgeRightFace        (Index e, Index i) { this->_edgeFaces    [(2 * e) + 1] = i; }
+    void  edgeLeftPredecessor  (Index e, Index i) { this->_edgeSiblings [(4 * e) + 0] = i; }
+    void  edgeLeftSuccessor    (Index e, Index i) { this->_edgeSiblings [(4 * e) + 1] = i; }
+    void  edgeRightPredecessor (Index e, Index i) { this->_edgeSiblings [(4 * e) + 2] = i; }
+    void  edgeRightSuccessor   (Index e, Index i) { this->_edgeSiblings [(4 * e) + 3] = i; }
+
+    void addVertex (Index v) {
+      if (v >= this->_vertexEdges.size ()) {
+        this->_vertexEdges.resize (v + 1, Util::invalidIndex ());
+      }
+      this->_vertexEdges [v] = none;
+    }
+
+    void addEdge (Index e) {
+      if (e >= this->_edgeVertices.size () / 2) {
+        this->_edgeVertices.resize (2 * (e + 1), Util::invalidIndex ());
+        this->_edgeFaces   .resize (2 * (e + 1), Util::invalidIndex ());
+        this->_edgeSiblings.resize (4 * (e + 1), Util::invalidIndex ());
+      }
+      this->edgeVertex1          (e, none);
+      this->edgeVertex2          (e, none);
+      this->edgeLeftFace         (e, none);
+      this->edgeRightFace        (e, none);
+      this->edgeLeftPredecessor  (e, none);
+      this->edgeLeftSuccessor    (e, none);
+      this->edgeRightPredecessor (e, none);
+      this->edgeRightSuccessor   (e, none);
+    }
+
+    void addFace (Index f) {
+      if (f >= this->_faceEdges.size ()) {
+        this->_faceEdges.resize (f + 1, Util::invalidIndex ());
+      }
+      this->_faceEdges [f] = none;
+    }
+
+    void reset () {
+      this->_vertexEdges .clear ();
+      this->_faceEdges   .clear ();
+      this->_edgeVertices.clear ();
+      this->_edgeFaces   .clear ();
+      this->_edgeSiblings.clear ();
+    }
+
+    std::size_t numBytes () const {
+      return sizeof (Index) * ( this->_vertexEdges .size () + this->_faceEdges.size ()
+                              + this->_edgeVertices.size () + this->_edgeFaces.size ()
+                              + this->_edgeSiblings.size () );
+    }
+
+  private:
+    std::vector <Index> _vertexEdges;
+    std::vector <Index> _faceEdges;
+    std::vector <Index> _edgeVertices;
+    std::vector <Index> _edgeFaces;
+    std::vector <Index> _edgeSiblings;
+};
+
+#endif
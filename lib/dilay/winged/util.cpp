@@ -6,7 +6,7 @@
 #include <string>
 #include "../util.hpp"
 #include "adjacent-iterator.hpp"
-#include "index-octree.hpp"
+#include "flat-index-octree.hpp"
 #include "primitive/triangle.hpp"
 #include "winged/edge.hpp"
 #include "winged/face.hpp"
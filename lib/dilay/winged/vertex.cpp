@@ -3,15 +3,17 @@
  * Use and redistribute under the terms of the GNU General Public License
  */
 #include "adjacent-iterator.hpp"
-#include "primitive/triangle.hpp"
 #include "winged/face.hpp"
 #include "winged/mesh.hpp"
 #include "winged/vertex.hpp"
 
-WingedVertex :: WingedVertex (unsigned int i) 
-  : _index    (i)
-  , _edge     (nullptr) 
-{}
+WingedVertex :: WingedVertex (unsigned int i)
+  : _index (i)
+  {}
+
+WingedMesh& WingedVertex :: mesh () const {
+  return *static_cast <WingedMesh*> (SlabIndexedList <WingedVertex>::ownerOf (*this));
+}
 
 bool WingedVertex::operator== (const WingedVertex& other) const {
   return this->_index == other._index;
@@ -21,6 +23,14 @@ bool WingedVertex::operator!= (const WingedVertex& other) const {
   return ! this->operator== (other);
 }
 
+WingedEdge* WingedVertex :: edge () const {
+  return this->mesh ().edge (this->mesh ().topology ().vertexEdge (this->_index));
+}
+
+void WingedVertex :: edge (WingedEdge* e) {
+  this->mesh ().topology ().vertexEdge (this->_index, e ? e->index () : WingedTopology::none);
+}
+
 void WingedVertex :: writeIndex (WingedMesh& mesh, unsigned int index) {
   mesh.setIndex (index, this->_index);
 }
@@ -38,9 +48,9 @@ glm::vec3 WingedVertex :: interpolatedNormal (const WingedMesh& mesh) const {
   unsigned int n      = 0;
 
   for (WingedFace& f : this->adjacentFaces ()) {
-    PrimTriangle triangle = f.triangle (mesh);
-    if (triangle.isDegenerated () == false) {
-      normal += triangle.normal ();
+    glm::vec3 faceNormal;
+    if (mesh.faceNormal (f, faceNormal)) {
+      normal += faceNormal;
       n++;
     }
   }
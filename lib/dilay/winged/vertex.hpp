@@ -6,7 +6,6 @@
 #define DILAY_WINGED_VERTEX
 
 #include <glm/fwd.hpp>
-#include "intrusive-list.hpp"
 #include "macro.hpp"
 
 class AdjEdges;
@@ -15,7 +14,7 @@ class AdjFaces;
 class WingedEdge;
 class WingedMesh;
 
-class WingedVertex : public IntrusiveList <WingedVertex>::Item {
+class WingedVertex {
   public: 
     WingedVertex (unsigned int);
     WingedVertex (const WingedVertex&)  = delete;
@@ -25,9 +24,9 @@ class WingedVertex : public IntrusiveList <WingedVertex>::Item {
     bool          operator!= (const WingedVertex&) const;
 
     unsigned int  index    () const { return this->_index; }
-    WingedEdge*   edge     () const { return this->_edge; }
+    WingedEdge*   edge     () const;
 
-    void          edge     (WingedEdge* e) { this->_edge = e; }
+    void          edge     (WingedEdge*);
 
     void          writeIndex              (WingedMesh&, unsigned int);
     glm::vec3     position                (const WingedMesh&) const;
@@ -47,8 +46,9 @@ class WingedVertex : public IntrusiveList <WingedVertex>::Item {
 
     SAFE_REF_CONST (WingedEdge, edge)
   private:
+    WingedMesh&        mesh () const;
+
     const unsigned int _index;
-    WingedEdge*        _edge;
 };
 
 #endif
@@ -18,7 +18,6 @@ SOURCES += \
            src/dimension.cpp \
            src/distance.cpp \
            src/history.cpp \
-           src/index-octree.cpp \
            src/intersection.cpp \
            src/kvstore.cpp \
            src/mesh.cpp \
@@ -127,7 +126,6 @@ HEADERS += \
            src/edge-map.hpp \
            src/hash.hpp \
            src/history.hpp \
-           src/index-octree.hpp \
            src/intersection.hpp \
            src/intrusive-list.hpp \
            src/kvstore.hpp \
@@ -2,33 +2,83 @@
  * Copyright © 2015,2016 Alexander Bau
  * Use and redistribute under the terms of the GNU General Public License
  */
+#include <cstring>
 #include <iostream>
 #include <QCoreApplication>
 #include "test-bitset.hpp"
+#include "test-compressed-mesh.hpp"
 #include "test-distance.hpp"
+#include "test-falloff.hpp"
+#include "test-indexed-ptr-set.hpp"
 #include "test-intersection.hpp"
 #include "test-intrusive-list.hpp"
 #include "test-maybe.hpp"
+#include "test-mesh.hpp"
 #include "test-misc.hpp"
 #include "test-octree.hpp"
+#include "test-parallel.hpp"
+#include "test-scene-util.hpp"
+#include "test-sculpt.hpp"
+#include "test-sculpt-worker.hpp"
+#include "test-sketch-conversion.hpp"
+#include "test-slab-indexed-list.hpp"
+#include "test-task-pool.hpp"
 #include "test-tree.hpp"
+#include "test-triangle-bvh.hpp"
+#include "test-winged-mesh.hpp"
 
-int main () {
+/* Benchmarks are only run if `--benchmark` is passed, since they take much longer than
+ * the tests.
+ */
+int main (int argc, char** argv) {
   QCoreApplication::setApplicationName ("dilay");
 
+  const bool runBenchmarks = argc > 1 && std::strcmp (argv[1], "--benchmark") == 0;
+
   TestIntersection ::test  ();
   TestMaybe        ::test1 ();
   TestMaybe        ::test2 ();
   TestMaybe        ::test3 ();
+  TestMesh         ::test  ();
   TestOctree       ::test  ();
   TestBitset       ::test  ();
   TestIntrusiveList::test1 ();
   TestIntrusiveList::test2 ();
   TestIntrusiveList::test3 ();
+  TestSlabIndexedList::test ();
   TestTree         ::test1 ();
   TestTree         ::test2 ();
   TestMisc         ::test  ();
   TestDistance     ::test  ();
+  TestCompressedMesh::test ();
+  TestTriangleBvh  ::test  ();
+  TestWingedMesh   ::test  ();
+  TestParallel     ::test  ();
+  TestTaskPool     ::test  ();
+  TestFalloff      ::test  ();
+  TestIndexedPtrSet::test  ();
+  TestSculpt       ::test  ();
+  TestSculptWorker ::test  ();
+  TestSketchConversion::test1 ();
+  TestSketchConversion::test2 ();
+  TestSketchConversion::test3 ();
+  TestSceneUtil    ::test  ();
+
+  if (runBenchmarks) {
+    TestSlabIndexedList::benchmark ();
+    TestOctree         ::benchmark ();
+    TestCompressedMesh ::benchmark ();
+    TestTriangleBvh    ::benchmark ();
+    TestWingedMesh     ::benchmark ();
+    TestParallel       ::benchmark ();
+    TestTaskPool       ::benchmark ();
+    TestFalloff        ::benchmark ();
+    TestIndexedPtrSet  ::benchmark ();
+    TestSculpt         ::benchmark ();
+    TestSculptWorker   ::benchmark ();
+    TestSketchConversion::benchmark ();
+    TestSceneUtil      ::benchmark ();
+  }
 
   std::cout << "all tests run successfully\n";
   return 0;
@@ -0,0 +1,66 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <glm/glm.hpp>
+#include <iostream>
+#include "compressed-mesh.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "test-compressed-mesh.hpp"
+#include "time-delta.hpp"
+
+namespace {
+  void testRoundTrip (const Mesh& mesh) {
+    const CompressedMesh compressed (mesh);
+    const Mesh           decompressed = compressed.mesh ();
+
+    glm::vec3 minimum, maximum;
+    mesh.minMax (minimum, maximum);
+
+    const glm::vec3 maxError = (maximum - minimum) / glm::vec3 (65535.0f);
+
+    assert (decompressed.numVertices () == mesh.numVertices ());
+    assert (decompressed.numIndices  () == mesh.numIndices  ());
+
+    for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+      const glm::vec3 error = glm::abs (decompressed.vertex (i) - mesh.vertex (i));
+
+      assert (error.x <= maxError.x);
+      assert (error.y <= maxError.y);
+      assert (error.z <= maxError.z);
+    }
+    for (unsigned int i = 0; i < mesh.numIndices (); i++) {
+      assert (decompressed.index (i) == mesh.index (i));
+    }
+    assert (decompressed.position () == mesh.position ());
+  }
+}
+
+void TestCompressedMesh::test () {
+  Mesh cube = MeshUtil::cube ();
+  cube.position (glm::vec3 (1.0f, 2.0f, 3.0f));
+
+  testRoundTrip (cube);
+  testRoundTrip (MeshUtil::icosphere (4));
+  testRoundTrip (Mesh ());
+}
+
+void TestCompressedMesh::benchmark () {
+  const Mesh        mesh         = MeshUtil::icosphere (7);
+  const std::size_t uncompressed = (mesh.numVertices () * 2 * sizeof (glm::vec3))
+                                 + (mesh.numIndices  () * sizeof (unsigned int));
+  TIME_DELTA (t)
+
+  const CompressedMesh compressed (mesh);
+  t.printLocal ("compressed-mesh: compress");
+
+  const Mesh decompressed = compressed.mesh ();
+  t.printLocal ("compressed-mesh: decompress");
+
+  std::cout << "compressed-mesh: " << mesh.numVertices () << " vertices, "
+            << uncompressed << " bytes -> " << compressed.numBytes () << " bytes\n";
+
+  assert (decompressed.numVertices () == mesh.numVertices ());
+}
@@ -0,0 +1,127 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "falloff.hpp"
+#include "test-falloff.hpp"
+#include "util.hpp"
+
+namespace {
+  typedef Falloff::Function       Function;
+  typedef Falloff::InstructionSet InstructionSet;
+
+  const InstructionSet instructionSets[] = { InstructionSet::Scalar
+                                           , InstructionSet::SSE2
+                                           , InstructionSet::AVX2 };
+
+  struct Positions {
+    std::vector <float> xs, ys, zs;
+
+    Positions (unsigned int n) {
+      std::mt19937                           gen (n);
+      std::uniform_real_distribution <float> dis (-2.0f, 2.0f);
+
+      for (unsigned int i = 0; i < n; i++) {
+        xs.push_back (dis (gen));
+        ys.push_back (dis (gen));
+        zs.push_back (dis (gen));
+      }
+    }
+
+    glm::vec3 get (unsigned int i) const {
+      return glm::vec3 (xs[i], ys[i], zs[i]);
+    }
+  };
+
+  float reference (Function function, const glm::vec3& p, const glm::vec3& center, float inner, float radius) {
+    switch (function) {
+      case Function::Distance:   return glm::distance (p, center);
+      case Function::LinearStep: return Util::linearStep (p, center, inner, radius);
+      case Function::SmoothStep: return Util::smoothStep (p, center, inner, radius);
+    }
+    DILAY_IMPOSSIBLE
+  }
+
+  void testFunction (Function function, float inner, float radius) {
+    const unsigned int n      = 1003;
+    const glm::vec3    center = glm::vec3 (0.1f, -0.2f, 0.3f);
+    const Positions    positions (n);
+    std::vector <float> scalar (n);
+    std::vector <float> result (n);
+
+    Falloff::evaluate ( InstructionSet::Scalar, function
+                      , positions.xs.data (), positions.ys.data (), positions.zs.data ()
+                      , n, center, inner, radius, scalar.data () );
+
+    for (unsigned int i = 0; i < n; i++) {
+      const float expected = reference (function, positions.get (i), center, inner, radius);
+      assert (glm::abs (scalar[i] - expected) < 1.0e-5f);
+    }
+
+    for (InstructionSet set : instructionSets) {
+      if (Falloff::isSupported (set)) {
+        Falloff::evaluate ( set, function
+                          , positions.xs.data (), positions.ys.data (), positions.zs.data ()
+                          , n, center, inner, radius, result.data () );
+        assert (result == scalar);
+      }
+    }
+  }
+}
+
+void TestFalloff::test () {
+  for (Function function : { Function::Distance, Function::LinearStep, Function::SmoothStep }) {
+    testFunction (function, 0.0f, 1.0f);
+    testFunction (function, 0.5f, 1.0f);
+    testFunction (function, 1.0f, 1.0f);
+  }
+}
+
+void TestFalloff::benchmark () {
+  typedef std::chrono::steady_clock Clock;
+
+  struct Brush {
+    const char* name;
+    Function    function;
+    float       innerRadius;
+  };
+
+  const Brush brushes[] = { { "carve"   , Function::SmoothStep, 0.0f }
+                          , { "draglike", Function::SmoothStep, 0.5f }
+                          , { "smooth"  , Function::SmoothStep, 0.0f }
+                          , { "flatten" , Function::LinearStep, 0.0f }
+                          , { "pinch"   , Function::Distance  , 0.0f } };
+
+  const unsigned int  n          = 1 << 16;
+  const unsigned int  numRuns    = 200;
+  const glm::vec3     center     = glm::vec3 (0.0f);
+  const Positions     positions (n);
+  std::vector <float> result (n);
+
+  std::cout << "falloff: best instruction set: "
+            << Falloff::name (Falloff::bestInstructionSet ()) << "\n";
+
+  for (const Brush& brush : brushes) {
+    for (InstructionSet set : instructionSets) {
+      if (Falloff::isSupported (set)) {
+        const Clock::time_point start = Clock::now ();
+
+        for (unsigned int r = 0; r < numRuns; r++) {
+          Falloff::evaluate ( set, brush.function
+                            , positions.xs.data (), positions.ys.data (), positions.zs.data ()
+                            , n, center, brush.innerRadius, 1.0f, result.data () );
+        }
+        const std::chrono::duration <double, std::nano> ns = Clock::now () - start;
+
+        std::cout << "falloff: " << brush.name << " (" << Falloff::name (set) << "): "
+                  << double (n) * double (numRuns) / ns.count () << " vertices/ns\n";
+      }
+    }
+  }
+}
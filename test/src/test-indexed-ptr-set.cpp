@@ -0,0 +1,156 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "indexed-ptr-set.hpp"
+#include "test-indexed-ptr-set.hpp"
+#include "time-delta.hpp"
+
+namespace {
+  class Foo {
+    public:
+      Foo (unsigned int i) : _index (i) {}
+
+      unsigned int index () const { return this->_index; }
+
+    private:
+      unsigned int _index;
+  };
+
+  /* Simulates the sets of a brush stroke: many short-lived sets of neighbouring
+   * elements, that are queried and iterated.
+   */
+  template <typename Set>
+  void benchmarkSet (const char* name, const std::vector <Foo>& foos) {
+    std::default_random_engine                   gen;
+    std::uniform_int_distribution <unsigned int> startD (0, foos.size () - 1001);
+    unsigned long                                sum = 0;
+
+    TIME_DELTA (t)
+
+    for (unsigned int r = 0; r < 2000; r++) {
+      const unsigned int start = startD (gen);
+      Set                set;
+
+      for (unsigned int i = 0; i < 1000; i++) {
+        set.insert (const_cast <Foo*> (&foos[start + ((i * 7) % 1000)]));
+        set.insert (const_cast <Foo*> (&foos[start + ((i * 3) % 1000)]));
+      }
+      for (unsigned int i = 0; i < 1000; i++) {
+        sum += set.count (const_cast <Foo*> (&foos[start + i]));
+      }
+      for (Foo* f : set) {
+        sum += f->index ();
+      }
+    }
+    t.printLocal ((std::string (name) + ": insert/count/iterate").c_str ());
+
+    assert (sum > 0);
+  }
+}
+
+void TestIndexedPtrSet::test () {
+  std::vector <Foo> foos;
+  for (unsigned int i = 0; i < 10; i++) {
+    foos.emplace_back (i);
+  }
+
+  IndexedPtrSet <Foo> set;
+  assert (set.empty ());
+  assert (set.count (&foos[3]) == 0);
+  assert (set.begin () == set.end ());
+
+  assert (set.insert (&foos[3]));
+  assert (set.insert (&foos[7]));
+  assert (set.insert (&foos[1]));
+  assert (set.insert (&foos[3]) == false);
+  assert (set.size () == 3);
+  assert (set.count (&foos[7]) == 1);
+  assert (set.count (&foos[2]) == 0);
+  assert (*set.begin () == &foos[3]);
+
+  assert (set.erase (&foos[3]) == 1);
+  assert (set.erase (&foos[3]) == 0);
+  assert (set.size () == 2);
+  assert (set.count (&foos[3]) == 0);
+  assert (set.count (&foos[1]) == 1);
+  assert (set.count (&foos[7]) == 1);
+
+  IndexedPtrSet <Foo> copy (set);
+  set.clear ();
+  assert (set.empty ());
+  assert (set.count (&foos[1]) == 0);
+  assert (copy.size () == 2);
+  assert (copy.count (&foos[1]) == 1);
+
+  for (Foo& f : foos) {
+    copy.insert (&f);
+  }
+  copy.eraseIf ([] (Foo* f) { return f->index () % 2 == 0; });
+  assert (copy.size () == 5);
+  for (Foo* f : copy) {
+    assert (f->index () % 2 == 1);
+  }
+
+  IndexedPtrSet <Foo> moved (std::move (copy));
+  assert (moved.size () == 5);
+  assert (copy.empty ());
+  assert (copy.count (&foos[1]) == 0);
+
+  {
+    IndexedPtrSet <Foo> recycled;
+    recycled.insert (&foos[0]);
+    assert (recycled.count (&foos[1]) == 0);
+  }
+
+  // the pool is bounded
+  {
+    std::vector <Foo> many;
+    for (unsigned int i = 0; i < 2000000; i++) {
+      many.emplace_back (i);
+    }
+    {
+      std::vector <IndexedPtrSet <Foo>> sets (20);
+      for (IndexedPtrSet <Foo>& s : sets) {
+        s.insert (&many.back ());
+        for (unsigned int i = 0; i < 100000; i++) {
+          s.insert (&many[i]);
+        }
+      }
+    }
+    assert (IndexedPtrSet <Foo>::numPooledStorages () <= 8);
+    assert (IndexedPtrSet <Foo>::numPooledBytes () <= 8 * (((1 << 19) * 8) + ((1 << 16) * sizeof (Foo*))));
+
+    IndexedPtrSet <Foo> recycled;
+    recycled.insert (&many[0]);
+    assert (recycled.count (&many[1999999]) == 0);
+    assert (recycled.count (&many[1]) == 0);
+    assert (recycled.count (&many[0]) == 1);
+  }
+
+  // pools are thread-local
+  {
+    std::thread thread ([&foos] () {
+      assert (IndexedPtrSet <Foo>::numPooledStorages () == 0);
+
+      IndexedPtrSet <Foo> set;
+      set.insert (&foos[0]);
+    });
+    thread.join ();
+  }
+}
+
+void TestIndexedPtrSet::benchmark () {
+  std::vector <Foo> foos;
+  for (unsigned int i = 0; i < 1000000; i++) {
+    foos.emplace_back (i);
+  }
+  benchmarkSet <std::unordered_set <Foo*>> ("indexed-ptr-set: unordered_set", foos);
+  benchmarkSet <IndexedPtrSet <Foo>>       ("indexed-ptr-set: IndexedPtrSet", foos);
+}
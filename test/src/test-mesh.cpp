@@ -0,0 +1,201 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <map>
+#include <utility>
+#include <vector>
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "render-mode.hpp"
+#include "test-mesh.hpp"
+
+namespace {
+  /* `RecordingOpenGL` keeps a copy of the content of every buffer.
+   * Since all targets are `0`, uploads go to the most recently bound buffer.
+   */
+  class RecordingOpenGL : public NullOpenGL {
+    public:
+      typedef std::vector <unsigned char> Buffer;
+
+      RecordingOpenGL () : bound (0) {}
+
+      void glBindBuffer (unsigned int, unsigned int id) {
+        this->bound = id;
+      }
+
+      void glBufferData (unsigned int, unsigned int size, const void* data, unsigned int) {
+        assert (this->bound != 0);
+
+        Buffer& buffer = this->buffers [this->bound];
+        buffer.resize (size);
+        if (data) {
+          std::memcpy (buffer.data (), data, size);
+        }
+      }
+
+      void glBufferSubData (unsigned int, unsigned int offset, unsigned int size, const void* data) {
+        assert (this->buffers.count (this->bound) == 1);
+
+        Buffer& buffer = this->buffers [this->bound];
+        assert (offset + size <= buffer.size ());
+        std::memcpy (buffer.data () + offset, data, size);
+      }
+
+      void safeDeleteBuffer (unsigned int& id) {
+        this->buffers.erase (id);
+        id = 0;
+      }
+
+      std::map <unsigned int, Buffer> buffers;
+
+    private:
+      unsigned int bound;
+  };
+
+  // layout of a packed vertex, see `Mesh::bufferData`
+  const unsigned int packedStride       = 20;
+  const unsigned int packedNormalOffset = 12;
+
+  std::vector <float> floats (const RecordingOpenGL::Buffer& buffer) {
+    std::vector <float> result (buffer.size () / sizeof (float));
+    std::memcpy (result.data (), buffer.data (), buffer.size ());
+    return result;
+  }
+
+  /* Compares a packed vertex buffer with the separate vertex and normal buffers of the
+   * unpacked layout. Normals are quantized to 16 bits in the packed layout.
+   */
+  void checkEqual ( const RecordingOpenGL::Buffer& packed, const std::vector <float>& vertices
+                  , const std::vector <float>& normals )
+  {
+    assert (vertices.size () == normals.size ());
+    assert (packed.size () == (vertices.size () / 3) * packedStride);
+
+    for (unsigned int i = 0; i < vertices.size () / 3; i++) {
+      float        position [3];
+      std::int16_t normal   [3];
+
+      std::memcpy (position, packed.data () + (i * packedStride), sizeof (position));
+      std::memcpy (normal, packed.data () + (i * packedStride) + packedNormalOffset, sizeof (normal));
+
+      for (unsigned int c = 0; c < 3; c++) {
+        assert (position [c] == vertices [(3 * i) + c]);
+        assert (glm::abs ((float (normal [c]) / 32767.0f) - normals [(3 * i) + c]) < 1.0e-4f);
+      }
+    }
+  }
+
+  void modify (Mesh& mesh, unsigned int first, unsigned int step) {
+    for (unsigned int i = first; i < mesh.numVertices (); i += step) {
+      const glm::vec3 v = mesh.vertex (i) * 1.1f;
+
+      mesh.setVertex (i, v);
+      mesh.setNormal (i, glm::normalize (v + glm::vec3 (0.1f)));
+    }
+  }
+}
+
+void TestMesh::test () {
+  RecordingOpenGL openGL;
+  // geometry spans several chunks (cf. `CopyOnWriteArray`)
+  Mesh            mesh = MeshUtil::icosphere (4);
+
+  for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+    mesh.setNormal (i, glm::normalize (mesh.vertex (i)));
+  }
+
+  auto checkVertices = [&mesh] (const std::vector <float>& vertices) {
+    assert (vertices.size () == mesh.numVertices () * 3);
+
+    for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        assert (vertices [(3 * i) + c] == mesh.vertex (i) [c]);
+      }
+    }
+  };
+
+  auto unpacked = [&openGL, &mesh] (std::vector <float>& vertices, std::vector <float>& normals) {
+    mesh.renderMode ().packedVertices (false);
+    mesh.bufferData ();
+
+    // index, vertex and normal buffers
+    assert (openGL.buffers.size () == 3);
+
+    // vertices and normals have the same size, but the vertex buffer is allocated first
+    std::vector <std::vector <float>> arrays;
+    for (const auto& b : openGL.buffers) {
+      if (b.second.size () == mesh.numVertices () * 3 * sizeof (float)) {
+        arrays.push_back (floats (b.second));
+      }
+    }
+    assert (arrays.size () == 2);
+    vertices = arrays [0];
+    normals  = arrays [1];
+  };
+
+  auto packed = [&openGL, &mesh] () {
+    mesh.renderMode ().packedVertices (true);
+    mesh.bufferData ();
+
+    // index and packed buffers, the separate buffers have been freed
+    assert (openGL.buffers.size () == 2);
+
+    for (const auto& b : openGL.buffers) {
+      if (b.second.size () != mesh.numIndices () * sizeof (unsigned int)) {
+        return b.second;
+      }
+    }
+    assert (false);
+    return RecordingOpenGL::Buffer ();
+  };
+
+  std::vector <float> vertices, normals;
+
+  // full uploads
+  unpacked   (vertices, normals);
+  checkEqual (packed (), vertices, normals);
+
+  // partial uploads of several ranges in packed layout, then a full unpacked upload
+  modify (mesh, 0, 97);
+  const RecordingOpenGL::Buffer packedUpdate = packed ();
+  unpacked   (vertices, normals);
+  checkEqual (packedUpdate, vertices, normals);
+
+  // partial uploads in unpacked layout, then a full packed upload
+  modify (mesh, 5, 31);
+  unpacked      (vertices, normals);
+  checkVertices (vertices);
+  checkEqual    (packed (), vertices, normals);
+
+  // copies share their geometry until it is modified
+  const Mesh                copy (mesh);
+  const std::vector <float> copyVertices (vertices);
+
+  modify        (mesh, 1, 2);
+  unpacked      (vertices, normals);
+  checkVertices (vertices);
+
+  for (unsigned int i = 0; i < copy.numVertices (); i++) {
+    for (unsigned int c = 0; c < 3; c++) {
+      assert (copy.vertex (i) [c] == copyVertices [(3 * i) + c]);
+    }
+  }
+
+  // moved geometry is taken from the moved-from mesh
+  const unsigned int numVertices = mesh.numVertices ();
+  const unsigned int numIndices  = mesh.numIndices  ();
+  Mesh               moved (std::move (mesh));
+
+  assert (moved.numVertices () == numVertices && moved.numIndices () == numIndices);
+  assert (mesh .numVertices () == 0           && mesh .numIndices () == 0);
+
+  mesh = std::move (moved);
+  assert (mesh .numVertices () == numVertices && mesh .numIndices () == numIndices);
+  assert (moved.numVertices () == 0           && moved.numIndices () == 0);
+}
@@ -5,58 +5,220 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <random>
-#include "index-octree.hpp"
+#include <string>
+#include <vector>
+#include "flat-index-octree.hpp"
+#include "primitive/sphere.hpp"
 #include "primitive/triangle.hpp"
 #include "test-octree.hpp"
+#include "time-delta.hpp"
 #include "winged/util.hpp"
 
+namespace {
+  std::vector <PrimTriangle> randomTriangles (unsigned int numSamples, float maxScale) {
+    std::vector <PrimTriangle> triangles;
+    triangles.reserve (numSamples);
+
+    std::default_random_engine gen; 
+    std::uniform_real_distribution <float> unitD   (0.0f , 1.0f);
+    std::uniform_real_distribution <float> posD    (-10.0f, 10.0f);
+    std::uniform_real_distribution <float> scaleD  (0.00001f, maxScale);
+    std::uniform_real_distribution <float> twoPiD  (0.0f, 2.0f * glm::pi<float> ());
+
+    for (unsigned int i = 0; i < numSamples; i++) {
+      const glm::vec3 m1 (-1.0f, 0.0f, 0.0f);
+      const glm::vec3 m2 ( 1.0f, 0.0f, 0.0f);
+      const glm::vec3 m3 ( 0.0f,-1.0f, 0.0f);
+
+      const glm::mat4x4 translationMatrix = glm::translate ( glm::mat4x4 (1.0f)
+                                                           , glm::vec3   ( posD (gen)
+                                                                         , posD (gen)
+                                                                         , posD (gen)
+                                                                         ));
+      const glm::mat4x4 rotationMatrix = glm::rotate ( glm::mat4x4 (1.0f)
+                                                     , twoPiD (gen)
+                                                     , glm::normalize (
+                                                        glm::vec3 ( unitD (gen)
+                                                                  , unitD (gen)
+                                                                  , unitD (gen)
+                                                                  )));
+
+      const glm::mat4x4 scalingMatrix = glm::scale ( glm::mat4x4 (1.0f)
+                                                   , glm::vec3   ( scaleD (gen)
+                                                                 , scaleD (gen)
+                                                                 , scaleD (gen)
+                                                                 ));
+
+      const glm::mat4x4 modelMatrix = translationMatrix * rotationMatrix * scalingMatrix;
+
+      const glm::vec3 w1 = glm::vec3 (modelMatrix * glm::vec4 (m1, 1.0f));
+      const glm::vec3 w2 = glm::vec3 (modelMatrix * glm::vec4 (m2, 1.0f));
+      const glm::vec3 w3 = glm::vec3 (modelMatrix * glm::vec4 (m3, 1.0f));
+
+      triangles.emplace_back (w1, w2, w3);
+    }
+    return triangles;
+  }
+
+  std::vector <PrimSphere> randomSpheres (unsigned int numSamples) {
+    std::vector <PrimSphere> spheres;
+    spheres.reserve (numSamples);
+
+    std::default_random_engine gen; 
+    std::uniform_real_distribution <float> posD    (-10.0f, 10.0f);
+    std::uniform_real_distribution <float> radiusD (0.1f, 2.0f);
+
+    for (unsigned int i = 0; i < numSamples; i++) {
+      spheres.emplace_back (glm::vec3 (posD (gen), posD (gen), posD (gen)), radiusD (gen));
+    }
+    return spheres;
+  }
+
+  template <typename T>
+  void addTriangles (T& octree, const std::vector <PrimTriangle>& triangles) {
+    for (unsigned int i = 0; i < triangles.size (); i++) {
+      octree.addElement (i, triangles [i].center (), triangles [i].maxDimExtent ());
+    }
+  }
+
+  std::vector <unsigned int> query (const FlatIndexOctree& octree, const PrimSphere& sphere) {
+    std::vector <unsigned int> result;
+    octree.intersects (sphere, [&result] (unsigned int i) { result.push_back (i); });
+    std::sort (result.begin (), result.end ());
+    return result;
+  }
+
+  /* Each element is a candidate at most once, and each element whose center lies
+   * inside the query is a candidate, since its center lies inside its node.
+   */
+  void checkQuery ( const FlatIndexOctree& octree, const std::vector <PrimTriangle>& triangles
+                  , const std::vector <bool>& isElement, const PrimSphere& sphere )
+  {
+    const std::vector <unsigned int> candidates = query (octree, sphere);
+
+    assert (std::adjacent_find (candidates.begin (), candidates.end ()) == candidates.end ());
+
+    for (unsigned int i : candidates) {
+      assert (isElement [i]);
+    }
+    for (unsigned int i = 0; i < triangles.size (); i++) {
+      if ( isElement [i] 
+        && glm::distance (triangles [i].center (), sphere.center ()) <= sphere.radius () )
+      {
+        assert (std::binary_search (candidates.begin (), candidates.end (), i));
+      }
+    }
+  }
+
+  template <typename T>
+  void benchmarkOctree ( const char* name, const std::vector <PrimTriangle>& triangles
+                       , const std::vector <PrimSphere>& spheres )
+  {
+    const std::string prefix (name);
+    T                 octree;
+    unsigned int      numCandidates = 0;
+
+    octree.setupRoot (glm::vec3 (0.0f), 10.0f);
+
+    TIME_DELTA (t)
+    addTriangles (octree, triangles);
+    t.printLocal ((prefix + ": insert").c_str ());
+
+    for (const PrimSphere& sphere : spheres) {
+      octree.intersects (sphere, [&numCandidates] (unsigned int) { numCandidates++; });
+    }
+    t.printLocal ((prefix + ": query").c_str ());
+
+    const T copy (octree);
+    t.printLocal ((prefix + ": copy").c_str ());
+
+    for (unsigned int i = 0; i < triangles.size (); i++) {
+      octree.deleteElement (i);
+    }
+    t.printLocal ((prefix + ": delete").c_str ());
+
+    std::cout << name << ": " << numCandidates << " candidates\n";
+  }
+
+  template <typename F>
+  void benchmarkCandidatesPerSecond (const char* name, const std::vector <PrimSphere>& spheres, const F& query) {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    unsigned int numCandidates = 0;
+    const auto   start         = Clock::now ();
+
+    for (const PrimSphere& sphere : spheres) {
+      query (sphere, numCandidates);
+    }
+    const std::chrono::duration <double> seconds = Clock::now () - start;
+
+    std::cout << name << ": " << (double (numCandidates) / seconds.count ()) << " candidates/s\n";
+  }
+}
+
 void TestOctree::test () {
-  const unsigned int numSamples = 10000;
+  const std::vector <PrimTriangle> triangles = randomTriangles (10000, 10.0f);
+  const std::vector <PrimSphere>   spheres   = randomSpheres (100);
+  std::vector <bool>               isElement (triangles.size (), true);
 
-  IndexOctree octree;
+  FlatIndexOctree octree;
   octree.setupRoot (glm::vec3 (0.0f), 10.0f);
-       
-  std::default_random_engine gen; 
-  std::uniform_real_distribution <float> unitD   (0.0f , 1.0f);
-  std::uniform_real_distribution <float> posD    (-10.0f, 10.0f);
-  std::uniform_real_distribution <float> scaleD  (0.00001f, 10.0f);
-  std::uniform_real_distribution <float> twoPiD  (0.0f, 2.0f * glm::pi<float> ());
-
-  for (unsigned int i = 0; i < numSamples; i++) {
-    const glm::vec3 m1 (-1.0f, 0.0f, 0.0f);
-    const glm::vec3 m2 ( 1.0f, 0.0f, 0.0f);
-    const glm::vec3 m3 ( 0.0f,-1.0f, 0.0f);
-
-    const glm::mat4x4 translationMatrix = glm::translate ( glm::mat4x4 (1.0f)
-                                                         , glm::vec3   ( posD (gen)
-                                                                       , posD (gen)
-                                                                       , posD (gen)
-                                                                       ));
-    const glm::mat4x4 rotationMatrix = glm::rotate ( glm::mat4x4 (1.0f)
-                                                   , twoPiD (gen)
-                                                   , glm::normalize (
-                                                      glm::vec3 ( unitD (gen)
-                                                                , unitD (gen)
-                                                                , unitD (gen)
-                                                                )));
-
-    const glm::mat4x4 scalingMatrix = glm::scale ( glm::mat4x4 (1.0f)
-                                                 , glm::vec3   ( scaleD (gen)
-                                                               , scaleD (gen)
-                                                               , scaleD (gen)
-                                                               ));
-
-    const glm::mat4x4 modelMatrix = translationMatrix * rotationMatrix * scalingMatrix;
-
-    const glm::vec3    w1  = glm::vec3 (modelMatrix * glm::vec4 (m1, 1.0f));
-    const glm::vec3    w2  = glm::vec3 (modelMatrix * glm::vec4 (m2, 1.0f));
-    const glm::vec3    w3  = glm::vec3 (modelMatrix * glm::vec4 (m3, 1.0f));
-    const PrimTriangle tri = PrimTriangle (w1,w2,w3);
-
-    octree.addElement (i, tri.center (), tri.maxDimExtent ());
-  }
-  for (unsigned int i = 0; i < numSamples; i++) {
+  addTriangles (octree, triangles);
+
+  for (const PrimSphere& sphere : spheres) {
+    checkQuery (octree, triangles, isElement, sphere);
+  }
+
+  for (unsigned int i = 0; i < triangles.size (); i += 2) {
     octree.deleteElement (i);
+    isElement [i] = false;
   }
+  const FlatIndexOctree copy (octree);
+
+  for (const PrimSphere& sphere : spheres) {
+    checkQuery (copy, triangles, isElement, sphere);
+  }
+
+  for (unsigned int i = 1; i < triangles.size (); i += 2) {
+    octree.deleteElement (i);
+  }
+
+  // tiny elements create more levels than fit onto the local traversal stack
+  FlatIndexOctree deepOctree;
+  deepOctree.setupRoot (glm::vec3 (0.0f), 10.0f);
+
+  for (unsigned int i = 0; i < 8; i++) {
+    const glm::vec3 position ( (i & 1) ? 3.0e-30f : -3.0e-30f
+                             , (i & 2) ? 5.0e-30f : -5.0e-30f
+                             , (i & 4) ? 7.0e-30f : -7.0e-30f );
+    deepOctree.addElement (i, position, 1.0e-31f);
+  }
+  assert (query (deepOctree, PrimSphere (glm::vec3 (0.0f), 1.0f)).size () == 8);
+}
+
+void TestOctree::benchmark () {
+  const std::vector <PrimTriangle> triangles = randomTriangles (200000, 0.1f);
+  const std::vector <PrimSphere>   spheres   = randomSpheres (10000);
+
+  benchmarkOctree <FlatIndexOctree> ("flat-index-octree", triangles, spheres);
+
+  FlatIndexOctree             octree;
+  FlatIndexOctree::Candidates candidates;
+
+  octree.setupRoot (glm::vec3 (0.0f), 10.0f);
+  addTriangles (octree, triangles);
+
+  benchmarkCandidatesPerSecond ("flat-index-octree: callback", spheres,
+    [&octree] (const PrimSphere& sphere, unsigned int& numCandidates) {
+      octree.intersects (sphere, [&numCandidates] (unsigned int) { numCandidates++; });
+    });
+
+  benchmarkCandidatesPerSecond ("flat-index-octree: candidates", spheres,
+    [&octree, &candidates] (const PrimSphere& sphere, unsigned int& numCandidates) {
+      octree.forEachCandidate (sphere, candidates, [&numCandidates] (unsigned int) { numCandidates++; });
+    });
 }
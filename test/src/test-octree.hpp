@@ -6,7 +6,8 @@
 #define DILAY_TEST_OCTREE
 
 namespace TestOctree {
-  void test ();
+  void test      ();
+  void benchmark ();
 }
 
 #endif
@@ -0,0 +1,119 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include <vector>
+#include "action/sculpt.hpp"
+#include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "parallel.hpp"
+#include "sculpt-brush.hpp"
+#include "test-parallel.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  void testChunks (unsigned int n, unsigned int numThreads, unsigned int minChunkSize) {
+    std::vector <std::atomic <unsigned int>> visits (n);
+
+    for (std::atomic <unsigned int>& v : visits) {
+      v = 0;
+    }
+    Parallel::forChunks (n, numThreads, minChunkSize, [&visits] (unsigned int b, unsigned int e) {
+      assert (b <= e);
+      for (unsigned int i = b; i < e; i++) {
+        visits[i]++;
+      }
+    });
+
+    for (const std::atomic <unsigned int>& v : visits) {
+      assert (v == 1);
+    }
+  }
+
+  /* Replays a stroke of carving dabs with a `SculptBrush` that displaces vertices on
+   * `numThreads` threads. Subdivision is disabled, such that only displacements are
+   * measured. Returns the sculpted mesh.
+   */
+  Mesh replayStroke ( unsigned int numThreads, unsigned int& numDisplaced
+                    , std::chrono::duration <double>& time )
+  {
+    typedef std::chrono::steady_clock Clock;
+
+    const unsigned int numDabs = 200;
+    WingedMesh         mesh (0);
+    SculptBrush        brush;
+    AffectedFaces      domain;
+
+    mesh.fromMesh (MeshUtil::icosphere (7));
+
+    brush.radius          (0.3f);
+    brush.stepWidthFactor (0.1f);
+    brush.subdivide       (false);
+    brush.numThreads      (numThreads);
+    brush.mesh            (&mesh);
+    brush.parameters <SBCarveParameters> ().intensity (0.01f);
+
+    numDisplaced = 0;
+    time         = std::chrono::duration <double> (0);
+
+    for (unsigned int d = 0; d < numDabs; d++) {
+      const float     angle = glm::pi <float> () * float (d) / float (numDabs);
+      const glm::vec3 dab   = glm::vec3 (glm::cos (angle), glm::sin (angle), 0.0f);
+
+      brush.setPointOfAction (dab, dab);
+
+      const Clock::time_point start = Clock::now ();
+      Action::sculptDab (brush, domain);
+      time += Clock::now () - start;
+
+      numDisplaced += domain.toVertexSet ().size ();
+      Action::finalizeSculpt (brush, domain);
+      domain.reset ();
+    }
+    return mesh.makePrunedMesh ();
+  }
+}
+
+void TestParallel::test () {
+  testChunks (0, 4, 1);
+  testChunks (1, 4, 1);
+  testChunks (7, 4, 1);
+  testChunks (1000, 0, 1);
+  testChunks (1000, 3, 100);
+  testChunks (1000, 16, 2000);
+}
+
+void TestParallel::benchmark () {
+  NullOpenGL         openGL;
+  const unsigned int numThreads = Parallel::numThreads (0);
+  unsigned int       numDisplaced;
+
+  auto runStroke = [&numDisplaced] (unsigned int t, Mesh& result) -> double {
+    std::chrono::duration <double> time;
+
+    result = replayStroke (t, numDisplaced, time);
+    return double (numDisplaced) / time.count ();
+  };
+
+  Mesh serial, parallel;
+  const double serialThroughput   = runStroke (1, serial);
+  const double parallelThroughput = runStroke (numThreads, parallel);
+
+  // new positions only depend on old positions, i.e. results are equal
+  assert (serial.numVertices () == parallel.numVertices ());
+  for (unsigned int i = 0; i < serial.numVertices (); i++) {
+    assert (serial.vertex (i) == parallel.vertex (i));
+  }
+
+  std::cout << "parallel: stroke replay displaced " << numDisplaced << " vertices\n"
+            << "parallel: 1 thread: " << serialThroughput << " vertices/s, "
+            << numThreads << " threads: " << parallelThroughput << " vertices/s\n";
+}
@@ -0,0 +1,166 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <QDir>
+#include <string>
+#include "config.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "primitive/sphere.hpp"
+#include "scene.hpp"
+#include "scene-util.hpp"
+#include "sketch/mesh.hpp"
+#include "sketch/path.hpp"
+#include "test-scene-util.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  float millisecondsSince (const Clock::time_point& start) {
+    return std::chrono::duration <float, std::milli> (Clock::now () - start).count ();
+  }
+
+  void makeScene (const Config& config, Scene& scene, unsigned int subdivisions) {
+    scene.newWingedMesh (config, MeshUtil::icosphere (subdivisions));
+
+    SketchTree  tree;
+    SketchNode& root = tree.emplaceRoot (glm::vec3 (0.0f, 0.0f, 0.0f), 0.3f);
+
+    root.emplaceChild (glm::vec3 (0.0f, 0.5f, 0.0f), 0.15f)
+        .emplaceChild (glm::vec3 (0.0f, 0.8f, 0.0f), 0.2f);
+    root.emplaceChild (glm::vec3 (0.5f, 0.0f, 0.0f), 0.1f);
+
+    SketchMesh& sketch = scene.newSketchMesh (config, tree);
+    SketchPath  path;
+
+    for (unsigned int i = 0; i < 4; i++) {
+      const glm::vec3 pos (float (i) * 0.1f, -0.5f, 0.0f);
+      path.addSphere (pos, pos, 0.05f);
+    }
+    sketch.addPath (path);
+  }
+
+  /* Text files store coordinates with limited precision, hence `epsilon` */
+  void checkEqual (const Scene& a, const Scene& b, float epsilon) {
+    assert (a.numWingedMeshes () == b.numWingedMeshes ());
+    assert (a.numSketchMeshes () == b.numSketchMeshes ());
+
+    std::vector <Mesh> meshesA, meshesB;
+    a.forEachConstMesh ([&meshesA] (const WingedMesh& m) { meshesA.push_back (m.makePrunedMesh ()); });
+    b.forEachConstMesh ([&meshesB] (const WingedMesh& m) { meshesB.push_back (m.makePrunedMesh ()); });
+
+    for (unsigned int i = 0; i < meshesA.size (); i++) {
+      assert (meshesA[i].numVertices () == meshesB[i].numVertices ());
+      assert (meshesA[i].numIndices  () == meshesB[i].numIndices  ());
+
+      for (unsigned int j = 0; j < meshesA[i].numVertices (); j++) {
+        assert (glm::distance (meshesA[i].vertex (j), meshesB[i].vertex (j)) <= epsilon);
+      }
+    }
+
+    std::vector <const SketchMesh*> sketchesA, sketchesB;
+    a.forEachConstMesh ([&sketchesA] (const SketchMesh& m) { sketchesA.push_back (&m); });
+    b.forEachConstMesh ([&sketchesB] (const SketchMesh& m) { sketchesB.push_back (&m); });
+
+    for (unsigned int i = 0; i < sketchesA.size (); i++) {
+      const SketchMesh& sA = *sketchesA[i];
+      const SketchMesh& sB = *sketchesB[i];
+
+      assert (sA.tree ().root ().numNodes () == sB.tree ().root ().numNodes ());
+      assert (sA.paths ().size () == sB.paths ().size ());
+
+      for (unsigned int j = 0; j < sA.paths ().size (); j++) {
+        assert (sA.paths ()[j].spheres ().size () == sB.paths ()[j].spheres ().size ());
+      }
+    }
+  }
+
+  float load (const Config& config, const std::string& fileName) {
+    Scene                   scene (config);
+    const Clock::time_point start = Clock::now ();
+    const bool              loaded = scene.fromDlyFile (config, fileName);
+
+    assert (loaded);
+    static_cast <void> (loaded);
+    return millisecondsSince (start);
+  }
+
+  float save (const Scene& scene, const std::string& fileName) {
+    const Clock::time_point start = Clock::now ();
+    const bool              saved = SceneUtil::toDlyFile (fileName, scene, false);
+
+    assert (saved);
+    static_cast <void> (saved);
+    return millisecondsSince (start);
+  }
+}
+
+void TestSceneUtil::test () {
+  NullOpenGL openGL;
+  Config     config;
+  Scene      scene (config);
+
+  makeScene (config, scene, 3);
+
+  std::stringstream binary;
+  SceneUtil::toBinaryDlyFile (binary, scene);
+
+  const std::string data = binary.str ();
+  assert (SceneUtil::isBinaryDlyFile (data.data (), data.size ()));
+
+  Scene fromBinary (config);
+  assert (SceneUtil::fromBinaryDlyFile (data.data (), data.size (), config, fromBinary));
+  checkEqual (scene, fromBinary, 0.0f);
+
+  std::stringstream text;
+  SceneUtil::toDlyFile (text, scene, false);
+  assert (SceneUtil::isBinaryDlyFile (text.str ().data (), text.str ().size ()) == false);
+
+  Scene fromText (config);
+  assert (SceneUtil::fromDlyFile (text, config, fromText));
+  checkEqual (fromText, fromBinary, 0.0001f);
+
+  const std::string unaligned = " " + data;
+  Scene             fromUnaligned (config);
+  assert (SceneUtil::fromBinaryDlyFile ( unaligned.data () + 1, data.size (), config
+                                       , fromUnaligned ));
+  checkEqual (fromBinary, fromUnaligned, 0.0f);
+
+  // nothing is added to the scene if parsing fails
+  Scene truncated (config);
+  assert (SceneUtil::fromBinaryDlyFile (data.data (), data.size () - 1, config, truncated) == false);
+  assert (truncated.numWingedMeshes () == 0);
+  assert (truncated.numSketchMeshes () == 0);
+}
+
+void TestSceneUtil::benchmark () {
+  NullOpenGL        openGL;
+  Config            config;
+  Scene             scene (config);
+  const std::string textFileName   = QDir::temp ().filePath ("dilay-benchmark.dly").toStdString ();
+  const std::string binaryFileName = QDir::temp ().filePath ("dilay-benchmark.dlyb").toStdString ();
+
+  makeScene (config, scene, 7);
+
+  const float saveText   = save (scene, textFileName);
+  const float saveBinary = save (scene, binaryFileName);
+  const float loadText   = load (config, textFileName);
+  const float loadBinary = load (config, binaryFileName);
+
+  std::cout << "scene-util: " << scene.numFaces () << " faces, "
+            << "text: save " << saveText << "ms, load " << loadText << "ms, "
+            << "binary: save " << saveBinary << "ms, load " << loadBinary << "ms\n";
+
+  std::remove (textFileName.c_str ());
+  std::remove (binaryFileName.c_str ());
+}
@@ -0,0 +1,268 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include "action/sculpt.hpp"
+#include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "sculpt-brush.hpp"
+#include "sculpt-queue.hpp"
+#include "sculpt-worker.hpp"
+#include "test-sculpt-worker.hpp"
+#include "winged/mesh.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  float milliseconds (const Clock::time_point& from, const Clock::time_point& to) {
+    return std::chrono::duration <float, std::milli> (to - from).count ();
+  }
+
+  SculptBrush carveBrush (WingedMesh& mesh) {
+    SculptBrush brush;
+
+    brush.radius          (0.2f);
+    brush.detailFactor    (0.75f);
+    brush.stepWidthFactor (0.1f);
+    brush.subdivide       (true);
+    brush.mesh            (&mesh);
+    brush.parameters <SBCarveParameters> ().intensity (0.05f);
+    return brush;
+  }
+
+  void setDab (SculptBrush& brush, unsigned int i, unsigned int n) {
+    const float     angle = glm::pi <float> () * float (i) / float (n);
+    const glm::vec3 pos   = glm::vec3 (glm::cos (angle), glm::sin (angle), 0.0f);
+
+    brush.setPointOfAction (pos, pos);
+  }
+
+  /* Replays a stroke of `numFrames` frames with `dabsPerFrame` dabs each, where frames
+   * are `frameTime` apart. If `queue` is null, dabs are sculpted and finalized on the
+   * calling thread like before, otherwise they are posted to `queue`.
+   * Returns the time the calling thread spent on sculpting per frame.
+   */
+  float replayStroke ( WingedMesh& mesh, SculptQueue* queue, unsigned int numFrames
+                     , unsigned int dabsPerFrame, const std::chrono::milliseconds& frameTime )
+  {
+    SculptBrush   brush = carveBrush (mesh);
+    AffectedFaces domain;
+    float         blocked = 0.0f;
+
+    for (unsigned int f = 0; f < numFrames; f++) {
+      const Clock::time_point start = Clock::now ();
+
+      for (unsigned int d = 0; d < dabsPerFrame; d++) {
+        setDab (brush, (f * dabsPerFrame) + d, numFrames * dabsPerFrame);
+
+        if (queue) {
+          queue->dab (brush);
+        }
+        else {
+          Action::sculptDab (brush, domain);
+        }
+      }
+      if (queue) {
+        queue->update ();
+      }
+      else {
+        Action::finalizeSculpt (brush, domain);
+        domain.reset ();
+      }
+      blocked += milliseconds (start, Clock::now ());
+
+      std::this_thread::sleep_for (frameTime);
+    }
+    if (queue) {
+      const Clock::time_point start = Clock::now ();
+      queue->finish ();
+      blocked += milliseconds (start, Clock::now ());
+    }
+    return blocked / float (numFrames);
+  }
+}
+
+void TestSculptWorker::test () {
+  // commands are executed in posting order
+  {
+    SculptWorker               worker;
+    std::vector <unsigned int> executed;
+
+    for (unsigned int i = 0; i < 1000; i++) {
+      worker.post ([&executed, i] () { executed.push_back (i); });
+    }
+    worker.finish ();
+
+    assert (worker.isIdle ());
+    assert (worker.numPending () == 0);
+    assert (executed.size () == 1000);
+    for (unsigned int i = 0; i < executed.size (); i++) {
+      assert (executed[i] == i);
+    }
+  }
+
+  // no command is executed inside of `exclusive`
+  {
+    SculptWorker worker;
+    unsigned int counter = 0;
+
+    for (unsigned int i = 0; i < 100; i++) {
+      worker.post ([&counter] () {
+        counter++;
+        std::this_thread::sleep_for (std::chrono::microseconds (10));
+      });
+      worker.exclusive ([&counter] () {
+        const unsigned int before = counter;
+        std::this_thread::sleep_for (std::chrono::microseconds (10));
+        assert (counter == before);
+      });
+    }
+    worker.finish ();
+    assert (counter == 100);
+  }
+
+  // `finish` inside of `exclusive` executes pending commands on the calling thread
+  {
+    SculptWorker               worker;
+    std::vector <unsigned int> executed;
+
+    worker.exclusive ([&worker, &executed] () {
+      for (unsigned int i = 0; i < 10; i++) {
+        worker.post ([&executed, i] () { executed.push_back (i); });
+      }
+      worker.finish ();
+
+      assert (worker.isIdle ());
+      assert (executed.size () == 10);
+    });
+    for (unsigned int i = 0; i < executed.size (); i++) {
+      assert (executed[i] == i);
+    }
+  }
+
+  // `tryExclusive` does not block while a command is executed
+  {
+    SculptWorker      worker;
+    std::atomic <int> state (0);
+
+    worker.post ([&state] () {
+      state = 1;
+      while (state == 1) {
+        std::this_thread::yield ();
+      }
+    });
+    while (state == 0) {
+      std::this_thread::yield ();
+    }
+    assert (worker.tryExclusive ([] () {}) == false);
+    state = 2;
+    worker.finish ();
+    assert (worker.tryExclusive ([] () {}));
+  }
+
+  // pending commands are executed before destruction
+  {
+    unsigned int counter = 0;
+    {
+      SculptWorker worker;
+      for (unsigned int i = 0; i < 100; i++) {
+        worker.post ([&counter] () { counter++; });
+      }
+    }
+    assert (counter == 100);
+  }
+
+  // a queued stroke results in the same mesh as sculpting on the calling thread
+  {
+    NullOpenGL  openGL;
+    WingedMesh  syncMesh  (0);
+    WingedMesh  asyncMesh (1);
+    SculptQueue queue;
+
+    syncMesh .fromMesh (MeshUtil::icosphere (4));
+    asyncMesh.fromMesh (MeshUtil::icosphere (4));
+
+    replayStroke (syncMesh, nullptr, 10, 3, std::chrono::milliseconds (0));
+    replayStroke (asyncMesh, &queue, 10, 3, std::chrono::milliseconds (0));
+
+    assert (queue.isIdle ());
+    assert (queue.numUploadedFrames () == 10);
+
+    const Mesh sync  = syncMesh .makePrunedMesh ();
+    const Mesh async = asyncMesh.makePrunedMesh ();
+
+    assert (sync.numVertices () > MeshUtil::icosphere (4).numVertices ());
+    assert (MeshUtil::checkConsistency (async));
+    assert (sync.numVertices () == async.numVertices ());
+    assert (sync.numIndices  () == async.numIndices  ());
+    for (unsigned int i = 0; i < sync.numVertices (); i++) {
+      assert (sync.vertex (i) == async.vertex (i));
+    }
+    for (unsigned int i = 0; i < sync.numIndices (); i++) {
+      assert (sync.index (i) == async.index (i));
+    }
+  }
+}
+
+/* Measures the time from posting a command until it starts executing, while the
+ * posting thread keeps posting like a stream of input events.
+ * Strokes are replayed at 60 frames per second to compare the time the GUI thread is
+ * blocked per frame and the latency from input to upload of `SculptQueue` with
+ * sculpting on the GUI thread.
+ */
+void TestSculptWorker::benchmark () {
+  const unsigned int numCommands = 10000;
+
+  SculptWorker                     worker;
+  std::vector <Clock::time_point>  posted   (numCommands);
+  std::vector <float>              latencies (numCommands);
+
+  const Clock::time_point start = Clock::now ();
+  for (unsigned int i = 0; i < numCommands; i++) {
+    posted[i] = Clock::now ();
+    worker.post ([&posted, &latencies, i] () {
+      latencies[i] = std::chrono::duration <float, std::micro> (Clock::now () - posted[i]).count ();
+    });
+  }
+  const float postingTime = std::chrono::duration <float, std::milli> (Clock::now () - start).count ();
+  worker.finish ();
+
+  float sum = 0.0f;
+  float max = 0.0f;
+  for (float l : latencies) {
+    sum += l;
+    max  = l > max ? l : max;
+  }
+  std::cout << "sculpt worker: posted " << numCommands << " commands in " << postingTime << "ms, "
+            << "latency until execution " << (sum / float (numCommands)) << "us mean, "
+            << max << "us max\n";
+
+  NullOpenGL                      openGL;
+  const unsigned int              numFrames = 60;
+  const std::chrono::milliseconds frameTime (16);
+  WingedMesh                      syncMesh  (0);
+  WingedMesh                      asyncMesh (1);
+  SculptQueue                     queue;
+
+  syncMesh .fromMesh (MeshUtil::icosphere (6));
+  asyncMesh.fromMesh (MeshUtil::icosphere (6));
+
+  const float syncBlocked  = replayStroke (syncMesh, nullptr, numFrames, 4, frameTime);
+  const float asyncBlocked = replayStroke (asyncMesh, &queue, numFrames, 4, frameTime);
+
+  std::cout << "sculpt worker: GUI thread: " << syncBlocked << "ms blocked per frame, "
+            << "input to upload latency " << syncBlocked << "ms mean\n"
+            << "sculpt worker: queue: " << asyncBlocked << "ms blocked per frame, "
+            << "input to upload latency " << queue.meanLatency () << "ms mean, "
+            << queue.maxLatency () << "ms max over " << queue.numUploadedFrames () << " uploads\n";
+}
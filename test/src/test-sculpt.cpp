@@ -0,0 +1,216 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <iostream>
+#include "action/sculpt.hpp"
+#include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "parallel.hpp"
+#include "primitive/plane.hpp"
+#include "sculpt-brush.hpp"
+#include "test-sculpt.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  const PrimPlane mirrorPlane (glm::vec3 (0.0f), glm::vec3 (1.0f, 0.0f, 0.0f));
+
+  SculptBrush carveBrush (WingedMesh& mesh, float radius) {
+    SculptBrush brush;
+
+    brush.radius          (radius);
+    brush.detailFactor    (0.75f);
+    brush.stepWidthFactor (0.1f);
+    brush.subdivide       (true);
+    brush.mesh            (&mesh);
+    brush.parameters <SBCarveParameters> ().intensity (0.05f);
+    return brush;
+  }
+
+  /* The `i`-th of `n` dabs of a stroke that crosses the mirror plane */
+  void setDab (SculptBrush& brush, unsigned int i, unsigned int n) {
+    const float     angle = glm::pi <float> () * (0.25f + (0.5f * float (i) / float (n)));
+    const glm::vec3 pos   = glm::vec3 (glm::cos (angle), 0.0f, glm::sin (angle));
+
+    brush.setPointOfAction (pos, pos);
+  }
+
+  /* Remeshes an icosphere by a subdividing carve stroke and a reducing stroke, where
+   * vertices are displaced with `numThreads` threads.
+   */
+  Mesh remesh (unsigned int numThreads, unsigned int numDabs, double& time) {
+    WingedMesh    mesh (0);
+    AffectedFaces domain;
+
+    mesh.fromMesh (MeshUtil::icosphere (4));
+
+    SculptBrush carve  = carveBrush (mesh, 0.3f);
+    SculptBrush reduce = carveBrush (mesh, 0.3f);
+
+    carve .numThreads   (numThreads);
+    carve .detailFactor (0.9f);
+    reduce.numThreads   (numThreads);
+    reduce.parameters <SBReduceParameters> ().intensity (0.9f);
+
+    time = 0.0;
+    for (SculptBrush* brush : { &carve, &reduce }) {
+      for (unsigned int i = 0; i < numDabs; i++) {
+        setDab (*brush, i, numDabs);
+
+        const Clock::time_point start = Clock::now ();
+        Action::sculptDab (*brush, domain);
+        Action::finalizeSculpt (*brush, domain);
+        time += std::chrono::duration <double, std::milli> (Clock::now () - start).count ();
+
+        domain.reset ();
+      }
+    }
+    return mesh.makePrunedMesh ();
+  }
+
+  void assertEqual (const Mesh& a, const Mesh& b) {
+    assert (a.numVertices () == b.numVertices ());
+    assert (a.numIndices  () == b.numIndices  ());
+
+    for (unsigned int i = 0; i < a.numVertices (); i++) {
+      assert (a.vertex (i) == b.vertex (i));
+    }
+    for (unsigned int i = 0; i < a.numIndices (); i++) {
+      assert (a.index (i) == b.index (i));
+    }
+  }
+
+  /* `TwoSculpts` is the path before dabs were batched: the dab and its mirrored
+   * counterpart are sculpted and finalized separately. `TwoDabs` gathers both dabs into
+   * a single domain, `OnePass` additionally realigns faces near the mirror plane once.
+   */
+  enum class Mode { NoMirror, TwoSculpts, TwoDabs, OnePass };
+
+  void sculptEvent (Mode mode, const SculptBrush& brush, AffectedFaces& domain) {
+    switch (mode) {
+      case Mode::NoMirror:
+        Action::sculptDab (brush, domain);
+        break;
+
+      case Mode::TwoSculpts: {
+        SculptBrush mirrored (brush);
+        mirrored.mirror (mirrorPlane);
+
+        Action::sculpt (brush);
+        Action::sculpt (mirrored);
+        break;
+      }
+      case Mode::TwoDabs: {
+        SculptBrush mirrored (brush);
+        mirrored.mirror (mirrorPlane);
+
+        Action::sculptDab (brush, domain);
+        Action::sculptDab (mirrored, domain);
+        break;
+      }
+      case Mode::OnePass:
+        Action::sculptMirroredDab (brush, mirrorPlane, domain);
+        break;
+    }
+  }
+}
+
+void TestSculpt::test () {
+  NullOpenGL    openGL;
+  WingedMesh    twoPasses (0);
+  WingedMesh    onePass   (1);
+  AffectedFaces twoPassesDomain;
+  AffectedFaces onePassDomain;
+
+  twoPasses.fromMesh (MeshUtil::icosphere (4));
+  onePass  .fromMesh (MeshUtil::icosphere (4));
+
+  SculptBrush twoPassesBrush = carveBrush (twoPasses, 0.2f);
+  SculptBrush onePassBrush   = carveBrush (onePass, 0.2f);
+
+  for (unsigned int i = 0; i < 20; i++) {
+    setDab (twoPassesBrush, i, 20);
+    setDab (onePassBrush, i, 20);
+
+    sculptEvent (Mode::TwoDabs, twoPassesBrush, twoPassesDomain);
+    sculptEvent (Mode::OnePass, onePassBrush, onePassDomain);
+  }
+
+  assert (twoPasses.numVertices () == onePass.numVertices ());
+  assert (twoPasses.numFaces    () == onePass.numFaces    ());
+
+  twoPasses.forEachConstVertex ([&twoPasses, &onePass] (const WingedVertex& v) {
+    const glm::vec3 d = v.position (twoPasses) - onePass.vector (v.index ());
+    assert (glm::dot (d, d) < 1.0e-8f);
+    (void) d;
+  });
+
+  // remeshing keeps meshes consistent, independently of the number of threads
+  double     time;
+  const Mesh serial   = remesh (1, 20, time);
+  const Mesh parallel = remesh (4, 20, time);
+
+  assert (serial.numVertices () > MeshUtil::icosphere (4).numVertices ());
+  assert (MeshUtil::checkConsistency (serial));
+  assert (MeshUtil::checkConsistency (parallel));
+  assertEqual (serial, parallel);
+}
+
+/* Replays a stroke with one dab per event, where each event is finalized like a frame
+ * of `ToolSculpt`.
+ */
+void TestSculpt::benchmark () {
+  const unsigned int numEvents = 100;
+  NullOpenGL         openGL;
+
+  auto runStroke = [numEvents] (Mode mode, const char* name) {
+    WingedMesh    mesh (0);
+    AffectedFaces domain;
+
+    mesh.fromMesh (MeshUtil::icosphere (6));
+
+    SculptBrush             brush         = carveBrush (mesh, 0.15f);
+    const unsigned long     uploadedBytes = Mesh::uploadedBytes ();
+    const Clock::time_point start         = Clock::now ();
+
+    for (unsigned int i = 0; i < numEvents; i++) {
+      setDab (brush, i, numEvents);
+      sculptEvent (mode, brush, domain);
+
+      if (mode != Mode::TwoSculpts) {
+        Action::finalizeSculpt (brush, domain);
+        domain.reset ();
+      }
+    }
+    const std::chrono::duration <float, std::milli> time = Clock::now () - start;
+
+    std::cout << "sculpt: " << name << ": "
+              << (time.count () / float (numEvents)) << "ms per event, "
+              << ((Mesh::uploadedBytes () - uploadedBytes) / numEvents) << " uploaded bytes per event\n";
+  };
+
+  runStroke (Mode::NoMirror  , "no mirror");
+  runStroke (Mode::TwoSculpts, "mirror by two finalized sculpts");
+  runStroke (Mode::TwoDabs   , "mirror by two dabs");
+  runStroke (Mode::OnePass   , "mirror in one pass");
+
+  const unsigned int numThreads = Parallel::numThreads (0);
+  double             serialTime, parallelTime;
+  const Mesh         serial   = remesh (1, numEvents, serialTime);
+  const Mesh         parallel = remesh (numThreads, numEvents, parallelTime);
+
+  assertEqual (serial, parallel);
+
+  std::cout << "sculpt: remeshing: 1 thread: " << (serialTime / double (2 * numEvents))
+            << "ms per event, " << numThreads << " threads: "
+            << (parallelTime / double (2 * numEvents)) << "ms per event\n";
+}
@@ -0,0 +1,228 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "primitive/sphere.hpp"
+#include "sketch/conversion.hpp"
+#include "sketch/mesh.hpp"
+#include "sketch/path.hpp"
+#include "sketch/primitives.hpp"
+#include "test-sketch-conversion.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  /* A sketch of a torso with a head, two arms and two legs */
+  SketchTree makeTree () {
+    SketchTree  tree;
+    SketchNode& root = tree.emplaceRoot (glm::vec3 (0.0f, 0.0f, 0.0f), 0.3f);
+    SketchNode& neck = root.emplaceChild (glm::vec3 (0.0f, 0.5f, 0.0f), 0.15f);
+
+    neck.emplaceChild (glm::vec3 (0.0f, 0.8f, 0.05f), 0.25f);
+
+    for (float side : { -1.0f, 1.0f }) {
+      SketchNode& shoulder = neck.emplaceChild (glm::vec3 (side * 0.35f, 0.45f, 0.0f), 0.12f);
+      SketchNode& elbow    = shoulder.emplaceChild (glm::vec3 (side * 0.8f, 0.3f, 0.1f), 0.08f);
+      elbow.emplaceChild (glm::vec3 (side * 1.1f, 0.1f, 0.3f), 0.06f);
+
+      SketchNode& hip  = root.emplaceChild (glm::vec3 (side * 0.2f, -0.4f, 0.0f), 0.15f);
+      SketchNode& knee = hip.emplaceChild (glm::vec3 (side * 0.25f, -0.9f, 0.05f), 0.1f);
+      knee.emplaceChild (glm::vec3 (side * 0.25f, -1.4f, 0.0f), 0.08f);
+    }
+    return tree;
+  }
+
+  /* The sketch of `makeTree` with a tail that is drawn as a path */
+  void makeSketch (SketchMesh& sketch) {
+    SketchPath tail;
+
+    for (unsigned int i = 0; i < 16; i++) {
+      const float     t   = float (i) / 15.0f;
+      const glm::vec3 pos = glm::vec3 (0.3f * glm::sin (6.0f * t), -0.2f - (0.4f * t), -0.3f - t);
+
+      tail.addSphere (pos, pos, 0.1f - (0.05f * t));
+    }
+    sketch.fromTree (makeTree ());
+    sketch.addPath  (tail);
+  }
+
+  Mesh convert ( const SketchMesh& sketch, float resolution
+               , SketchConversion::Sampling sampling, float& time )
+  {
+    const Clock::time_point start = Clock::now ();
+    Mesh                    mesh  = SketchConversion::convert (sketch, resolution, sampling);
+
+    time = std::chrono::duration <float, std::milli> (Clock::now () - start).count ();
+    return mesh;
+  }
+
+  Mesh convertAdaptive (const SketchMesh& sketch, float resolution, float& time) {
+    const Clock::time_point start = Clock::now ();
+    Mesh                    mesh  = SketchConversion::convertAdaptive (sketch, resolution);
+
+    time = std::chrono::duration <float, std::milli> (Clock::now () - start).count ();
+    return mesh;
+  }
+
+  float maxDeviation (const SketchPrimitives& primitives, const Mesh& mesh) {
+    float deviation = 0.0f;
+
+    for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+      deviation = glm::max (deviation, glm::abs (primitives.distance (mesh.vertex (i))));
+    }
+    return deviation;
+  }
+}
+
+void TestSketchConversion::test1 () {
+  NullOpenGL openGL;
+  SketchMesh sketch (0);
+  float      time;
+
+  makeSketch (sketch);
+
+  for (float resolution : { 0.1f, 0.05f, 0.03f }) {
+    const Mesh dense  = convert (sketch, resolution, SketchConversion::Sampling::Dense, time);
+    const Mesh sparse = convert (sketch, resolution, SketchConversion::Sampling::Sparse, time);
+
+    assert (dense.numVertices () > 0);
+    assert (dense.numVertices () == sparse.numVertices ());
+    assert (dense.numIndices  () == sparse.numIndices  ());
+
+    for (unsigned int i = 0; i < dense.numVertices (); i++) {
+      assert (glm::distance2 (dense.vertex (i), sparse.vertex (i)) < 1.0e-10f);
+    }
+    for (unsigned int i = 0; i < dense.numIndices (); i++) {
+      assert (dense.index (i) == sparse.index (i));
+    }
+  }
+}
+
+/* Queries of the bounding volume hierarchy must equal brute-force queries, also for
+ * points inside of several overlapping primitives, where distances are negative.
+ */
+void TestSketchConversion::test2 () {
+  NullOpenGL                             openGL;
+  SketchMesh                             sketch (0);
+  std::default_random_engine             engine;
+  std::uniform_real_distribution <float> coordinate (-1.5f, 1.5f);
+  std::vector <unsigned int>             within;
+
+  makeSketch (sketch);
+
+  const SketchPrimitives primitives (sketch);
+
+  assert (primitives.numPrimitives () == 15 + 16);
+
+  // returns the number of primitives that contain `pos`
+  auto checkQueries = [&primitives, &within] (const glm::vec3& pos, float maxDistance) {
+    float        distance    = std::numeric_limits <float>::max ();
+    unsigned int numWithin   = 0;
+    unsigned int numContains = 0;
+
+    primitives.primitivesWithin (pos, maxDistance, within);
+
+    for (unsigned int p = 0; p < primitives.numPrimitives (); p++) {
+      const float d = primitives.distance (p, pos);
+
+      distance     = glm::min (distance, d);
+      numContains += d < 0.0f ? 1 : 0;
+
+      if (d <= maxDistance) {
+        assert (numWithin < within.size () && within[numWithin] == p);
+        numWithin++;
+      }
+    }
+    assert (numWithin == within.size ());
+
+    unsigned int closest = primitives.numPrimitives ();
+
+    assert (primitives.distance (pos, &closest) == distance);
+    assert (primitives.distance (closest, pos) == distance);
+    return numContains;
+  };
+
+  for (unsigned int i = 0; i < 1000; i++) {
+    const glm::vec3 pos = glm::vec3 (coordinate (engine), coordinate (engine), coordinate (engine));
+
+    checkQueries (pos, 0.5f * coordinate (engine));
+  }
+
+  unsigned int numInside     = 0;
+  unsigned int numOverlapped = 0;
+
+  while (numInside < 1000) {
+    const glm::vec3 pos = glm::vec3 (coordinate (engine), coordinate (engine), coordinate (engine));
+
+    if (primitives.distance (pos) < 0.0f) {
+      const unsigned int numContains = checkQueries (pos, 0.1f * coordinate (engine));
+
+      assert (numContains > 0);
+      numInside++;
+      numOverlapped += numContains > 1 ? 1 : 0;
+    }
+  }
+  assert (numOverlapped > 0);
+}
+
+void TestSketchConversion::test3 () {
+  NullOpenGL openGL;
+  SketchMesh sketch (0);
+  float      time;
+
+  makeSketch (sketch);
+
+  const SketchPrimitives primitives (sketch);
+
+  for (float resolution : { 0.05f, 0.03f, 0.02f }) {
+    const Mesh uniform  = convert (sketch, resolution, SketchConversion::Sampling::Sparse, time);
+    const Mesh adaptive = convertAdaptive (sketch, resolution, time);
+
+    assert (MeshUtil::checkConsistency (adaptive));
+    assert (adaptive.numIndices () < uniform.numIndices ());
+    assert (maxDeviation (primitives, adaptive) <= resolution);
+  }
+}
+
+void TestSketchConversion::benchmark () {
+  NullOpenGL openGL;
+  SketchMesh sketch (0);
+
+  makeSketch (sketch);
+
+  const SketchPrimitives primitives (sketch);
+
+  // dense sampling is skipped below `minDenseResolution`, since its grid does not scale
+  const float minDenseResolution = 0.02f;
+
+  for (float resolution : { 0.08f, 0.04f, 0.02f, 0.01f }) {
+    float      denseTime = 0.0f, sparseTime, adaptiveTime;
+    const Mesh sparse    = convert (sketch, resolution, SketchConversion::Sampling::Sparse, sparseTime);
+    const Mesh adaptive  = convertAdaptive (sketch, resolution, adaptiveTime);
+
+    if (resolution >= minDenseResolution) {
+      convert (sketch, resolution, SketchConversion::Sampling::Dense, denseTime);
+    }
+    std::cout << "sketch conversion: resolution " << resolution << ": ";
+    if (resolution >= minDenseResolution) {
+      std::cout << denseTime << "ms dense, ";
+    }
+    std::cout << sparseTime << "ms sparse, "
+              << (sparse.numIndices () / 3) << " faces (deviation "
+              << maxDeviation (primitives, sparse) << "), "
+              << adaptiveTime << "ms adaptive, "
+              << (adaptive.numIndices () / 3) << " faces (deviation "
+              << maxDeviation (primitives, adaptive) << ")\n";
+  }
+}
@@ -0,0 +1,15 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TEST_SKETCH_CONVERSION
+#define DILAY_TEST_SKETCH_CONVERSION
+
+namespace TestSketchConversion {
+  void test1     ();
+  void test2     ();
+  void test3     ();
+  void benchmark ();
+}
+
+#endif
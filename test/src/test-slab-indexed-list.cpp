@@ -0,0 +1,164 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <random>
+#include <string>
+#include "intrusive-list.hpp"
+#include "slab-indexed-list.hpp"
+#include "test-slab-indexed-list.hpp"
+#include "time-delta.hpp"
+
+namespace {
+  class IndexedFoo : public IntrusiveList <IndexedFoo>::Item {
+    public:
+      IndexedFoo (unsigned int i, int d) : _index (i), _data (d) {}
+
+      unsigned int index () const { return this->_index; }
+      int          data  () const { return this->_data;  }
+
+    private:
+      unsigned int _index;
+      int          _data;
+  };
+
+  template <typename List>
+  void benchmarkList (const char* name, unsigned int numElements) {
+    std::default_random_engine                    gen;
+    std::uniform_int_distribution <unsigned int>  indexD (0, numElements - 1);
+    List                                          list;
+    long                                          sum = 0;
+
+    TIME_DELTA (t)
+
+    for (unsigned int i = 0; i < numElements; i++) {
+      list.emplaceBack (int (i));
+    }
+    t.printLocal ((std::string (name) + ": insert").c_str ());
+
+    for (unsigned int r = 0; r < 10; r++) {
+      list.forEachConstElement ([&sum] (const IndexedFoo& f) { sum += f.data (); });
+    }
+    t.printLocal ((std::string (name) + ": traverse").c_str ());
+
+    for (unsigned int i = 0; i < numElements; i++) {
+      const IndexedFoo* f = list.get (indexD (gen));
+      if (f) {
+        sum += f->data ();
+      }
+    }
+    t.printLocal ((std::string (name) + ": random access").c_str ());
+
+    for (unsigned int i = 0; i < numElements / 2; i++) {
+      IndexedFoo* f = list.get (indexD (gen));
+      if (f) {
+        list.deleteElement (*f);
+      }
+      list.emplaceBack (int (i));
+    }
+    t.printLocal ((std::string (name) + ": delete/insert").c_str ());
+
+    assert (sum > 0);
+    assert (list.numElements () == numElements);
+  }
+}
+
+void TestSlabIndexedList::test () {
+  SlabIndexedList <IndexedFoo, 2> list;
+
+  assert (list.numElements () == 0);
+  assert (list.hasFreeIndices () == false);
+
+  IndexedFoo& f1 = list.emplaceBack (5);
+  list.emplaceBack (10);
+  assert (list.numElements () == 2);
+  assert (list.hasFreeIndices () == false);
+  assert (list.get (0) == &f1);
+  assert (list.get (0)->data () == 5);
+  assert (list.get (1));
+  assert (list.get (1)->data () == 10);
+
+  list.deleteElement (f1);
+  assert (list.numElements () == 1);
+  assert (list.hasFreeIndices ());
+  assert (list.get (1)->data () == 10);
+  assert (list.get (1)->index () == 1);
+  assert (list.get (0) == nullptr);
+  assert (list.isFree (0));
+  assert (list.front ().index () == 1);
+
+  list.emplaceBack (20);
+  assert (list.numElements () == 2);
+  assert (list.hasFreeIndices () == false);
+  assert (list.get (0)->data () == 20);
+  assert (list.get (0)->index () == 0);
+
+  // addresses remain stable when chunks are added
+  const IndexedFoo* f2 = list.get (1);
+  for (int i = 0; i < 20; i++) {
+    list.emplaceBack (i);
+  }
+  assert (list.numElements () == 22);
+  assert (list.get (1) == f2);
+  assert (list.back ().data () == 19);
+
+  // iteration is index-ordered
+  list.deleteElement (*list.get (5));
+  list.deleteElement (*list.get (6));
+  unsigned int previous = 0;
+  unsigned int visited  = 0;
+  list.forEachConstElement ([&previous, &visited] (const IndexedFoo& f) {
+    assert (visited == 0 || f.index () > previous);
+    previous = f.index ();
+    visited++;
+  });
+  assert (visited == 20);
+
+  // elements can be deleted while iterating
+  list.forEachElement ([&list] (IndexedFoo& f) {
+    if (f.index () % 2 == 0) {
+      list.deleteElement (f);
+    }
+  });
+  assert (list.numElements () == 10);
+
+  SlabIndexedList <IndexedFoo, 2> list2 (std::move (list));
+  assert (list.numElements () == 0);
+  assert (list2.numElements () == 10);
+  assert (list2.get (1) == f2);
+
+  // specific free indices are reused, missing indices become free
+  assert (list2.isFree (0) && list2.isFree (4) && list2.isFree (6));
+  assert (list2.numIndices () == 22);
+
+  list2.emplaceAt (4, 40);
+  list2.emplaceAt (0, 0);
+  list2.emplaceAt (24, 240);
+  list2.emplaceAt (6, 60);
+  assert (list2.numElements () == 14);
+  assert (list2.numIndices  () == 25);
+  assert (list2.get (24)->data () == 240 && list2.get (4)->index () == 4);
+  assert (list2.isFree (22) && list2.isFree (23));
+
+  for (unsigned int i : list2.freeIndices ()) {
+    assert (list2.isFree (i));
+  }
+  assert (list2.freeIndices ().size () == list2.numIndices () - list2.numElements ());
+
+  while (list2.hasFreeIndices ()) {
+    list2.emplaceBack (1);
+  }
+  assert (list2.numElements () == 25);
+
+  list2.reset ();
+  assert (list2.numElements () == 0);
+  assert (list2.hasFreeIndices () == false);
+}
+
+void TestSlabIndexedList::benchmark () {
+  const unsigned int numElements = 1000000;
+
+  benchmarkList <IntrusiveIndexedList <IndexedFoo>> ("intrusive-indexed-list", numElements);
+  benchmarkList <SlabIndexedList      <IndexedFoo>> ("slab-indexed-list"     , numElements);
+}
@@ -0,0 +1,13 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TEST_SLAB_INDEXED_LIST
+#define DILAY_TEST_SLAB_INDEXED_LIST
+
+namespace TestSlabIndexedList {
+  void test      ();
+  void benchmark ();
+}
+
+#endif
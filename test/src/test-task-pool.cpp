@@ -0,0 +1,155 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+#include "task-pool.hpp"
+#include "test-task-pool.hpp"
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  void testRange (unsigned int n, unsigned int grain) {
+    std::vector <std::atomic <unsigned int>> visits (n);
+
+    for (std::atomic <unsigned int>& v : visits) {
+      v = 0;
+    }
+    Parallel::forRange (n, grain, [&visits, grain] (unsigned int b, unsigned int e) {
+      assert (b <= e);
+      assert (e - b <= std::max (1u, grain));
+
+      for (unsigned int i = b; i < e; i++) {
+        visits[i]++;
+      }
+    });
+    for (const std::atomic <unsigned int>& v : visits) {
+      assert (v == 1);
+      (void) v;
+    }
+  }
+
+  /* The previous implementation of `Parallel::forChunks`, which spawns a thread per chunk */
+  template <typename F>
+  void forChunksSpawning (unsigned int n, unsigned int numChunks, const F& f) {
+    const unsigned int        chunkSize = (n + numChunks - 1) / numChunks;
+    std::vector <std::thread> threads;
+
+    for (unsigned int i = 0; i < numChunks - 1; i++) {
+      const unsigned int begin = i * chunkSize;
+      const unsigned int end   = std::min (n, begin + chunkSize);
+
+      threads.emplace_back ([&f, begin, end] () { f (begin, end); });
+    }
+    f (std::min (n, (numChunks - 1) * chunkSize), n);
+
+    for (std::thread& thread : threads) {
+      thread.join ();
+    }
+  }
+}
+
+void TestTaskPool::test () {
+  testRange (0, 1);
+  testRange (1, 1);
+  testRange (100, 1);
+  testRange (1000, 7);
+  testRange (1000, 2000);
+
+  // nested groups
+  std::atomic <unsigned int> sum (0);
+  Parallel::forRange (16, 1, [&sum] (unsigned int b, unsigned int e) {
+    for (unsigned int i = b; i < e; i++) {
+      Parallel::forRange (100, 10, [&sum] (unsigned int b2, unsigned int e2) {
+        sum += e2 - b2;
+      });
+    }
+  });
+  assert (sum == 1600);
+
+  // a pool with a single thread still has a worker
+  TaskPool                   pool (1);
+  std::atomic <unsigned int> counter (0);
+
+  std::future <void> future = pool.async ([&counter] () { counter++; });
+  future.wait ();
+  assert (counter == 1);
+
+  for (unsigned int n : { 1u, 2u, 4u }) {
+    pool.numThreads (n);
+    assert (pool.numThreads () == n);
+
+    TaskGroup group (pool);
+    for (unsigned int i = 0; i < 100; i++) {
+      group.run ([&counter] () { counter++; });
+    }
+    group.wait ();
+  }
+  assert (counter == 301);
+
+  // exceptions are rethrown by `wait` after all tasks have been executed
+  TaskGroup group (pool);
+  bool      caught = false;
+
+  for (unsigned int i = 0; i < 100; i++) {
+    group.run ([&counter, i] () {
+      counter++;
+      if (i % 10 == 0) {
+        throw std::runtime_error ("task failed");
+      }
+    });
+  }
+  try {
+    group.wait ();
+  }
+  catch (const std::runtime_error&) {
+    caught = true;
+  }
+  assert (caught && counter == 401);
+  (void) caught;
+
+  group.run ([&counter] () { counter++; });
+  group.wait ();
+  assert (counter == 402);
+}
+
+void TestTaskPool::benchmark () {
+  const unsigned int numCalls   = 1000;
+  const unsigned int numThreads = Parallel::numThreads (0);
+  std::vector <float> values (4096, 1.0f);
+
+  auto kernel = [&values] (unsigned int b, unsigned int e) {
+    for (unsigned int i = b; i < e; i++) {
+      values[i] = (values[i] * 0.5f) + 0.5f;
+    }
+  };
+
+  auto run = [numCalls] (const char* name, const std::function <void ()>& f) {
+    const Clock::time_point start = Clock::now ();
+
+    for (unsigned int i = 0; i < numCalls; i++) {
+      f ();
+    }
+    const std::chrono::duration <float, std::micro> time = Clock::now () - start;
+
+    std::cout << "task pool: " << name << ": " << (time.count () / float (numCalls))
+              << "us per call\n";
+  };
+
+  run ("spawning threads", [&] () {
+    forChunksSpawning (values.size (), numThreads, kernel);
+  });
+  run ("forChunks", [&] () {
+    Parallel::forChunks (values.size (), numThreads, 1, kernel);
+  });
+  run ("forRange", [&] () {
+    Parallel::forRange (values.size (), 256, kernel);
+  });
+}
@@ -0,0 +1,208 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "flat-index-octree.hpp"
+#include "intersection.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "primitive/ray.hpp"
+#include "primitive/triangle.hpp"
+#include "test-triangle-bvh.hpp"
+#include "time-delta.hpp"
+#include "triangle-bvh.hpp"
+
+namespace {
+  PrimTriangle triangle (const Mesh& mesh, unsigned int face) {
+    return PrimTriangle ( mesh.vertex (mesh.index ((3 * face) + 0))
+                        , mesh.vertex (mesh.index ((3 * face) + 1))
+                        , mesh.vertex (mesh.index ((3 * face) + 2)) );
+  }
+
+  std::vector <PrimRay> randomRays (unsigned int numSamples) {
+    std::vector <PrimRay> rays;
+    rays.reserve (numSamples);
+
+    std::default_random_engine gen;
+    std::uniform_real_distribution <float> posD (-1.0f, 1.0f);
+
+    for (unsigned int i = 0; i < numSamples; i++) {
+      const glm::vec3 origin (posD (gen) * 3.0f, posD (gen) * 3.0f, 3.0f);
+      const glm::vec3 target (posD (gen) * 0.5f, posD (gen) * 0.5f, posD (gen) * 0.5f);
+
+      rays.emplace_back (origin, glm::normalize (target - origin));
+    }
+    return rays;
+  }
+
+  bool bruteForce ( const Mesh& mesh, const std::vector <bool>& isActive, const PrimRay& ray
+                  , float& t )
+  {
+    bool isIntersection = false;
+
+    for (unsigned int f = 0; f < isActive.size (); f++) {
+      float tFace;
+
+      if (isActive [f] && IntersectionUtil::intersects (ray, triangle (mesh, f), &tFace)) {
+        if (isIntersection == false || tFace < t) {
+          t = tFace;
+        }
+        isIntersection = true;
+      }
+    }
+    return isIntersection;
+  }
+
+  void compare ( const TriangleBvh& bvh, const Mesh& mesh, const std::vector <bool>& isActive
+               , const std::vector <PrimRay>& rays )
+  {
+    for (const PrimRay& ray : rays) {
+      unsigned int face;
+      float        tBvh, tBruteForce;
+
+      const bool bvhHit        = bvh.intersects (mesh, ray, face, tBvh);
+      const bool bruteForceHit = bruteForce (mesh, isActive, ray, tBruteForce);
+
+      assert (bvhHit == bruteForceHit);
+      if (bvhHit) {
+        assert (isActive [face]);
+        assert (tBvh == tBruteForce);
+      }
+    }
+  }
+}
+
+void TestTriangleBvh::test () {
+  Mesh                        mesh     = MeshUtil::icosphere (3);
+  const unsigned int          numFaces = mesh.numIndices () / 3;
+  const std::vector <PrimRay> rays     = randomRays (1000);
+  std::vector <unsigned int>  faces;
+  std::vector <bool>          isActive (numFaces, true);
+  TriangleBvh                 bvh;
+
+  for (unsigned int f = 0; f < numFaces; f++) {
+    faces.push_back (f);
+  }
+  bvh.build (mesh, faces);
+  assert (bvh.numFaces () == numFaces);
+  compare (bvh, mesh, isActive, rays);
+
+  // refit
+  for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+    const glm::vec3 v = mesh.vertex (i);
+    mesh.setVertex (i, v * (1.0f + (0.5f * v.x)));
+  }
+  for (unsigned int f = 0; f < numFaces; f++) {
+    bvh.updateFace (f);
+  }
+  bvh.refit (mesh);
+  compare (bvh, mesh, isActive, rays);
+
+  // deleted and re-added faces
+  for (unsigned int f = 0; f < numFaces; f += 3) {
+    bvh.deleteFace (f);
+    isActive [f] = false;
+  }
+  compare (bvh, mesh, isActive, rays);
+
+  for (unsigned int f = 0; f < numFaces; f += 6) {
+    bvh.updateFace (f);
+    isActive [f] = true;
+  }
+  bvh.refit (mesh);
+  compare (bvh, mesh, isActive, rays);
+  assert (bvh.needsRebuild () == false);
+
+  // uniform scaling does not degrade the hierarchy
+  for (unsigned int i = 0; i < mesh.numVertices (); i++) {
+    mesh.setVertex (i, mesh.vertex (i) * 2.0f);
+  }
+  for (unsigned int f = 0; f < numFaces; f++) {
+    if (isActive [f]) {
+      bvh.updateFace (f);
+    }
+  }
+  bvh.refit (mesh);
+  assert (bvh.needsRebuild () == false);
+
+  // faces that are stretched across the mesh degrade the hierarchy
+  for (unsigned int i = 0; i < mesh.numVertices (); i += 7) {
+    mesh.setVertex (i, -mesh.vertex (i));
+  }
+  for (unsigned int f = 0; f < numFaces; f++) {
+    if (isActive [f]) {
+      bvh.updateFace (f);
+    }
+  }
+  bvh.refit (mesh);
+  compare (bvh, mesh, isActive, rays);
+  assert (bvh.needsRebuild ());
+
+  bvh.build (mesh, faces);
+  assert (bvh.needsRebuild () == false);
+}
+
+void TestTriangleBvh::benchmark () {
+  const Mesh                  mesh     = MeshUtil::icosphere (7);
+  const unsigned int          numFaces = mesh.numIndices () / 3;
+  const std::vector <PrimRay> rays     = randomRays (10000);
+  std::vector <unsigned int>  faces;
+  FlatIndexOctree             octree;
+  TriangleBvh                 bvh;
+  unsigned int                numHits = 0;
+
+  for (unsigned int f = 0; f < numFaces; f++) {
+    faces.push_back (f);
+  }
+
+  TIME_DELTA (t)
+  for (unsigned int f : faces) {
+    const PrimTriangle tri = triangle (mesh, f);
+    octree.addElement (f, tri.center (), tri.maxDimExtent ());
+  }
+  t.printLocal ("triangle-bvh: octree build");
+
+  bvh.build (mesh, faces);
+  t.printLocal ("triangle-bvh: bvh build");
+
+  FlatIndexOctree::Candidates candidates;
+  for (const PrimRay& ray : rays) {
+    bool  isIntersection = false;
+    float nearest        = 0.0f;
+
+    octree.forEachCandidate (ray, candidates, [&] (unsigned int f) {
+      float tFace;
+      if ( IntersectionUtil::intersects (ray, triangle (mesh, f), &tFace)
+        && (isIntersection == false || tFace < nearest) )
+      {
+        nearest        = tFace;
+        isIntersection = true;
+      }
+    });
+    numHits += isIntersection ? 1 : 0;
+  }
+  t.printLocal ("triangle-bvh: octree rays");
+
+  for (const PrimRay& ray : rays) {
+    unsigned int face;
+    float        tBvh;
+
+    numHits += bvh.intersects (mesh, ray, face, tBvh) ? 1 : 0;
+  }
+  t.printLocal ("triangle-bvh: bvh rays");
+
+  for (unsigned int f : faces) {
+    bvh.updateFace (f);
+  }
+  bvh.refit (mesh);
+  t.printLocal ("triangle-bvh: bvh refit");
+
+  std::cout << "triangle-bvh: " << rays.size () << " rays, " << numFaces << " faces, "
+            << numHits << " hits\n";
+  bvh.printStatistics ();
+}
@@ -0,0 +1,274 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#include <cassert>
+#include <glm/glm.hpp>
+#include <iostream>
+#include "action/sculpt.hpp"
+#include "adjacent-iterator.hpp"
+#include "affected-faces.hpp"
+#include "mesh.hpp"
+#include "mesh-util.hpp"
+#include "null-opengl.hpp"
+#include "primitive/triangle.hpp"
+#include "sculpt-brush.hpp"
+#include "test-winged-mesh.hpp"
+#include "time-delta.hpp"
+#include "winged/edge.hpp"
+#include "winged/face.hpp"
+#include "winged/mesh.hpp"
+#include "winged/vertex.hpp"
+
+namespace {
+  // checks that every element finds its own mesh, i.e. not the mesh of another element
+  void checkAdjacency (WingedMesh& mesh) {
+    mesh.forEachConstVertex ([&mesh] (const WingedVertex& v) {
+      assert (v.edge ());
+      assert (mesh.edge (v.edge ()->index ()) == v.edge ());
+      assert (v.edge ()->isVertex1 (v) || v.edge ()->isVertex2 (v));
+    });
+    mesh.forEachConstEdge ([&mesh] (const WingedEdge& e) {
+      assert (mesh.vertex (e.vertex1 ()->index ()) == e.vertex1 ());
+      assert (mesh.face   (e.leftFace ()->index ()) == e.leftFace ());
+      assert (e.leftSuccessor  ()->successor   (e.leftFaceRef ()) != nullptr);
+      assert (e.rightSuccessor ()->predecessor (e.rightFaceRef ()) != nullptr);
+    });
+    mesh.forEachConstFace ([&mesh] (const WingedFace& f) {
+      unsigned int n = 0;
+      for (WingedVertex& v : f.adjacentVertices ()) {
+        assert (mesh.vertex (v.index ()) == &v);
+        n++;
+      }
+      assert (n == 3);
+    });
+  }
+
+  // sculpts a remeshing stroke of `numDabs` dabs into `mesh`
+  void sculptStroke (WingedMesh& mesh, unsigned int numDabs, float offset) {
+    SculptBrush   brush;
+    AffectedFaces domain;
+
+    brush.radius          (0.3f);
+    brush.detailFactor    (0.9f);
+    brush.stepWidthFactor (0.1f);
+    brush.subdivide       (true);
+    brush.mesh            (&mesh);
+    brush.parameters <SBCarveParameters> ().intensity (0.05f);
+
+    for (unsigned int i = 0; i < numDabs; i++) {
+      const float     t   = offset + (float (i) / float (numDabs));
+      const glm::vec3 pos = glm::normalize (glm::vec3 (glm::cos (t), 0.3f, glm::sin (t)));
+
+      brush.setPointOfAction (pos, pos);
+      Action::sculptDab      (brush, domain);
+      Action::finalizeSculpt (brush, domain);
+      domain.reset ();
+    }
+  }
+
+  // cached face normals and vertex normals equal freshly computed ones
+  void checkNormals (WingedMesh& mesh) {
+    mesh.forEachConstFace ([&mesh] (const WingedFace& f) {
+      const PrimTriangle triangle = f.triangle (mesh);
+      glm::vec3          normal;
+
+      assert (mesh.faceNormal (f, normal) != triangle.isDegenerated ());
+      assert (triangle.isDegenerated () || glm::distance (normal, triangle.normal ()) < 1.0e-6f);
+      (void) triangle;
+      (void) normal;
+    });
+    mesh.forEachConstVertex ([&mesh] (const WingedVertex& v) {
+      glm::vec3    normal = glm::vec3 (0.0f);
+      unsigned int n      = 0;
+
+      for (WingedFace& f : v.adjacentFaces ()) {
+        const PrimTriangle triangle = f.triangle (mesh);
+
+        if (triangle.isDegenerated () == false) {
+          normal += triangle.normal ();
+          n++;
+        }
+      }
+      assert (glm::distance (v.savedNormal (mesh), normal / float (n)) < 1.0e-5f);
+    });
+  }
+
+  /* Deltas preserve all vertex and face indices, i.e. pruned meshes must be identical.
+   * Since edges are not preserved, the first vertex of a face may differ.
+   */
+  void checkEqual (const Mesh& a, const Mesh& b) {
+    assert (a.numVertices () == b.numVertices ());
+    assert (a.numIndices  () == b.numIndices  ());
+
+    for (unsigned int i = 0; i < a.numVertices (); i++) {
+      assert (a.vertex (i) == b.vertex (i));
+    }
+    for (unsigned int i = 0; i < a.numIndices (); i += 3) {
+      bool isRotation = false;
+
+      for (unsigned int r = 0; r < 3; r++) {
+        isRotation = isRotation || ( a.index (i + 0) == b.index (i + ((r + 0) % 3))
+                                  && a.index (i + 1) == b.index (i + ((r + 1) % 3))
+                                  && a.index (i + 2) == b.index (i + ((r + 2) % 3)) );
+      }
+      assert (isRotation);
+      (void) isRotation;
+    }
+  }
+
+  void checkDelta () {
+    WingedMesh mesh (0);
+    mesh.fromMesh (MeshUtil::icosphere (3));
+
+    std::vector <Mesh>            states;
+    std::vector <WingedMeshDelta> deltas;
+
+    states.push_back (mesh.makePrunedMesh ());
+    for (unsigned int s = 0; s < 3; s++) {
+      mesh.startRecording ();
+      sculptStroke (mesh, 8, float (s));
+      deltas.push_back (mesh.stopRecording ());
+      states.push_back (mesh.makePrunedMesh ());
+    }
+    assert (states.back ().numIndices () > states.front ().numIndices ());
+
+    // undo all strokes, redo all strokes, undo all strokes again
+    for (unsigned int round = 0; round < 3; round++) {
+      const bool isUndo = round % 2 == 0;
+
+      for (unsigned int s = 0; s < deltas.size (); s++) {
+        const unsigned int i = isUndo ? deltas.size () - 1 - s : s;
+
+        deltas [i] = mesh.applyDelta (deltas [i]);
+
+        checkAdjacency (mesh);
+        checkNormals   (mesh);
+        checkEqual     (mesh.makePrunedMesh (), states [isUndo ? i : i + 1]);
+        assert         (MeshUtil::checkConsistency (mesh.makePrunedMesh ()));
+      }
+    }
+  }
+}
+
+void TestWingedMesh::test () {
+  static_assert (sizeof (WingedVertex) == sizeof (unsigned int), "unexpected vertex size");
+  static_assert (sizeof (WingedEdge)   == sizeof (unsigned int), "unexpected edge size");
+  static_assert (sizeof (WingedFace)   == sizeof (unsigned int), "unexpected face size");
+
+  NullOpenGL openGL;
+  WingedMesh mesh1 (0);
+  WingedMesh mesh2 (1);
+
+  mesh1.fromMesh (MeshUtil::icosphere (4));
+  mesh2.fromMesh (MeshUtil::icosphere (2));
+
+  checkAdjacency (mesh1);
+  checkAdjacency (mesh2);
+  checkNormals   (mesh1);
+
+  // moving a vertex invalidates the cached faces around it
+  {
+    WingedVertex& v = mesh1.vertexRef (0);
+    VertexPtrSet  neighbours;
+
+    for (WingedVertex& a : v.adjacentVertices ()) {
+      neighbours.insert (&a);
+    }
+    neighbours.insert (&v);
+
+    v.writePosition (mesh1, 1.5f * v.position (mesh1));
+    mesh1.writeInterpolatedNormals (neighbours);
+    checkNormals (mesh1);
+  }
+
+  mesh1.deleteFace (mesh1.faceRef (0));
+  assert (mesh1.face (0) == nullptr);
+  assert (mesh1.face (1) != nullptr);
+
+  mesh2.reset ();
+  mesh2.fromMesh (MeshUtil::icosphere (3));
+  checkAdjacency (mesh2);
+  assert (MeshUtil::checkConsistency (mesh2.makePrunedMesh ()));
+
+  checkDelta ();
+}
+
+void TestWingedMesh::benchmark () {
+  NullOpenGL openGL;
+  WingedMesh mesh (0);
+
+  mesh.fromMesh (MeshUtil::icosphere (7));
+
+  const std::size_t elementBytes = (mesh.numVertices () * sizeof (WingedVertex))
+                                 + (mesh.numEdges    () * sizeof (WingedEdge))
+                                 + (mesh.numFaces    () * sizeof (WingedFace));
+  const std::size_t totalBytes   = elementBytes + mesh.topology ().numBytes ();
+
+  std::cout << "winged-mesh: " << mesh.numFaces () << " faces, "
+            << float (totalBytes) / float (mesh.numFaces ()) << " bytes per face "
+            << "(elements " << float (elementBytes) / float (mesh.numFaces ()) << ")\n";
+
+  VertexPtrSet region;
+  mesh.forEachVertex ([&mesh, &region] (WingedVertex& v) {
+    if (v.position (mesh).x > 0.8f) {
+      region.insert (&v);
+    }
+  });
+
+  TIME_DELTA (t)
+
+  glm::vec3    sum (0.0f);
+  unsigned int valence = 0;
+  for (unsigned int r = 0; r < 10; r++) {
+    mesh.forEachConstVertex ([&mesh, &sum, &valence] (const WingedVertex& v) {
+      for (WingedVertex& a : v.adjacentVertices ()) {
+        sum += a.position (mesh);
+        valence++;
+      }
+    });
+  }
+  t.printLocal ("winged-mesh: adjacent vertices");
+
+  unsigned int numAdjacentFaces = 0;
+  for (unsigned int r = 0; r < 10; r++) {
+    mesh.forEachConstFace ([&numAdjacentFaces] (const WingedFace& f) {
+      for (WingedFace& a : f.adjacentFaces ()) {
+        numAdjacentFaces += a.index () == f.index () ? 0 : 1;
+      }
+    });
+  }
+  t.printLocal ("winged-mesh: adjacent faces");
+
+  // normals of a region of affected vertices, as computed once per sculpt frame
+  for (unsigned int r = 0; r < 10; r++) {
+    for (WingedVertex* v : region) {
+      glm::vec3    normal = glm::vec3 (0.0f);
+      unsigned int n      = 0;
+
+      for (WingedFace& f : v->adjacentFaces ()) {
+        const PrimTriangle triangle = f.triangle (mesh);
+        if (triangle.isDegenerated () == false) {
+          normal += triangle.normal ();
+          n++;
+        }
+      }
+      v->writeNormal (mesh, normal / float (n));
+    }
+  }
+  t.printLocal ("winged-mesh: region normals without face cache");
+
+  for (unsigned int r = 0; r < 10; r++) {
+    for (WingedVertex* v : region) {
+      v->writePosition (mesh, v->position (mesh));
+    }
+    mesh.writeInterpolatedNormals (region);
+  }
+  t.printLocal ("winged-mesh: region normals with face cache");
+
+  std::cout << "winged-mesh: " << region.size () << " region vertices\n";
+
+  assert (valence == 10 * 2 * mesh.numEdges ());
+  assert (numAdjacentFaces > 0);
+  (void) sum;
+}
@@ -0,0 +1,13 @@
+/* This file is part of Dilay
+ * Copyright © 2015,2016 Alexander Bau
+ * Use and redistribute under the terms of the GNU General Public License
+ */
+#ifndef DILAY_TEST_WINGED_MESH
+#define DILAY_TEST_WINGED_MESH
+
+namespace TestWingedMesh {
+  void test      ();
+  void benchmark ();
+}
+
+#endif
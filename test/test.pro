@@ -9,23 +9,49 @@ INCLUDEPATH    += src $$PWD/../lib/src
 SOURCES += \
            src/main.cpp \
            src/test-bitset.cpp \
+           src/test-compressed-mesh.cpp \
            src/test-distance.cpp \
+           src/test-falloff.cpp \
+           src/test-indexed-ptr-set.cpp \
            src/test-intersection.cpp \
            src/test-intrusive-list.cpp \
            src/test-maybe.cpp \
+           src/test-mesh.cpp \
            src/test-misc.cpp \
            src/test-octree.cpp \
-           src/test-tree.cpp
+           src/test-parallel.cpp \
+           src/test-scene-util.cpp \
+           src/test-sculpt.cpp \
+           src/test-sculpt-worker.cpp \
+           src/test-sketch-conversion.cpp \
+           src/test-slab-indexed-list.cpp \
+           src/test-task-pool.cpp \
+           src/test-tree.cpp \
+           src/test-triangle-bvh.cpp \
+           src/test-winged-mesh.cpp
 
 HEADERS += \
            src/test-bitset.hpp \
+           src/test-compressed-mesh.hpp \
            src/test-distance.hpp \
+           src/test-falloff.hpp \
+           src/test-indexed-ptr-set.hpp \
            src/test-intersection.hpp \
            src/test-intrusive-list.hpp \
            src/test-maybe.hpp \
+           src/test-mesh.hpp \
            src/test-misc.hpp \
            src/test-octree.hpp \
-           src/test-tree.hpp
+           src/test-parallel.hpp \
+           src/test-scene-util.hpp \
+           src/test-sculpt.hpp \
+           src/test-sculpt-worker.hpp \
+           src/test-sketch-conversion.hpp \
+           src/test-slab-indexed-list.hpp \
+           src/test-task-pool.hpp \
+           src/test-tree.hpp \
+           src/test-triangle-bvh.hpp \
+           src/test-winged-mesh.hpp
 
 win32:CONFIG(release, debug|release):    LIBS += -L$$OUT_PWD/../lib/release/ -ldilay
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../lib/debug/ -ldilay